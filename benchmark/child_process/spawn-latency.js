@@ -0,0 +1,42 @@
+'use strict';
+const common = require('../common.js');
+const bench = common.createBenchmark(main, {
+  // Resident memory of the parent process, in megabytes.
+  rss: [0, 256, 1024],
+  // Setting `uid` and `gid` makes libuv use fork() instead of posix_spawn().
+  method: ['default', 'fork'],
+  n: [100]
+});
+
+const spawn = require('child_process').spawn;
+
+function main({ rss, method, n }) {
+  // Touch every page, so that it is actually mapped.
+  const memory = Buffer.allocUnsafe(rss * 1024 * 1024).fill(1);
+  const options = {};
+  if (method === 'fork' && process.getuid) {
+    options.uid = process.getuid();
+    options.gid = process.getgid();
+  }
+
+  // Only the time that spawn() blocks the event loop is measured.
+  let elapsed = 0;
+  (function go(left) {
+    if (left === 0) {
+      const time = [Math.floor(elapsed / 1e9), elapsed % 1e9];
+      bench.report(n / (elapsed / 1e9), time);
+      return memory.length;
+    }
+
+    const start = process.hrtime();
+    const child = spawn('echo', ['hello'], options);
+    const [seconds, nanoseconds] = process.hrtime(start);
+    elapsed += seconds * 1e9 + nanoseconds;
+    child.on('exit', (code) => {
+      if (code)
+        process.exit(code);
+      else
+        go(left - 1);
+    });
+  })(n);
+}
@@ -0,0 +1,20 @@
+'use strict';
+
+// Counts the bytes received on all connections. Used by
+// benchmark/net/net-read-slab.js.
+
+const net = require('net');
+
+let bytes = 0;
+
+const server = net.createServer((socket) => {
+  socket.on('data', (buf) => {
+    bytes += buf.length;
+  });
+});
+
+server.listen(+process.argv[2], () => process.send('listening'));
+
+process.on('message', () => {
+  process.send({ bytes });
+});
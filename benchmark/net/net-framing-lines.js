@@ -0,0 +1,54 @@
+// Measure how fast newline-delimited data can be split into lines, using
+// readline or socket.setFraming().
+'use strict';
+
+const common = require('../common.js');
+const net = require('net');
+const readline = require('readline');
+const PORT = common.PORT;
+
+const bench = common.createBenchmark(main, {
+  method: ['readline', 'framing', 'framing-buffer'],
+  lineLen: [16, 256],
+  dur: [5],
+});
+
+function main({ dur, lineLen, method }) {
+  const line = `${'x'.repeat(lineLen - 1)}\n`;
+  const chunk = Buffer.from(line.repeat(Math.ceil(64 * 1024 / lineLen)));
+
+  const server = net.createServer((socket) => {
+    let running = true;
+    socket.on('error', () => {});
+    socket.on('close', () => running = false);
+    (function write() {
+      while (running && socket.write(chunk));
+      if (running) socket.once('drain', write);
+    })();
+  });
+
+  server.listen(PORT, () => {
+    const socket = net.connect(PORT);
+    let lines = 0;
+
+    if (method === 'readline') {
+      readline.createInterface({ input: socket, crlfDelay: Infinity })
+        .on('line', () => lines++);
+    } else {
+      const options = { delimiter: '\n' };
+      if (method === 'framing')
+        options.encoding = 'utf8';
+      socket.setFraming(options, (frames) => {
+        lines += frames.length;
+      });
+    }
+
+    bench.start();
+    setTimeout(() => {
+      // Report the number of lines in millions.
+      bench.end(lines / 1e6);
+      socket.destroy();
+      server.close();
+    }, dur * 1000);
+  });
+}
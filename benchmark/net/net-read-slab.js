@@ -0,0 +1,51 @@
+// Measure read throughput of a server that receives data on many
+// connections, with and without --stream-read-slab-size.
+'use strict';
+
+const common = require('../common.js');
+const { fork } = require('child_process');
+const net = require('net');
+const path = require('path');
+const PORT = common.PORT;
+
+const bench = common.createBenchmark(main, {
+  len: [64, 16 * 1024],
+  conns: [1, 100],
+  slab: [0, 1024 * 1024],
+  dur: [5],
+});
+
+function main({ dur, len, conns, slab }) {
+  const child = fork(
+    path.join(__dirname, '..', 'fixtures', 'net-read-slab-server.js'),
+    [`${PORT}`],
+    { execArgv: [`--stream-read-slab-size=${slab}`] }
+  );
+
+  child.once('message', () => {
+    const chunk = Buffer.alloc(len, 'x');
+    const sockets = [];
+    let running = true;
+
+    for (let i = 0; i < conns; i++) {
+      const socket = net.connect(PORT);
+      sockets.push(socket);
+      (function write() {
+        while (running && socket.write(chunk));
+        if (running) socket.once('drain', write);
+      })();
+    }
+
+    bench.start();
+    setTimeout(() => {
+      running = false;
+      child.send('stop');
+      child.once('message', ({ bytes }) => {
+        bench.end(bytes * 8 / (1024 * 1024 * 1024));
+        for (const socket of sockets)
+          socket.destroy();
+        child.kill();
+      });
+    }, dur * 1000);
+  });
+}
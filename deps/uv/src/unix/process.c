@@ -44,6 +44,18 @@ extern char **environ;
 # include <grp.h>
 #endif
 
+/* Since glibc 2.24, posix_spawn() creates the child with
+ * clone(CLONE_VM | CLONE_VFORK), which does not copy the page tables of the
+ * parent, and reports exec() errors to the caller.
+ */
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+# if __GLIBC_PREREQ(2, 24)
+#  define UV__HAVE_POSIX_SPAWN 1
+#  include <spawn.h>
+#  include <string.h>
+# endif
+#endif
+
 
 static void uv__chld(uv_signal_t* handle, int signum) {
   uv_process_t* process;
@@ -413,6 +425,187 @@ static void uv__process_child_init(const uv_process_options_t* options,
 #endif
 
 
+#if defined(UV__HAVE_POSIX_SPAWN)
+static const char* uv__spawn_find_path(char** env) {
+  for (; *env != NULL; env++)
+    if (strncmp(*env, "PATH=", 5) == 0)
+      return *env + 5;
+
+  return NULL;
+}
+
+
+/* Returns 1 if posix_spawn() can set up the child exactly like
+ * uv__process_child_init() does, 0 otherwise.
+ */
+static int uv__spawn_can_use_posix_spawn(const uv_process_options_t* options,
+                                         int stdio_count,
+                                         int (*pipes)[2]) {
+  const char* path;
+  const char* env_path;
+  int use_fd;
+  int flags;
+  int fd;
+
+  if (options->flags & (UV_PROCESS_DETACHED |
+                        UV_PROCESS_SETGID |
+                        UV_PROCESS_SETUID))
+    return 0;
+
+#if !__GLIBC_PREREQ(2, 29)
+  /* posix_spawn_file_actions_addchdir_np() is not available. */
+  if (options->cwd != NULL)
+    return 0;
+#endif
+
+  /* execvp() searches the PATH of the new environment, posix_spawnp() the one
+   * of the parent.
+   */
+  if (options->env != NULL && strchr(options->file, '/') == NULL) {
+    path = getenv("PATH");
+    env_path = uv__spawn_find_path(options->env);
+    if (path == NULL || env_path == NULL) {
+      if (path != env_path)
+        return 0;
+    } else if (strcmp(path, env_path) != 0) {
+      return 0;
+    }
+  }
+
+  for (fd = 0; fd < stdio_count; fd++) {
+    use_fd = pipes[fd][1];
+    if (use_fd < 0)
+      continue;
+
+    /* File actions run in order, so an fd that is the target of a later
+     * dup2() cannot be used as a source.
+     */
+    if (use_fd < stdio_count && use_fd != fd)
+      return 0;
+
+    /* Clearing FD_CLOEXEC requires fcntl() in the child. */
+    if (use_fd == fd) {
+      flags = fcntl(fd, F_GETFD);
+      if (flags == -1 || (flags & FD_CLOEXEC))
+        return 0;
+    }
+
+    /* Clearing O_NONBLOCK requires fcntl() in the child. */
+    if (fd <= 2) {
+      flags = fcntl(use_fd, F_GETFL);
+      if (flags == -1 || (flags & O_NONBLOCK))
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
+
+/* Starts the child with posix_spawnp(). Returns 0 or the error that
+ * uv__process_child_init() would have reported.
+ */
+static int uv__spawn_posix(const uv_process_options_t* options,
+                           int stdio_count,
+                           int (*pipes)[2],
+                           pid_t* pid) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attrs;
+  sigset_t set;
+  int use_fd;
+  int err;
+  int fd;
+  int i;
+  int n;
+
+  err = posix_spawn_file_actions_init(&actions);
+  if (err != 0)
+    return UV__ERR(err);
+
+  err = posix_spawnattr_init(&attrs);
+  if (err != 0) {
+    posix_spawn_file_actions_destroy(&actions);
+    return UV__ERR(err);
+  }
+
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = pipes[fd][1];
+
+    if (use_fd < 0) {
+      /* Redirect stdin, stdout and stderr to /dev/null even if UV_IGNORE is
+       * set.
+       */
+      if (fd < 3)
+        err = posix_spawn_file_actions_addopen(&actions,
+                                               fd,
+                                               "/dev/null",
+                                               fd == 0 ? O_RDONLY : O_RDWR,
+                                               0);
+    } else if (use_fd != fd) {
+      err = posix_spawn_file_actions_adddup2(&actions, use_fd, fd);
+    }
+  }
+
+  /* Close inherited fds that are not closed on exec, once each. */
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = pipes[fd][1];
+    if (use_fd < stdio_count || (fcntl(use_fd, F_GETFD) & FD_CLOEXEC))
+      continue;
+
+    for (i = 0; i < fd; i++)
+      if (pipes[i][1] == use_fd)
+        break;
+
+    if (i == fd)
+      err = posix_spawn_file_actions_addclose(&actions, use_fd);
+  }
+
+#if __GLIBC_PREREQ(2, 29)
+  if (options->cwd != NULL && err == 0)
+    err = posix_spawn_file_actions_addchdir_np(&actions, options->cwd);
+#endif
+
+  /* Reset signal disposition and mask, see uv__process_child_init(). */
+  if (err == 0) {
+    sigemptyset(&set);
+    for (n = 1; n < 32; n += 1)
+      if (n != SIGKILL && n != SIGSTOP)
+        sigaddset(&set, n);
+
+    err = posix_spawnattr_setsigdefault(&attrs, &set);
+  }
+
+  if (err == 0) {
+    sigemptyset(&set);
+    err = posix_spawnattr_setsigmask(&attrs, &set);
+  }
+
+  if (err == 0)
+    err = posix_spawnattr_setflags(&attrs,
+                                   POSIX_SPAWN_SETSIGDEF |
+                                   POSIX_SPAWN_SETSIGMASK);
+
+  if (err == 0)
+    err = posix_spawnp(pid,
+                       options->file,
+                       &actions,
+                       &attrs,
+                       options->args,
+                       options->env != NULL ? options->env : environ);
+
+  posix_spawnattr_destroy(&attrs);
+  posix_spawn_file_actions_destroy(&actions);
+
+  if (err != 0) {
+    *pid = 0;
+    return UV__ERR(err);
+  }
+
+  return 0;
+}
+#endif
+
+
 int uv_spawn(uv_loop_t* loop,
              uv_process_t* process,
              const uv_process_options_t* options) {
@@ -466,6 +659,26 @@ int uv_spawn(uv_loop_t* loop,
       goto error;
   }
 
+#if defined(UV__HAVE_POSIX_SPAWN)
+  if (uv__spawn_can_use_posix_spawn(options, stdio_count, pipes)) {
+    uv_signal_start(&loop->child_watcher, uv__chld, SIGCHLD);
+
+    /* Acquire write lock to prevent opening new fds in worker threads */
+    uv_rwlock_wrlock(&loop->cloexec_lock);
+    exec_errorno = uv__spawn_posix(options, stdio_count, pipes, &pid);
+    uv_rwlock_wrunlock(&loop->cloexec_lock);
+
+    /* Unlike execvp(), posix_spawnp() does not run files that are not in a
+     * known executable format, like scripts without a #! line, with
+     * /bin/sh. Leave those to the fork() path.
+     */
+    if (exec_errorno != UV__ERR(ENOEXEC)) {
+      process->status = 0;
+      goto open_streams;
+    }
+  }
+#endif
+
   /* This pipe is used by the parent to wait until
    * the child has called `execve()`. We need this
    * to avoid the following race condition:
@@ -536,6 +749,9 @@ int uv_spawn(uv_loop_t* loop,
 
   uv__close_nocheckstdio(signal_pipe[0]);
 
+#if defined(UV__HAVE_POSIX_SPAWN)
+open_streams:
+#endif
   for (i = 0; i < options->stdio_count; i++) {
     err = uv__process_open_stream(options->stdio + i, pipes[i]);
     if (err == 0)
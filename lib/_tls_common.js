@@ -25,6 +25,10 @@ const { Object } = primordials;
 
 const { parseCertString } = require('internal/tls');
 const { isArrayBufferView } = require('internal/util/types');
+const {
+  validateString,
+  validateUint32
+} = require('internal/validators');
 const tls = require('tls');
 const {
   ERR_CRYPTO_CUSTOM_ENGINE_NOT_SUPPORTED,
@@ -209,6 +213,20 @@ exports.createSecureContext = function createSecureContext(options) {
     c.context.setSessionIdContext(options.sessionIdContext);
   }
 
+  if (options.sessionCache) {
+    const {
+      path = '',
+      name = path || 'default',
+      size = 4096,
+      ticketKeyRotation = 0
+    } = options.sessionCache;
+    validateString(name, 'options.sessionCache.name');
+    validateString(path, 'options.sessionCache.path');
+    validateUint32(size, 'options.sessionCache.size', true);
+    validateUint32(ticketKeyRotation, 'options.sessionCache.ticketKeyRotation');
+    c.context.setSessionCache(name, path, size, ticketKeyRotation);
+  }
+
   if (options.pfx) {
     if (!toBuf)
       toBuf = require('internal/crypto/util').toBuf;
@@ -236,6 +254,9 @@ exports.createSecureContext = function createSecureContext(options) {
     }
   }
 
+  if (options.asyncPrivateKey)
+    c.context.enableAsyncPrivateKey();
+
   // Do not keep read/write buffers in free list for OpenSSL < 1.1.0. (For
   // OpenSSL 1.1.0, buffers are malloced and freed without the use of a
   // freelist.)
@@ -21,7 +21,7 @@
 
 'use strict';
 
-const { Object } = primordials;
+const { Math, Object } = primordials;
 
 const {
   assertCrypto,
@@ -58,7 +58,10 @@ const {
   ERR_TLS_SNI_FROM_SERVER
 } = codes;
 const { getOptionValue } = require('internal/options');
-const { validateString } = require('internal/validators');
+const {
+  validateString,
+  validateUint32
+} = require('internal/validators');
 const traceTls = getOptionValue('--trace-tls');
 const kConnectOptions = Symbol('connect-options');
 const kDisableRenegotiation = Symbol('disable-renegotiation');
@@ -67,6 +70,12 @@ const kHandshakeTimeout = Symbol('handshake-timeout');
 const kRes = Symbol('res');
 const kSNICallback = Symbol('snicallback');
 const kEnableTrace = Symbol('enableTrace');
+const kOCSPStapling = Symbol('ocspStapling');
+
+// How long to wait before fetching an OCSP response again after a failure.
+const kOCSPRetryDelay = 60 * 1000;
+// The number of certificates for which a server keeps OCSP responses.
+const kOCSPMaxEntries = 1024;
 
 const noop = () => {};
 
@@ -180,8 +189,12 @@ function loadSNI(info) {
       return owner.destroy(new ERR_SOCKET_CLOSED());
 
     // TODO(indutny): eventually disallow raw `SecureContext`
-    if (context)
+    if (context) {
       owner._handle.sni_context = context.context || context;
+      const server = owner.server;
+      if (server && server[kOCSPStapling] !== undefined && server.listening)
+        updateOCSPStapling(server, owner._handle.sni_context);
+    }
 
     requestOCSP(owner, info);
   });
@@ -237,6 +250,90 @@ function requestOCSP(socket, info) {
                      onOCSP);
 }
 
+// With the `ocspStapling` option, the OCSP responses for the SecureContexts of
+// a server are fetched by JS and stored in the native contexts, which staple
+// them to handshakes without calling into JS.
+//
+// Responses are kept per certificate, so that contexts with the same
+// certificate share them, for up to kOCSPMaxEntries certificates. There are
+// no timers: the contexts are brought up to date, and responses that are due
+// for a refresh are fetched, when a handshake uses them.
+function updateOCSPStapling(server, context) {
+  const { entries, contexts, refreshBefore } = server[kOCSPStapling];
+
+  let contextState = contexts.get(context);
+  if (contextState === undefined) {
+    const certificate = context.getCertificate();
+    if (certificate === null)
+      return;
+    contextState = {
+      certificate,
+      key: certificate.toString('latin1'),
+      response: null
+    };
+    contexts.set(context, contextState);
+  }
+
+  const { key } = contextState;
+  let entry = entries.get(key);
+  if (entry === undefined) {
+    entry = { response: null, expiry: 0, refreshAt: 0, fetching: false };
+    if (entries.size >= kOCSPMaxEntries)
+      entries.delete(entries.keys().next().value);
+  } else {
+    // Keep the entries in the order of their last use.
+    entries.delete(key);
+  }
+  entries.set(key, entry);
+
+  const now = Date.now();
+  if (entry.response !== null && contextState.response !== entry.response &&
+      entry.expiry > now) {
+    context.setOCSPResponse(entry.response, entry.expiry - now);
+    contextState.response = entry.response;
+  }
+
+  if (entry.fetching || now < entry.refreshAt)
+    return;
+  entry.fetching = true;
+
+  let once = false;
+  const onOCSP = (err, response) => {
+    debug('server OCSP fetch done', 'once?', once, 'response?', !!response,
+          'err?', err);
+    if (once)
+      throw new ERR_MULTIPLE_CALLBACK();
+    once = true;
+    entry.fetching = false;
+
+    // Keep the previous response on errors, until it expires. Responses
+    // without a nextUpdate time, including ones that cannot be parsed, are
+    // stapled for twice `refreshBefore`, and so fetched again after it.
+    let delay = kOCSPRetryDelay;
+    if (!err && response) {
+      entry.response = response;
+      entry.expiry = context.setOCSPResponse(response, 2 * refreshBefore);
+      contextState.response = response;
+      const lifetime = entry.expiry - Date.now();
+      if (lifetime > 0)
+        delay = Math.max(lifetime - refreshBefore, lifetime / 2);
+    }
+    entry.refreshAt = Date.now() + delay;
+  };
+
+  debug('server fetch OCSP response');
+  server[kOCSPStapling].fetch(contextState.certificate, context.getIssuer(),
+                              onOCSP);
+}
+
+function onOCSPStaplingListening() {
+  updateOCSPStapling(this, this._sharedCreds.context);
+}
+
+function onOCSPStaplingClose() {
+  this[kOCSPStapling].entries.clear();
+}
+
 function requestOCSPDone(socket) {
   debug('server certcb done');
   try {
@@ -916,6 +1013,8 @@ function onSocketClose(err) {
 
 function tlsConnectionListener(rawSocket) {
   debug('net.Server.on(connection): new TLSSocket');
+  if (this[kOCSPStapling] !== undefined)
+    updateOCSPStapling(this, this._sharedCreds.context);
   const socket = new TLSSocket(rawSocket, {
     secureContext: this._sharedCreds,
     isServer: true,
@@ -1026,6 +1125,26 @@ function Server(options, listener) {
   if (options.ALPNProtocols)
     tls.convertALPNProtocols(options.ALPNProtocols, this);
 
+  if (options.ocspStapling !== undefined) {
+    if (options.ocspStapling === null ||
+        typeof options.ocspStapling !== 'object') {
+      throw new ERR_INVALID_ARG_TYPE(
+        'options.ocspStapling', 'Object', options.ocspStapling);
+    }
+    const { fetch, refreshBefore = 60 * 60 * 1000 } = options.ocspStapling;
+    if (typeof fetch !== 'function') {
+      throw new ERR_INVALID_ARG_TYPE(
+        'options.ocspStapling.fetch', 'Function', fetch);
+    }
+    validateUint32(refreshBefore, 'options.ocspStapling.refreshBefore', true);
+    this[kOCSPStapling] = {
+      fetch,
+      refreshBefore,
+      entries: new Map(),
+      contexts: new WeakMap()
+    };
+  }
+
   this.setSecureContext(options);
 
   this[kHandshakeTimeout] = options.handshakeTimeout || (120 * 1000);
@@ -1048,6 +1167,11 @@ function Server(options, listener) {
     this.on('secureConnection', listener);
   }
 
+  if (this[kOCSPStapling] !== undefined) {
+    this.on('listening', onOCSPStaplingListening);
+    this.on('close', onOCSPStaplingClose);
+  }
+
   this[kEnableTrace] = options.enableTrace;
 }
 
@@ -1113,6 +1237,13 @@ Server.prototype.setSecureContext = function(options) {
   else
     this.crl = undefined;
 
+  if (options.sessionCache)
+    this.sessionCache = options.sessionCache;
+  else
+    this.sessionCache = undefined;
+
+  this.asyncPrivateKey = !!options.asyncPrivateKey;
+
   if (options.ciphers)
     this.ciphers = options.ciphers;
   else
@@ -1165,7 +1296,9 @@ Server.prototype.setSecureContext = function(options) {
     secureOptions: this.secureOptions,
     honorCipherOrder: this.honorCipherOrder,
     crl: this.crl,
-    sessionIdContext: this.sessionIdContext
+    sessionIdContext: this.sessionIdContext,
+    sessionCache: this.sessionCache,
+    asyncPrivateKey: this.asyncPrivateKey
   });
 
   if (this.sessionTimeout)
@@ -1175,6 +1308,9 @@ Server.prototype.setSecureContext = function(options) {
     this.ticketKeys = options.ticketKeys;
     this.setTicketKeys(this.ticketKeys);
   }
+
+  if (this[kOCSPStapling] !== undefined && this.listening)
+    updateOCSPStapling(this, this._sharedCreds.context);
 };
 
 
@@ -1186,6 +1322,11 @@ Server.prototype._getServerData = function() {
 
 
 Server.prototype._setServerData = function(data) {
+  // The keys were taken from the first worker when it started listening.
+  // If they are kept in a session cache, all workers already share them,
+  // and the stale copy must not replace a key that has been rotated since.
+  if (this.sessionCache && this.sessionCache.ticketKeyRotation > 0)
+    return;
   this.setTicketKeys(Buffer.from(data.ticketKeys, 'hex'));
 };
 
@@ -1200,6 +1341,21 @@ Server.prototype.setTicketKeys = function setTicketKeys(keys) {
 };
 
 
+Server.prototype.getSessionCacheStats = function getSessionCacheStats() {
+  const stats = new Float64Array(6);
+  if (!this._sharedCreds.context.getSessionCacheStats(stats))
+    return undefined;
+  return {
+    hits: stats[0],
+    misses: stats[1],
+    stores: stats[2],
+    evictions: stats[3],
+    ticketKeyRotations: stats[4],
+    size: stats[5]
+  };
+};
+
+
 Server.prototype.setOptions = deprecate(function(options) {
   this.requestCert = options.requestCert === true;
   this.rejectUnauthorized = options.rejectUnauthorized !== false;
@@ -35,6 +35,9 @@ const {
   Resolver,
   validateHints,
   emitInvalidHostnameWarning,
+  getLookupMode,
+  setLookupMode,
+  startLookup,
 } = require('internal/dns/utils');
 const {
   ERR_INVALID_ARG_TYPE,
@@ -43,7 +46,7 @@ const {
   ERR_MISSING_ARGS,
   ERR_SOCKET_BAD_PORT
 } = errors.codes;
-const { validateString } = require('internal/validators');
+const { validateString, validateUint32 } = require('internal/validators');
 
 const {
   GetAddrInfoReqWrap,
@@ -142,9 +145,7 @@ function lookup(hostname, options, callback) {
   req.hostname = hostname;
   req.oncomplete = all ? onlookupall : onlookup;
 
-  const err = cares.getaddrinfo(
-    req, toASCII(hostname), family, hints, verbatim
-  );
+  const err = startLookup(req, toASCII(hostname), family, hints, verbatim);
   if (err) {
     process.nextTick(callback, dnsException(err, 'getaddrinfo', hostname));
     return {};
@@ -266,6 +267,44 @@ function resolve(hostname, rrtype, callback) {
   }
 }
 
+const lookupCacheStats = new Float64Array(6);
+
+function enableLookupCache(options = {}) {
+  if (options === null || typeof options !== 'object')
+    throw new ERR_INVALID_ARG_TYPE('options', 'Object', options);
+  const {
+    ttl = 10000,
+    negativeTtl = 1000,
+    staleTtl = 5000,
+    maxEntries = 1000
+  } = options;
+  validateUint32(ttl, 'options.ttl');
+  validateUint32(negativeTtl, 'options.negativeTtl');
+  validateUint32(staleTtl, 'options.staleTtl');
+  validateUint32(maxEntries, 'options.maxEntries');
+  cares.setLookupCacheOptions(true, ttl, negativeTtl, staleTtl, maxEntries);
+}
+
+function disableLookupCache() {
+  cares.setLookupCacheOptions(false, 0, 0, 0, 0);
+}
+
+function clearLookupCache() {
+  cares.clearLookupCache();
+}
+
+function getLookupCacheStats() {
+  cares.getLookupCacheStats(lookupCacheStats);
+  return {
+    hits: lookupCacheStats[0],
+    staleHits: lookupCacheStats[1],
+    misses: lookupCacheStats[2],
+    coalesced: lookupCacheStats[3],
+    evictions: lookupCacheStats[4],
+    size: lookupCacheStats[5]
+  };
+}
+
 function defaultResolverSetServers(servers) {
   const resolver = new Resolver();
 
@@ -281,6 +320,13 @@ module.exports = {
   lookup,
   lookupService,
 
+  enableLookupCache,
+  disableLookupCache,
+  clearLookupCache,
+  getLookupCacheStats,
+  setLookupMode,
+  getLookupMode,
+
   Resolver,
   setServers: defaultResolverSetServers,
 
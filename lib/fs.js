@@ -50,7 +50,8 @@ const {
     ERR_FS_FILE_TOO_LARGE,
     ERR_INVALID_ARG_VALUE,
     ERR_INVALID_ARG_TYPE,
-    ERR_INVALID_CALLBACK
+    ERR_INVALID_CALLBACK,
+    ERR_OUT_OF_RANGE
   },
   uvException
 } = require('internal/errors');
@@ -64,9 +65,12 @@ const {
   getDirents,
   getOptions,
   getValidatedPath,
+  getValidatedPaths,
+  handleErrorFromBinding,
   nullCheck,
   preprocessSymlinkDestination,
   Stats,
+  StatsBatch,
   getStatsFromBinding,
   realpathCacheKey,
   stringToFlags,
@@ -77,6 +81,11 @@ const {
   validatePath,
   warnOnNonPortableTemplate
 } = require('internal/fs/utils');
+const {
+  Dir,
+  opendir,
+  opendirSync
+} = require('internal/fs/dir');
 const {
   CHAR_FORWARD_SLASH,
   CHAR_BACKWARD_SLASH,
@@ -96,6 +105,7 @@ let fs;
 // Lazy loaded
 let promises = null;
 let watchers;
+let walker;
 let ReadFileContext;
 let ReadStream;
 let WriteStream;
@@ -118,23 +128,6 @@ function showTruncateDeprecation() {
   }
 }
 
-function handleErrorFromBinding(ctx) {
-  if (ctx.errno !== undefined) {  // libuv error numbers
-    const err = uvException(ctx);
-    // eslint-disable-next-line no-restricted-syntax
-    Error.captureStackTrace(err, handleErrorFromBinding);
-    throw err;
-  }
-  if (ctx.error !== undefined) {  // Errors created in C++ land.
-    // TODO(joyeecheung): currently, ctx.error are encoding errors
-    // usually caused by memory problems. We need to figure out proper error
-    // code(s) for this.
-    // eslint-disable-next-line no-restricted-syntax
-    Error.captureStackTrace(ctx.error, handleErrorFromBinding);
-    throw ctx.error;
-  }
-}
-
 function maybeCallback(cb) {
   if (typeof cb === 'function')
     return cb;
@@ -280,30 +273,47 @@ function readFileAfterStat(err, stats) {
   context.read();
 }
 
+function readFileAfterReadAll(err, data) {
+  const callback = this.callback;
+  if (err)
+    return callback(err);
+  // The binding returns the size instead of the contents if the file does
+  // not fit into a Buffer.
+  if (typeof data === 'number')
+    return callback(new ERR_FS_FILE_TOO_LARGE(data));
+  callback(null, data);
+}
+
 function readFile(path, options, callback) {
   callback = maybeCallback(callback || options);
   options = getOptions(options, { flag: 'r' });
+
+  // Files that are opened here are read in a single request, which opens,
+  // reads and closes them without going back to the event loop in between.
+  if (!isFd(path)) {
+    path = getValidatedPath(path);
+    const req = new FSReqCallback();
+    req.callback = callback;
+    req.oncomplete = readFileAfterReadAll;
+    binding.readFile(pathModule.toNamespacedPath(path),
+                     stringToFlags(options.flag || 'r'),
+                     options.encoding,
+                     req);
+    return;
+  }
+
   if (!ReadFileContext)
     ReadFileContext = require('internal/fs/read_file_context');
   const context = new ReadFileContext(callback, options.encoding);
-  context.isUserFd = isFd(path); // File descriptor ownership
+  context.isUserFd = true; // File descriptor ownership
 
   const req = new FSReqCallback();
   req.context = context;
   req.oncomplete = readFileAfterOpen;
 
-  if (context.isUserFd) {
-    process.nextTick(function tick() {
-      req.oncomplete(null, path);
-    });
-    return;
-  }
-
-  path = getValidatedPath(path);
-  binding.open(pathModule.toNamespacedPath(path),
-               stringToFlags(options.flag || 'r'),
-               0o666,
-               req);
+  process.nextTick(function tick() {
+    req.oncomplete(null, path);
+  });
 }
 
 function tryStatSync(fd, isUserFd) {
@@ -678,6 +688,66 @@ function ftruncateSync(fd, len = 0) {
   handleErrorFromBinding(ctx);
 }
 
+function mmap(fd, offset, length, options = {}) {
+  validateInt32(fd, 'fd', 0);
+  validateInteger(offset, 'offset');
+  if (offset < 0)
+    throw new ERR_OUT_OF_RANGE('offset', '>= 0', offset);
+  validateInteger(length, 'length');
+  if (length < 1 || length > kMaxLength)
+    throw new ERR_OUT_OF_RANGE('length', `>= 1 && <= ${kMaxLength}`, length);
+  if (options === null || typeof options !== 'object')
+    throw new ERR_INVALID_ARG_TYPE('options', 'Object', options);
+
+  const {
+    readOnly = true,
+    shared = true,
+    sharedArrayBuffer = false
+  } = options;
+  if (typeof readOnly !== 'boolean')
+    throw new ERR_INVALID_ARG_TYPE('options.readOnly', 'boolean', readOnly);
+  if (typeof shared !== 'boolean')
+    throw new ERR_INVALID_ARG_TYPE('options.shared', 'boolean', shared);
+  if (typeof sharedArrayBuffer !== 'boolean') {
+    throw new ERR_INVALID_ARG_TYPE('options.sharedArrayBuffer', 'boolean',
+                                   sharedArrayBuffer);
+  }
+
+  const ctx = {};
+  const arrayBuffer = binding.mmap(fd, offset, length, readOnly, shared,
+                                   sharedArrayBuffer, ctx);
+  handleErrorFromBinding(ctx);
+  return Buffer.from(arrayBuffer);
+}
+
+function munmap(buffer) {
+  validateBuffer(buffer);
+  if (!binding.munmap(buffer)) {
+    throw new ERR_INVALID_ARG_VALUE(
+      'buffer', buffer, 'is not a releasable memory-mapped Buffer');
+  }
+}
+
+// The order matches the MadviseAdvice enum in src/node_mmap.cc.
+const kMadviseAdvice = [
+  'normal', 'random', 'sequential', 'willneed', 'dontneed'
+];
+
+function madvise(buffer, advice) {
+  validateBuffer(buffer);
+  const index = kMadviseAdvice.indexOf(advice);
+  if (index === -1) {
+    throw new ERR_INVALID_ARG_VALUE(
+      'advice', advice, `must be one of: ${kMadviseAdvice.join(', ')}`);
+  }
+  const ctx = {};
+  if (!binding.madvise(buffer, index, ctx)) {
+    throw new ERR_INVALID_ARG_VALUE(
+      'buffer', buffer, 'does not point into a memory-mapped Buffer');
+  }
+  handleErrorFromBinding(ctx);
+}
+
 function rmdir(path, callback) {
   callback = makeCallback(callback);
   path = getValidatedPath(path);
@@ -857,6 +927,35 @@ function statSync(path, options = {}) {
   return getStatsFromBinding(stats);
 }
 
+function statMany(paths, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = {};
+  }
+  callback = makeCallback(callback);
+  paths = getValidatedPaths(paths);
+  if (paths.length === 0) {
+    process.nextTick(callback, null, new StatsBatch(paths));
+    return;
+  }
+  const req = new FSReqCallback(options.bigint);
+  req.oncomplete = (err, result) => {
+    if (err) return callback(err);
+    callback(null, new StatsBatch(paths, result));
+  };
+  binding.statMany(paths.map(pathModule.toNamespacedPath), options.bigint,
+                   req);
+}
+
+function statManySync(paths, options = {}) {
+  paths = getValidatedPaths(paths);
+  if (paths.length === 0)
+    return new StatsBatch(paths);
+  const result = binding.statMany(paths.map(pathModule.toNamespacedPath),
+                                  options.bigint, undefined);
+  return new StatsBatch(paths, result);
+}
+
 function readlink(path, options, callback) {
   callback = makeCallback(typeof options === 'function' ? options : callback);
   options = getOptions(options, {});
@@ -1282,6 +1381,12 @@ function watch(filename, options, listener) {
 
 const statWatchers = new Map();
 
+function walk(path, options) {
+  if (walker === undefined)
+    walker = require('internal/fs/walk');
+  return walker.walk(path, options);
+}
+
 function watchFile(filename, options, listener) {
   filename = getValidatedPath(filename);
   filename = pathModule.resolve(filename);
@@ -1788,12 +1893,17 @@ module.exports = fs = {
   linkSync,
   lstat,
   lstatSync,
+  madvise,
   mkdir,
   mkdirSync,
   mkdtemp,
   mkdtempSync,
+  mmap,
+  munmap,
   open,
   openSync,
+  opendir,
+  opendirSync,
   readdir,
   readdirSync,
   read,
@@ -1809,6 +1919,8 @@ module.exports = fs = {
   rmdir,
   rmdirSync,
   stat,
+  statMany,
+  statManySync,
   statSync,
   symlink,
   symlinkSync,
@@ -1819,12 +1931,14 @@ module.exports = fs = {
   unlinkSync,
   utimes,
   utimesSync,
+  walk,
   watch,
   watchFile,
   writeFile,
   writeFileSync,
   write,
   writeSync,
+  Dir,
   Dirent,
   Stats,
 
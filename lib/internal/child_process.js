@@ -17,6 +17,7 @@ const {
   }
 } = require('internal/errors');
 const { validateString } = require('internal/validators');
+const { Buffer } = require('buffer');
 const EventEmitter = require('events');
 const net = require('net');
 const dgram = require('dgram');
@@ -124,8 +125,8 @@ const handleConversion = {
       // will be sent
       if (!options.keepOpen) {
         handle.onread = nop;
-        socket._handle = null;
         socket.setTimeout(0);
+        socket._handle = null;
 
         if (freeParser === undefined)
           freeParser = require('_http_common').freeParser;
@@ -985,6 +986,14 @@ function getValidStdio(stdio, sync) {
         handle: handle,
         _stdio: stdio
       });
+    } else if (sync && i !== 0 && isArrayBufferView(stdio)) {
+      // The child's output is read directly into the supplied buffer.
+      acc.push({
+        type: 'pipe',
+        readable: false,
+        writable: true,
+        output: stdio
+      });
     } else if (isArrayBufferView(stdio) || typeof stdio === 'string') {
       if (!sync) {
         cleanup();
@@ -1026,6 +1035,17 @@ function spawnSync(opts) {
   const options = opts.options;
   const result = spawn_sync.spawn(options);
 
+  if (result.output) {
+    // For caller-supplied output buffers, only the number of bytes that were
+    // written is returned.
+    for (var j = 0; j < result.output.length; j++) {
+      if (typeof result.output[j] === 'number') {
+        const { buffer, byteOffset } = options.stdio[j].output;
+        result.output[j] = Buffer.from(buffer, byteOffset, result.output[j]);
+      }
+    }
+  }
+
   if (result.output && options.encoding && options.encoding !== 'buffer') {
     for (var i = 0; i < result.output.length; i++) {
       if (!result.output[i])
@@ -4,7 +4,11 @@ const { Math } = primordials;
 
 const { AsyncWrap, Providers } = internalBinding('async_wrap');
 const { Buffer, kMaxLength } = require('buffer');
-const { randomBytes: _randomBytes } = internalBinding('crypto');
+const {
+  randomBytes: _randomBytes,
+  randomBytesPoolForkGeneration,
+  refillRandomBytesPool
+} = internalBinding('crypto');
 const {
   ERR_INVALID_ARG_TYPE,
   ERR_INVALID_CALLBACK,
@@ -16,6 +20,69 @@ const { isArrayBufferView } = require('internal/util/types');
 const kMaxUint32 = 2 ** 32 - 1;
 const kMaxPossibleLength = Math.min(kMaxLength, kMaxUint32);
 
+// Small synchronous requests are served from a pool of random bytes that is
+// filled in bulk, instead of calling into OpenSSL each time. A spare pool is
+// filled on the thread pool while the current one is being used up, so that
+// switching to it does not block. Every byte is handed out once. The pools are
+// discarded after fork(), see randomBytesPoolForkGeneration.
+const kPoolSize = 8 * 1024;
+const kPoolMaxRequest = 256;
+
+// The states of the spare pool. refillRandomBytesPool() sets it to
+// kSpareFilled or, on failure, to kSpareEmpty.
+const kSpareEmpty = 0;
+const kSpareFilled = 1;
+const kSparePending = 2;
+
+let pool = null;
+let poolOffset = kPoolSize;
+let poolForkGeneration = 0;
+let spare = null;
+let spareForkGeneration = 0;
+let spareState = null;
+
+function refillPool() {
+  const forkGeneration = randomBytesPoolForkGeneration[0];
+  if (pool === null || spareForkGeneration !== forkGeneration) {
+    // A refill that was pending in the parent process never completes.
+    pool = new Uint8Array(kPoolSize);
+    spare = new Uint8Array(kPoolSize);
+    spareState = new Int32Array(1);
+    spareForkGeneration = forkGeneration;
+  }
+
+  if (spareState[0] === kSpareFilled) {
+    const filled = spare;
+    spare = pool;
+    pool = filled;
+    spareState[0] = kSpareEmpty;
+  } else {
+    handleError(_randomBytes(pool, 0, kPoolSize));
+  }
+  poolOffset = 0;
+  poolForkGeneration = forkGeneration;
+}
+
+function randomFillFromPool(buf, offset, size) {
+  if (poolOffset + size > kPoolSize ||
+      poolForkGeneration !== randomBytesPoolForkGeneration[0]) {
+    refillPool();
+  }
+
+  const bytes = buf instanceof Uint8Array ?
+    buf : new Uint8Array(buf.buffer, buf.byteOffset, buf.byteLength);
+  for (let i = 0; i < size; i++) {
+    bytes[offset + i] = pool[poolOffset + i];
+    pool[poolOffset + i] = 0;
+  }
+  poolOffset += size;
+
+  if (poolOffset > kPoolSize / 2 && spareState[0] === kSpareEmpty) {
+    spareState[0] = kSparePending;
+    refillRandomBytesPool(spare, spareState);
+  }
+}
+
 function assertOffset(offset, elementSize, length) {
   validateNumber(offset, 'offset');
   offset *= elementSize;
@@ -51,7 +118,13 @@ function randomBytes(size, cb) {
 
   const buf = Buffer.alloc(size);
 
-  if (!cb) return handleError(_randomBytes(buf, 0, size), buf);
+  if (!cb) {
+    if (size > 0 && size <= kPoolMaxRequest) {
+      randomFillFromPool(buf, 0, size);
+      return buf;
+    }
+    return handleError(_randomBytes(buf, 0, size), buf);
+  }
 
   const wrap = new AsyncWrap(Providers.RANDOMBYTESREQUEST);
   wrap.ondone = (ex) => {  // Retains buf while request is in flight.
@@ -77,6 +150,10 @@ function randomFillSync(buf, offset = 0, size) {
     size = assertSize(size, elementSize, offset, buf.byteLength);
   }
 
+  if (size > 0 && size <= kPoolMaxRequest) {
+    randomFillFromPool(buf, offset, size);
+    return buf;
+  }
   return handleError(_randomBytes(buf, offset, size), buf);
 }
 
@@ -7,12 +7,12 @@ const {
   Resolver: CallbackResolver,
   validateHints,
   emitInvalidHostnameWarning,
+  startLookup,
 } = require('internal/dns/utils');
 const { codes, dnsException } = require('internal/errors');
 const { toASCII } = require('internal/idna');
 const { isIP, isLegalPort } = require('internal/net');
 const {
-  getaddrinfo,
   getnameinfo,
   ChannelWrap,
   GetAddrInfoReqWrap,
@@ -90,7 +90,7 @@ function createLookupPromise(family, hostname, all, hints, verbatim) {
     req.resolve = resolve;
     req.reject = reject;
 
-    const err = getaddrinfo(req, toASCII(hostname), family, hints, verbatim);
+    const err = startLookup(req, toASCII(hostname), family, hints, verbatim);
 
     if (err) {
       reject(dnsException(err, 'getaddrinfo', hostname));
@@ -3,6 +3,7 @@ const errors = require('internal/errors');
 const { isIP } = require('internal/net');
 const {
   ChannelWrap,
+  getaddrinfo,
   strerror,
   AI_ADDRCONFIG,
   AI_V4MAPPED
@@ -16,6 +17,8 @@ const {
   ERR_INVALID_IP_ADDRESS,
   ERR_INVALID_OPT_VALUE
 } = errors.codes;
+const kLookupHandle = Symbol('kLookupHandle');
+const kServersSet = Symbol('kServersSet');
 
 // Resolver instances correspond 1:1 to c-ares channels.
 class Resolver {
@@ -95,6 +98,8 @@ class Resolver {
       const err = strerror(errorNumber);
       throw new ERR_DNS_SET_SERVERS_FAILED(err, servers);
     }
+    this[kServersSet] = true;
+    this[kLookupHandle] = undefined;
   }
 }
 
@@ -139,6 +144,51 @@ function validateHints(hints) {
   }
 }
 
+let lookupMode;
+
+function getLookupMode() {
+  if (lookupMode === undefined) {
+    const { getOptionValue } = require('internal/options');
+    lookupMode = getOptionValue('--dns-lookup-mode');
+  }
+  return lookupMode;
+}
+
+function setLookupMode(mode) {
+  if (mode !== 'getaddrinfo' && mode !== 'cares')
+    throw new ERR_INVALID_OPT_VALUE('mode', mode);
+  lookupMode = mode;
+}
+
+// In 'cares' mode, lookups run on a channel of their own, so that pending
+// lookups do not count as pending queries of the default resolver when its
+// servers are changed. The channel uses the servers of the default resolver.
+function getLookupHandle(resolver) {
+  let handle = resolver[kLookupHandle];
+  if (handle === undefined) {
+    handle = new ChannelWrap();
+    if (resolver[kServersSet]) {
+      const servers = resolver._handle.getServers().map(
+        ([ip, port]) => [isIP(ip), ip, port]);
+      const errorNumber = handle.setServers(servers);
+      if (errorNumber !== 0)
+        throw new ERR_DNS_SET_SERVERS_FAILED(strerror(errorNumber), servers);
+    }
+    resolver[kLookupHandle] = handle;
+  }
+  return handle;
+}
+
+// Starts a dns.lookup() request with the resolver selected by the lookup
+// mode. In 'cares' mode, the servers set by dns.setServers() apply to it.
+function startLookup(req, hostname, family, hints, verbatim) {
+  if (getLookupMode() === 'cares') {
+    return getLookupHandle(defaultResolver).lookup(
+      req, hostname, family, hints, verbatim);
+  }
+  return getaddrinfo(req, hostname, family, hints, verbatim);
+}
+
 let invalidHostnameWarningEmitted = false;
 
 function emitInvalidHostnameWarning(hostname) {
@@ -161,4 +211,7 @@ module.exports = {
   validateHints,
   Resolver,
   emitInvalidHostnameWarning,
+  getLookupMode,
+  setLookupMode,
+  startLookup,
 };
@@ -0,0 +1,265 @@
+'use strict';
+
+const { Object } = primordials;
+
+const pathModule = require('path');
+const binding = internalBinding('fs');
+const {
+  codes: {
+    ERR_DIR_CLOSED,
+    ERR_DIR_CONCURRENT_OPERATION,
+    ERR_INVALID_CALLBACK,
+    ERR_MISSING_ARGS
+  }
+} = require('internal/errors');
+
+const { FSReqCallback, kUsePromises } = binding;
+const { promisify } = require('internal/util');
+const {
+  getDirents,
+  getOptions,
+  getValidatedPath,
+  handleErrorFromBinding
+} = require('internal/fs/utils');
+const { validateInt32 } = require('internal/validators');
+
+const kDirHandle = Symbol('kDirHandle');
+const kDirPath = Symbol('kDirPath');
+const kDirBufferedEntries = Symbol('kDirBufferedEntries');
+const kDirClosed = Symbol('kDirClosed');
+const kDirOptions = Symbol('kDirOptions');
+const kDirReadImpl = Symbol('kDirReadImpl');
+const kDirReadPromisified = Symbol('kDirReadPromisified');
+const kDirClosePromisified = Symbol('kDirClosePromisified');
+const kDirOperationQueue = Symbol('kDirOperationQueue');
+
+// The number of entries that each read from the directory returns.
+const kDefaultBufferSize = 32;
+const kMaxBufferSize = 4096;
+
+function getDirOptions(options) {
+  options = getOptions(options, {
+    encoding: 'utf8',
+    bufferSize: kDefaultBufferSize
+  });
+  validateInt32(options.bufferSize, 'options.bufferSize', 1, kMaxBufferSize);
+  return options;
+}
+
+class Dir {
+  constructor(handle, path, options) {
+    if (handle == null) throw new ERR_MISSING_ARGS('handle');
+    this[kDirHandle] = handle;
+    this[kDirPath] = path;
+    this[kDirBufferedEntries] = [];
+    this[kDirClosed] = false;
+    // Operations that wait for the pending asynchronous read, or null if
+    // there is none.
+    this[kDirOperationQueue] = null;
+    this[kDirOptions] = options;
+
+    this[kDirReadPromisified] = promisify(this[kDirReadImpl]).bind(this, false);
+    this[kDirClosePromisified] = promisify(this.close).bind(this);
+  }
+
+  get path() {
+    return this[kDirPath];
+  }
+
+  read(callback) {
+    return this[kDirReadImpl](true, callback);
+  }
+
+  [kDirReadImpl](maybeSync, callback) {
+    if (this[kDirClosed] === true) {
+      throw new ERR_DIR_CLOSED();
+    }
+
+    if (callback === undefined) {
+      return this[kDirReadPromisified]();
+    } else if (typeof callback !== 'function') {
+      throw new ERR_INVALID_CALLBACK(callback);
+    }
+
+    if (this[kDirOperationQueue] !== null) {
+      this[kDirOperationQueue].push(() => {
+        this[kDirReadImpl](maybeSync, callback);
+      });
+      return;
+    }
+
+    if (this[kDirBufferedEntries].length > 0) {
+      const dirent = this[kDirBufferedEntries].shift();
+      if (maybeSync)
+        process.nextTick(callback, null, dirent);
+      else
+        callback(null, dirent);
+      return;
+    }
+
+    const done = (err, dirent) => {
+      const queue = this[kDirOperationQueue];
+      this[kDirOperationQueue] = null;
+      process.nextTick(() => {
+        for (const op of queue) op();
+      });
+      callback(err, dirent);
+    };
+
+    const req = new FSReqCallback();
+    req.oncomplete = (err, result) => {
+      if (err || result === null) {
+        done(err, null);
+        return;
+      }
+      getDirents(this[kDirPath], result, (err, dirents) => {
+        if (err) {
+          done(err, null);
+          return;
+        }
+        this[kDirBufferedEntries] = dirents;
+        done(null, dirents.shift());
+      });
+    };
+
+    this[kDirOperationQueue] = [];
+    const { encoding, bufferSize } = this[kDirOptions];
+    this[kDirHandle].read(encoding, bufferSize, req);
+  }
+
+  readSync() {
+    if (this[kDirClosed] === true) {
+      throw new ERR_DIR_CLOSED();
+    }
+
+    if (this[kDirOperationQueue] !== null) {
+      throw new ERR_DIR_CONCURRENT_OPERATION();
+    }
+
+    if (this[kDirBufferedEntries].length > 0) {
+      return this[kDirBufferedEntries].shift();
+    }
+
+    const ctx = { path: this[kDirPath] };
+    const { encoding, bufferSize } = this[kDirOptions];
+    const result = this[kDirHandle].read(encoding, bufferSize, undefined, ctx);
+    handleErrorFromBinding(ctx);
+
+    if (result === null) {
+      return result;
+    }
+
+    this[kDirBufferedEntries] = getDirents(this[kDirPath], result);
+    return this[kDirBufferedEntries].shift();
+  }
+
+  close(callback) {
+    if (this[kDirClosed] === true) {
+      throw new ERR_DIR_CLOSED();
+    }
+
+    if (callback === undefined) {
+      return this[kDirClosePromisified]();
+    } else if (typeof callback !== 'function') {
+      throw new ERR_INVALID_CALLBACK(callback);
+    }
+
+    if (this[kDirOperationQueue] !== null) {
+      this[kDirOperationQueue].push(() => {
+        this.close(callback);
+      });
+      return;
+    }
+
+    this[kDirClosed] = true;
+    this[kDirBufferedEntries] = [];
+    const req = new FSReqCallback();
+    req.oncomplete = callback;
+    this[kDirHandle].close(req);
+  }
+
+  closeSync() {
+    if (this[kDirClosed] === true) {
+      throw new ERR_DIR_CLOSED();
+    }
+
+    if (this[kDirOperationQueue] !== null) {
+      throw new ERR_DIR_CONCURRENT_OPERATION();
+    }
+
+    this[kDirClosed] = true;
+    this[kDirBufferedEntries] = [];
+    const ctx = { path: this[kDirPath] };
+    this[kDirHandle].close(undefined, ctx);
+    handleErrorFromBinding(ctx);
+  }
+
+  async* entries() {
+    try {
+      while (true) {
+        const result = await this[kDirReadPromisified]();
+        if (result === null) {
+          break;
+        }
+        yield result;
+      }
+    } finally {
+      if (this[kDirClosed] === false) {
+        await this[kDirClosePromisified]();
+      }
+    }
+  }
+}
+
+Object.defineProperty(Dir.prototype, Symbol.asyncIterator, {
+  enumerable: false,
+  writable: true,
+  configurable: true,
+  value: Dir.prototype.entries,
+});
+
+function opendir(path, options, callback) {
+  callback = typeof options === 'function' ? options : callback;
+  if (typeof callback !== 'function') {
+    throw new ERR_INVALID_CALLBACK(callback);
+  }
+  path = getValidatedPath(path);
+  options = getDirOptions(options);
+
+  const req = new FSReqCallback();
+  req.oncomplete = (err, handle) => {
+    if (err) {
+      callback(err);
+    } else {
+      callback(null, new Dir(handle, path, options));
+    }
+  };
+  binding.opendir(pathModule.toNamespacedPath(path), req);
+}
+
+function opendirSync(path, options) {
+  path = getValidatedPath(path);
+  options = getDirOptions(options);
+
+  const ctx = { path };
+  const handle = binding.opendir(pathModule.toNamespacedPath(path),
+                                 undefined, ctx);
+  handleErrorFromBinding(ctx);
+
+  return new Dir(handle, path, options);
+}
+
+async function opendirPromise(path, options) {
+  path = getValidatedPath(path);
+  options = getDirOptions(options);
+  const handle = await binding.opendir(pathModule.toNamespacedPath(path),
+                                       kUsePromises);
+  return new Dir(handle, path, options);
+}
+
+module.exports = {
+  Dir,
+  opendir,
+  opendirPromise,
+  opendirSync
+};
@@ -24,8 +24,10 @@ const {
   getOptions,
   getStatsFromBinding,
   getValidatedPath,
+  getValidatedPaths,
   nullCheck,
   preprocessSymlinkDestination,
+  StatsBatch,
   stringToFlags,
   stringToSymlinkType,
   toUnixTimestamp,
@@ -41,6 +43,7 @@ const {
 } = require('internal/validators');
 const pathModule = require('path');
 const { promisify } = require('internal/util');
+const { opendirPromise: opendir } = require('internal/fs/dir');
 
 const kHandle = Symbol('handle');
 const { kUsePromises } = binding;
@@ -355,6 +358,15 @@ async function stat(path, options = { bigint: false }) {
   return getStatsFromBinding(result);
 }
 
+async function statMany(paths, options = { bigint: false }) {
+  paths = getValidatedPaths(paths);
+  if (paths.length === 0)
+    return new StatsBatch(paths);
+  const result = await binding.statMany(
+    paths.map(pathModule.toNamespacedPath), options.bigint, kUsePromises);
+  return new StatsBatch(paths, result);
+}
+
 async function link(existingPath, newPath) {
   existingPath = getValidatedPath(existingPath, 'existingPath');
   newPath = getValidatedPath(newPath, 'newPath');
@@ -467,14 +479,20 @@ async function readFile(path, options) {
   if (path instanceof FileHandle)
     return readFileHandle(path, options);
 
-  const fd = await open(path, flag, 0o666);
-  return readFileHandle(fd, options).finally(fd.close.bind(fd));
+  path = getValidatedPath(path);
+  const data = await binding.readFile(pathModule.toNamespacedPath(path),
+                                      stringToFlags(flag), options.encoding,
+                                      kUsePromises);
+  if (typeof data === 'number')
+    throw new ERR_FS_FILE_TOO_LARGE(data);
+  return data;
 }
 
 module.exports = {
   access,
   copyFile,
   open,
+  opendir,
   rename,
   truncate,
   rmdir,
@@ -484,6 +502,7 @@ module.exports = {
   symlink,
   lstat,
   stat,
+  statMany,
   link,
   unlink,
   chmod,
@@ -12,7 +12,8 @@ const {
     ERR_INVALID_OPT_VALUE_ENCODING,
     ERR_OUT_OF_RANGE
   },
-  hideStackFrames
+  hideStackFrames,
+  uvException
 } = require('internal/errors');
 const {
   isUint8Array,
@@ -52,6 +53,7 @@ const {
   UV_DIRENT_CHAR,
   UV_DIRENT_BLOCK
 } = internalBinding('constants').fs;
+const { kFsStatsFieldsNumber } = internalBinding('fs');
 
 const isWindows = process.platform === 'win32';
 
@@ -172,6 +174,23 @@ function getDirents(path, [names, types], callback) {
   }
 }
 
+function handleErrorFromBinding(ctx) {
+  if (ctx.errno !== undefined) {  // libuv error numbers
+    const err = uvException(ctx);
+    // eslint-disable-next-line no-restricted-syntax
+    Error.captureStackTrace(err, handleErrorFromBinding);
+    throw err;
+  }
+  if (ctx.error !== undefined) {  // Errors created in C++ land.
+    // TODO(joyeecheung): currently, ctx.error are encoding errors
+    // usually caused by memory problems. We need to figure out proper error
+    // code(s) for this.
+    // eslint-disable-next-line no-restricted-syntax
+    Error.captureStackTrace(ctx.error, handleErrorFromBinding);
+    throw ctx.error;
+  }
+}
+
 function getOptions(options, defaultOptions) {
   if (options === null || options === undefined ||
       typeof options === 'function') {
@@ -320,6 +339,47 @@ function getStatsFromBinding(stats, offset = 0) {
                    stats[12 + offset], stats[13 + offset]);
 }
 
+// The result of fs.statMany(). `stats` holds kFsStatsFieldsNumber fields per
+// path, in the layout that getStatsFromBinding() expects, and `errors` holds
+// the libuv error code of each path that could not be stat'ed. `result` is
+// the [stats, errors] pair returned by binding.statMany(), which is not
+// called for an empty list of paths.
+class StatsBatch {
+  constructor(paths, result) {
+    this.paths = paths;
+    if (result === undefined) {
+      this.stats = new Float64Array(0);
+      this.errors = new Int32Array(0);
+    } else {
+      this.stats = result[0];
+      this.errors = result[1];
+    }
+  }
+
+  get length() {
+    return this.paths.length;
+  }
+
+  stat(index) {
+    if (this.errors[index] !== 0)
+      return undefined;
+    return getStatsFromBinding(this.stats, index * kFsStatsFieldsNumber);
+  }
+
+  error(index) {
+    const errno = this.errors[index];
+    if (errno === 0)
+      return undefined;
+    return uvException({ errno, syscall: 'stat', path: this.paths[index] });
+  }
+}
+
+function getValidatedPaths(paths) {
+  if (!Array.isArray(paths))
+    throw new ERR_INVALID_ARG_TYPE('paths', 'Array', paths);
+  return paths.map((path, i) => getValidatedPath(path, `paths[${i}]`));
+}
+
 function stringToFlags(flags) {
   if (typeof flags === 'number') {
     return flags;
@@ -458,6 +518,8 @@ module.exports = {
   getDirents,
   getOptions,
   getValidatedPath,
+  getValidatedPaths,
+  handleErrorFromBinding,
   nullCheck,
   preprocessSymlinkDestination,
   realpathCacheKey: Symbol('realpathCacheKey'),
@@ -465,6 +527,7 @@ module.exports = {
   stringToFlags,
   stringToSymlinkType,
   Stats,
+  StatsBatch,
   toUnixTimestamp,
   validateOffsetLengthRead,
   validateOffsetLengthWrite,
@@ -0,0 +1,147 @@
+'use strict';
+
+const { Math } = primordials;
+
+const pathModule = require('path');
+const { kFsStatsFieldsNumber, TreeWalker } = internalBinding('fs');
+const {
+  codes: {
+    ERR_INVALID_ARG_TYPE
+  },
+  uvException
+} = require('internal/errors');
+const {
+  Dirent,
+  getStatsFromBinding,
+  getValidatedPath
+} = require('internal/fs/utils');
+const {
+  validateInt32,
+  validateUint32
+} = require('internal/validators');
+
+const kDefaultBatchSize = 1024;
+const kMaxBatchSize = 65536;
+const kMaxDepth = 2 ** 32 - 1;
+
+// A batch of entries that were found by fs.walk(). The entries are stored in
+// a packed format, and are only turned into objects on demand.
+class WalkBatch {
+  constructor(paths, types, stats) {
+    this.paths = paths;
+    this.types = types;
+    this.stats = stats;
+  }
+
+  get length() {
+    return this.paths.length;
+  }
+
+  dirent(index) {
+    return new Dirent(this.paths[index], this.types[index]);
+  }
+
+  stat(index) {
+    if (this.stats === undefined)
+      return undefined;
+    return getStatsFromBinding(this.stats, index * kFsStatsFieldsNumber);
+  }
+}
+
+function validateOptions(options) {
+  if (options === null || typeof options !== 'object')
+    throw new ERR_INVALID_ARG_TYPE('options', 'Object', options);
+
+  let maxDepth = kMaxDepth;
+  if (options.maxDepth !== undefined && options.maxDepth !== Infinity) {
+    validateUint32(options.maxDepth, 'options.maxDepth');
+    maxDepth = Math.min(options.maxDepth, kMaxDepth);
+  }
+
+  let prefix = '';
+  if (options.prefix !== undefined) {
+    if (typeof options.prefix !== 'string')
+      throw new ERR_INVALID_ARG_TYPE('options.prefix', 'string',
+                                     options.prefix);
+    prefix = options.prefix;
+    if (pathModule.sep !== '/')
+      prefix = prefix.replace(/\//g, pathModule.sep);
+  }
+
+  let skipDirs = [];
+  if (options.skipDirs !== undefined) {
+    if (!Array.isArray(options.skipDirs))
+      throw new ERR_INVALID_ARG_TYPE('options.skipDirs', 'Array',
+                                     options.skipDirs);
+    skipDirs = options.skipDirs.map((name, i) => {
+      if (typeof name !== 'string')
+        throw new ERR_INVALID_ARG_TYPE(`options.skipDirs[${i}]`, 'string',
+                                       name);
+      return name;
+    });
+  }
+
+  let batchSize = kDefaultBatchSize;
+  if (options.batchSize !== undefined) {
+    validateInt32(options.batchSize, 'options.batchSize', 1, kMaxBatchSize);
+    batchSize = options.batchSize;
+  }
+
+  let concurrency = 0;  // The size of the threadpool.
+  if (options.concurrency !== undefined) {
+    validateInt32(options.concurrency, 'options.concurrency', 1, 1024);
+    concurrency = options.concurrency;
+  }
+
+  return {
+    maxDepth,
+    prefix,
+    skipDirs,
+    stat: !!options.stat,
+    batchSize,
+    concurrency
+  };
+}
+
+function readBatch(handle) {
+  return new Promise((resolve, reject) => {
+    handle.oncomplete = (errno, paths, types, stats) => {
+      if (errno < 0) {
+        reject(uvException({ errno, syscall: 'scandir', path: paths }));
+      } else if (paths === null) {
+        resolve(null);
+      } else {
+        resolve(new WalkBatch(paths, types, stats));
+      }
+    };
+    handle.read();
+  });
+}
+
+async function* walkBatches(path, options) {
+  const handle = new TreeWalker();
+  try {
+    handle.start(pathModule.toNamespacedPath(path), options.maxDepth,
+                 options.prefix, options.skipDirs, options.stat,
+                 options.batchSize, options.concurrency);
+    while (true) {
+      const batch = await readBatch(handle);
+      if (batch === null)
+        break;
+      yield batch;
+    }
+  } finally {
+    handle.close();
+  }
+}
+
+function walk(path, options = {}) {
+  path = getValidatedPath(path);
+  options = validateOptions(options);
+  return walkBatches(path, options);
+}
+
+module.exports = {
+  walk,
+  WalkBatch
+};
@@ -25,6 +25,7 @@ const { setImmediate } = require('timers');
 const { kIncomingMessage } = require('_http_common');
 const { kServerResponse } = require('_http_server');
 const JSStreamSocket = require('internal/js_stream_socket');
+const { kHandle: kCryptoHandle } = require('internal/crypto/util');
 
 const {
   defaultTriggerAsyncIdScope,
@@ -2069,7 +2070,7 @@ function onPipedFileHandleRead() {
 }
 
 function processRespondWithFD(self, fd, headers, offset = 0, length = -1,
-                              streamOptions = 0) {
+                              streamOptions = 0, transforms) {
   const state = self[kState];
   state.flags |= STREAM_FLAGS_HEADERS_SENT;
 
@@ -2095,15 +2096,42 @@ function processRespondWithFD(self, fd, headers, offset = 0, length = -1,
   }
 
   defaultTriggerAsyncIdScope(self[async_id_symbol], startFilePipe,
-                             self, fd, offset, length);
-}
+                             self, fd, offset, length, transforms);
+}
+
+// Returns the native handles of the zlib and Hash objects that were passed
+// as the `transforms` option.
+function validatePipeTransforms(transforms) {
+  if (!Array.isArray(transforms))
+    throw new ERR_INVALID_OPT_VALUE('transforms', transforms);
+  return transforms.map((transform) => {
+    if (transform !== null && typeof transform === 'object') {
+      const handle = transform[kCryptoHandle] || transform._handle;
+      if (handle && typeof handle.getPipeTransform === 'function')
+        return handle;
+    }
+    throw new ERR_INVALID_OPT_VALUE('transforms', transforms);
+  });
+}
+
+function startFilePipe(self, fd, offset, length, transforms) {
+  let pipeTransforms;
+  if (transforms !== undefined) {
+    // Transforms that are already used by another pipe can not be shared.
+    pipeTransforms = transforms.map((handle) => handle.getPipeTransform());
+    if (pipeTransforms.includes(undefined)) {
+      if (self.ownsFd)
+        tryClose(fd);
+      self.destroy(new ERR_INVALID_OPT_VALUE('transforms', transforms));
+      return;
+    }
+  }
 
-function startFilePipe(self, fd, offset, length) {
   const handle = new FileHandle(fd, offset, length);
   handle.onread = onPipedFileHandleRead;
   handle.stream = self;
 
-  const pipe = new StreamPipe(handle, self[kHandle]);
+  const pipe = new StreamPipe(handle, self[kHandle], pipeTransforms);
   pipe.onunpipe = onFileUnpipe;
   pipe.start();
 
@@ -2147,7 +2175,8 @@ function doSendFD(session, options, fd, headers, streamOptions, err, stat) {
   processRespondWithFD(this, fd, headers,
                        statOptions.offset | 0,
                        statOptions.length | 0,
-                       streamOptions);
+                       streamOptions,
+                       options.transforms);
 }
 
 function doSendFileFD(session, options, fd, headers, streamOptions, err, stat) {
@@ -2210,13 +2239,16 @@ function doSendFileFD(session, options, fd, headers, streamOptions, err, stat) {
         Math.min(stat.size - (+statOptions.offset),
                  statOptions.length);
 
-    headers[HTTP2_HEADER_CONTENT_LENGTH] = statOptions.length;
+    // Transforms such as compression change the length of the payload.
+    if (options.transforms === undefined)
+      headers[HTTP2_HEADER_CONTENT_LENGTH] = statOptions.length;
   }
 
   processRespondWithFD(this, fd, headers,
                        options.offset | 0,
                        statOptions.length | 0,
-                       streamOptions);
+                       streamOptions,
+                       options.transforms);
 }
 
 function afterOpen(session, options, headers, streamOptions, err, fd) {
@@ -2416,6 +2448,9 @@ class ServerHttp2Stream extends Http2Stream {
       throw new ERR_INVALID_OPT_VALUE('statCheck', options.statCheck);
     }
 
+    if (options.transforms !== undefined)
+      options.transforms = validatePipeTransforms(options.transforms);
+
     let streamOptions = 0;
     if (options.waitForTrailers) {
       streamOptions |= STREAM_OPTION_GET_TRAILERS;
@@ -2449,7 +2484,8 @@ class ServerHttp2Stream extends Http2Stream {
     processRespondWithFD(this, fd, headers,
                          options.offset,
                          options.length,
-                         streamOptions);
+                         streamOptions,
+                         options.transforms);
   }
 
   // Initiate a file response on this Http2Stream. The path is passed to
@@ -2479,6 +2515,9 @@ class ServerHttp2Stream extends Http2Stream {
       throw new ERR_INVALID_OPT_VALUE('statCheck', options.statCheck);
     }
 
+    if (options.transforms !== undefined)
+      options.transforms = validatePipeTransforms(options.transforms);
+
     let streamOptions = 0;
     if (options.waitForTrailers) {
       streamOptions |= STREAM_OPTION_GET_TRAILERS;
@@ -2,6 +2,7 @@
 
 const { Buffer } = require('buffer');
 const { FastBuffer } = require('internal/buffer');
+const { isUint8Array } = require('internal/util/types');
 const {
   WriteWrap,
   kReadBytesOrError,
@@ -30,6 +31,11 @@ const kUpdateTimer = Symbol('kUpdateTimer');
 const kAfterAsyncWrite = Symbol('kAfterAsyncWrite');
 const kHandle = Symbol('kHandle');
 const kSession = Symbol('kSession');
+const kBuffer = Symbol('kBuffer');
+const kBufferGen = Symbol('kBufferGen');
+const kBufferCb = Symbol('kBufferCb');
+const kFramesCb = Symbol('kFramesCb');
+const kFrameTrailerSize = Symbol('kFrameTrailerSize');
 
 const debug = require('internal/util/debuglog').debuglog('stream');
 
@@ -152,7 +158,7 @@ function afterWriteDispatched(self, req, err, cb) {
   }
 }
 
-function onStreamRead(arrayBuffer) {
+function onStreamRead(arrayBuffer, frameEnds) {
   const nread = streamBaseState[kReadBytesOrError];
 
   const handle = this;
@@ -161,9 +167,33 @@ function onStreamRead(arrayBuffer) {
   stream[kUpdateTimer]();
 
   if (nread > 0 && !stream.destroyed) {
-    const offset = streamBaseState[kArrayBufferOffset];
-    const buf = new FastBuffer(arrayBuffer, offset, nread);
-    if (!stream.push(buf)) {
+    let ret;
+    let result;
+    const userBuf = stream[kBuffer];
+    if (userBuf) {
+      result = (stream[kBufferCb](nread, userBuf) !== false);
+      const bufGen = stream[kBufferGen];
+      if (bufGen !== null) {
+        const nextBuf = bufGen();
+        if (isUint8Array(nextBuf))
+          stream[kBuffer] = ret = nextBuf;
+      }
+    } else if (frameEnds !== undefined) {
+      // Frame ends do not include trailing delimiters, if any.
+      const trailerSize = stream[kFrameTrailerSize];
+      const frames = new Array(frameEnds.length);
+      let start = streamBaseState[kArrayBufferOffset];
+      for (var i = 0; i < frameEnds.length; i++) {
+        frames[i] = new FastBuffer(arrayBuffer, start, frameEnds[i] - start);
+        start = frameEnds[i] + trailerSize;
+      }
+      result = (stream[kFramesCb](frames) !== false);
+    } else {
+      const offset = streamBaseState[kArrayBufferOffset];
+      const buf = new FastBuffer(arrayBuffer, offset, nread);
+      result = stream.push(buf);
+    }
+    if (!result) {
       handle.reading = false;
       if (!stream.destroyed) {
         const err = handle.readStop();
@@ -172,7 +202,7 @@ function onStreamRead(arrayBuffer) {
       }
     }
 
-    return;
+    return ret;
   }
 
   if (nread === 0) {
@@ -199,6 +229,23 @@ function onStreamRead(arrayBuffer) {
   }
 }
 
+function onStreamIdleTimeout() {
+  const stream = this[owner_symbol];
+  debug('idle timeout');
+  stream.emit('timeout');
+}
+
+// Handles that are backed by libuv streams keep track of idle timeouts
+// natively, so that reads and writes do not have to refresh a JS timer.
+function setHandleTimeout(stream, msecs) {
+  const handle = stream._handle;
+  if (handle == null || typeof handle.setIdleTimeout !== 'function')
+    return false;
+  handle.ontimeout = onStreamIdleTimeout;
+  handle.setIdleTimeout(msecs);
+  return true;
+}
+
 function setStreamTimeout(msecs, callback) {
   if (this.destroyed)
     return;
@@ -211,6 +258,7 @@ function setStreamTimeout(msecs, callback) {
   // Attempt to clear an existing timer in both cases -
   //  even if it will be rescheduled we don't want to leak an existing timer.
   clearTimeout(this[kTimeout]);
+  const isHandleTimeout = setHandleTimeout(this, msecs);
 
   if (msecs === 0) {
     if (callback !== undefined) {
@@ -219,7 +267,8 @@ function setStreamTimeout(msecs, callback) {
       this.removeListener('timeout', callback);
     }
   } else {
-    this[kTimeout] = setUnrefTimeout(this._onTimeout.bind(this), msecs);
+    if (!isHandleTimeout)
+      this[kTimeout] = setUnrefTimeout(this._onTimeout.bind(this), msecs);
     if (this[kSession]) this[kSession][kUpdateTimer]();
 
     if (callback !== undefined) {
@@ -241,5 +290,11 @@ module.exports = {
   kUpdateTimer,
   kHandle,
   kSession,
-  setStreamTimeout
+  setStreamTimeout,
+  setHandleTimeout,
+  kBuffer,
+  kBufferCb,
+  kBufferGen,
+  kFramesCb,
+  kFrameTrailerSize
 };
@@ -12,6 +12,7 @@ const {
   ERR_WORKER_PATH,
   ERR_WORKER_UNSERIALIZABLE_ERROR,
   ERR_WORKER_UNSUPPORTED_EXTENSION,
+  ERR_WORKER_INVALID_CPU_AFFINITY,
   ERR_WORKER_INVALID_EXEC_ARGV,
   ERR_INVALID_ARG_TYPE,
 } = require('internal/errors').codes;
@@ -74,6 +75,8 @@ class Worker extends EventEmitter {
                                      'array',
                                      options.execArgv);
     }
+    if (options.cpuAffinity !== undefined)
+      validateString(options.cpuAffinity, 'options.cpuAffinity');
     if (!options.eval) {
       if (!path.isAbsolute(filename) && !/^\.\.?[\\/]/.test(filename)) {
         throw new ERR_WORKER_PATH(filename);
@@ -106,6 +109,11 @@ class Worker extends EventEmitter {
     if (this[kHandle].invalidExecArgv) {
       throw new ERR_WORKER_INVALID_EXEC_ARGV(this[kHandle].invalidExecArgv);
     }
+    if (options.cpuAffinity !== undefined) {
+      const error = this[kHandle].setCpuAffinity(options.cpuAffinity);
+      if (error !== undefined)
+        throw new ERR_WORKER_INVALID_CPU_AFFINITY(options.cpuAffinity, error);
+    }
     if (env === process.env) {
       // This may be faster than manually cloning the object in C++, especially
       // when recursively spawning Workers.
@@ -43,6 +43,7 @@ const {
 } = internalBinding('uv');
 
 const { Buffer } = require('buffer');
+const { isUint8Array } = require('internal/util/types');
 const { guessHandleType } = internalBinding('util');
 const { ShutdownWrap } = internalBinding('stream_wrap');
 const {
@@ -67,26 +68,39 @@ const {
   kAfterAsyncWrite,
   kHandle,
   kUpdateTimer,
-  setStreamTimeout
+  setStreamTimeout,
+  setHandleTimeout,
+  kBuffer,
+  kBufferCb,
+  kBufferGen,
+  kFramesCb,
+  kFrameTrailerSize
 } = require('internal/stream_base_commons');
 const {
   codes: {
     ERR_INVALID_ADDRESS_FAMILY,
     ERR_INVALID_ARG_TYPE,
     ERR_INVALID_ARG_VALUE,
+    ERR_INVALID_CALLBACK,
     ERR_INVALID_FD_TYPE,
     ERR_INVALID_IP_ADDRESS,
     ERR_INVALID_OPT_VALUE,
+    ERR_INVALID_OPT_VALUE_ENCODING,
     ERR_SERVER_ALREADY_LISTEN,
     ERR_SERVER_NOT_RUNNING,
     ERR_SOCKET_BAD_PORT,
-    ERR_SOCKET_CLOSED
+    ERR_SOCKET_CLOSED,
+    ERR_SOCKET_FRAMING_ALREADY_SET
   },
   errnoException,
   exceptionWithHostPort,
   uvExceptionWithHostPort
 } = require('internal/errors');
-const { validateInt32, validateString } = require('internal/validators');
+const {
+  validateInt32,
+  validateString,
+  validateUint32
+} = require('internal/validators');
 const kLastWriteQueueSize = Symbol('lastWriteQueueSize');
 const {
   DTRACE_NET_SERVER_CONNECTION,
@@ -225,6 +239,26 @@ function initSocketHandle(self) {
     self._handle[owner_symbol] = self;
     self._handle.onread = onStreamRead;
     self[async_id_symbol] = getNewAsyncId(self._handle);
+
+    // Hand a timeout that was set before the handle existed over to it.
+    const timeout = self[kTimeout];
+    if (timeout !== null && timeout._idleTimeout > 0 &&
+        setHandleTimeout(self, timeout._idleTimeout)) {
+      clearTimeout(timeout);
+      self[kTimeout] = null;
+    }
+
+    let userBuf = self[kBuffer];
+    if (userBuf) {
+      const bufGen = self[kBufferGen];
+      if (bufGen !== null) {
+        userBuf = bufGen();
+        if (!isUint8Array(userBuf))
+          return;
+        self[kBuffer] = userBuf;
+      }
+      self._handle.useUserBuffer(userBuf);
+    }
   }
 }
 
@@ -247,6 +281,11 @@ function Socket(options) {
   this._host = null;
   this[kLastWriteQueueSize] = 0;
   this[kTimeout] = null;
+  this[kBuffer] = null;
+  this[kBufferCb] = null;
+  this[kBufferGen] = null;
+  this[kFramesCb] = null;
+  this[kFrameTrailerSize] = 0;
 
   if (typeof options === 'number')
     options = { fd: options }; // Legacy interface.
@@ -308,6 +347,19 @@ function Socket(options) {
     }
   }
 
+  const onread = options.onread;
+  if (onread !== null && typeof onread === 'object' &&
+      (isUint8Array(onread.buffer) || typeof onread.buffer === 'function') &&
+      typeof onread.callback === 'function') {
+    if (typeof onread.buffer === 'function') {
+      this[kBuffer] = true;
+      this[kBufferGen] = onread.buffer;
+    } else {
+      this[kBuffer] = onread.buffer;
+    }
+    this[kBufferCb] = onread.callback;
+  }
+
   // Shut down the socket when we're finished with it.
   this.on('end', onReadableStreamEnd);
 
@@ -450,6 +502,100 @@ Socket.prototype.setNoDelay = function(enable) {
 };
 
 
+Socket.prototype.setWriteCoalescing = function(enable, maxBytes = 0) {
+  validateUint32(maxBytes, 'maxBytes');
+
+  if (!this._handle) {
+    this.once('connect', () => this.setWriteCoalescing(enable, maxBytes));
+    return this;
+  }
+
+  if (this._handle.setWriteCoalescing) {
+    this._handle.setWriteCoalescing(enable === undefined ? true : !!enable,
+                                    maxBytes);
+  }
+
+  return this;
+};
+
+
+const kDefaultMaxFrameSize = 1024 * 1024;
+
+Socket.prototype.setFraming = function(options, callback) {
+  if (options === null || typeof options !== 'object')
+    throw new ERR_INVALID_ARG_TYPE('options', 'Object', options);
+  if (typeof callback !== 'function')
+    throw new ERR_INVALID_CALLBACK(callback);
+  if (this[kFramesCb] !== null || this[kBuffer])
+    throw new ERR_SOCKET_FRAMING_ALREADY_SET();
+
+  const { maxFrameSize = kDefaultMaxFrameSize } = options;
+  validateUint32(maxFrameSize, 'options.maxFrameSize', true);
+
+  let setup;
+  if (options.delimiter !== undefined) {
+    if (typeof options.delimiter !== 'string' &&
+        !isUint8Array(options.delimiter)) {
+      throw new ERR_INVALID_ARG_TYPE('options.delimiter',
+                                     ['string', 'Buffer', 'Uint8Array'],
+                                     options.delimiter);
+    }
+    const delimiter = Buffer.from(options.delimiter);
+    if (delimiter.length === 0)
+      throw new ERR_INVALID_OPT_VALUE('delimiter', options.delimiter);
+
+    const { encoding } = options;
+    if (encoding !== undefined && !Buffer.isEncoding(encoding))
+      throw new ERR_INVALID_OPT_VALUE_ENCODING(encoding);
+    if (encoding !== undefined) {
+      const userCallback = callback;
+      callback = (frames) => {
+        for (var i = 0; i < frames.length; i++)
+          frames[i] = frames[i].toString(encoding);
+        return userCallback(frames);
+      };
+    }
+
+    this[kFrameTrailerSize] = delimiter.length;
+    setup = () => {
+      this._handle.useDelimiterFraming(delimiter, maxFrameSize);
+    };
+  } else {
+    const {
+      lengthSize,
+      lengthOffset = 0,
+      headerSize = lengthOffset + lengthSize,
+      littleEndian = false,
+      lengthIncludesHeader = false
+    } = options;
+    if (lengthSize !== 1 && lengthSize !== 2 && lengthSize !== 4) {
+      throw new ERR_INVALID_OPT_VALUE('lengthSize', lengthSize);
+    }
+    validateUint32(lengthOffset, 'options.lengthOffset');
+    validateUint32(headerSize, 'options.headerSize');
+    if (headerSize < lengthOffset + lengthSize)
+      throw new ERR_INVALID_OPT_VALUE('headerSize', headerSize);
+
+    setup = () => {
+      this._handle.useLengthPrefixedFraming(headerSize,
+                                            lengthOffset,
+                                            lengthSize,
+                                            !!littleEndian,
+                                            !!lengthIncludesHeader,
+                                            maxFrameSize);
+    };
+  }
+
+  this[kFramesCb] = callback;
+  if (this._handle)
+    setup();
+  else
+    this.once('connect', setup);
+
+  return this;
+};
+
+
 Socket.prototype.setKeepAlive = function(setting, msecs) {
   if (!this._handle) {
     this.once('connect', () => this.setKeepAlive(setting, msecs));
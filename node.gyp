@@ -146,11 +146,13 @@
       'lib/internal/fixed_queue.js',
       'lib/internal/freelist.js',
       'lib/internal/freeze_intrinsics.js',
+      'lib/internal/fs/dir.js',
       'lib/internal/fs/promises.js',
       'lib/internal/fs/read_file_context.js',
       'lib/internal/fs/streams.js',
       'lib/internal/fs/sync_write_stream.js',
       'lib/internal/fs/utils.js',
+      'lib/internal/fs/walk.js',
       'lib/internal/fs/watchers.js',
       'lib/internal/http.js',
       'lib/internal/idna.js',
@@ -554,6 +556,7 @@
         'src/connect_wrap.cc',
         'src/connection_wrap.cc',
         'src/debug_utils.cc',
+        'src/dns_cache.cc',
         'src/env.cc',
         'src/fs_event_wrap.cc',
         'src/handle_wrap.cc',
@@ -567,6 +570,7 @@
         'src/module_wrap.cc',
         'src/node.cc',
         'src/node_snapshot_stub.cc',
+        'src/node_affinity.cc',
         'src/node_api.cc',
         'src/node_binding.cc',
         'src/node_buffer.cc',
@@ -585,6 +589,7 @@
         'src/node_main_instance.cc',
         'src/node_messaging.cc',
         'src/node_metadata.cc',
+        'src/node_mmap.cc',
         'src/node_native_module.cc',
         'src/node_native_module_env.cc',
         'src/node_options.cc',
@@ -597,6 +602,7 @@
         'src/node_process_object.cc',
         'src/node_serdes.cc',
         'src/node_stat_watcher.cc',
+        'src/node_tree_walker.cc',
         'src/node_symbols.cc',
         'src/node_task_queue.cc',
         'src/node_trace_events.cc',
@@ -611,13 +617,16 @@
         'src/process_wrap.cc',
         'src/sharedarraybuffer_metadata.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/spawn_sync.cc',
         'src/stream_base.cc',
+        'src/stream_framing.cc',
         'src/stream_pipe.cc',
         'src/stream_wrap.cc',
         'src/string_bytes.cc',
         'src/string_decoder.cc',
         'src/tcp_wrap.cc',
+        'src/timer_wheel.cc',
         'src/timers.cc',
         #'src/tracing/agent.cc',
         #'src/tracing/node_trace_buffer.cc',
@@ -638,6 +647,7 @@
         'src/connect_wrap.h',
         'src/connection_wrap.h',
         'src/debug_utils.h',
+        'src/dns_cache.h',
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
@@ -649,6 +659,7 @@
         'src/memory_tracker-inl.h',
         'src/module_wrap.h',
         'src/node.h',
+        'src/node_affinity.h',
         'src/node_api.h',
         'src/node_api_types.h',
         'src/node_binding.h',
@@ -666,6 +677,7 @@
         'src/node_main_instance.h',
         'src/node_messaging.h',
         'src/node_metadata.h',
+        'src/node_mmap.h',
         'src/node_mutex.h',
         'src/node_native_module.h',
         'src/node_native_module_env.h',
@@ -679,6 +691,7 @@
         'src/node_revert.h',
         'src/node_root_certs.h',
         'src/node_stat_watcher.h',
+        'src/node_tree_walker.h',
         'src/node_union_bytes.h',
         'src/node_url.h',
         'src/node_version.h',
@@ -689,9 +702,11 @@
         'src/req_wrap.h',
         'src/req_wrap-inl.h',
         'src/sharedarraybuffer_metadata.h',
+        'src/slab_allocator.h',
         'src/spawn_sync.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
+        'src/stream_framing.h',
         'src/stream_pipe.h',
         'src/stream_wrap.h',
         'src/string_bytes.h',
@@ -699,6 +714,7 @@
         'src/string_decoder-inl.h',
         'src/string_search.h',
         'src/tcp_wrap.h',
+        'src/timer_wheel.h',
         'src/tracing/agent.h',
         'src/tracing/node_trace_buffer.h',
         'src/tracing/node_trace_writer.h',
@@ -836,11 +852,13 @@
             'src/node_crypto.cc',
             'src/node_crypto_bio.cc',
             'src/node_crypto_clienthello.cc',
+            'src/node_crypto_session_cache.cc',
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
             'src/node_crypto_clienthello-inl.h',
             'src/node_crypto_groups.h',
+            'src/node_crypto_session_cache.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
@@ -1143,11 +1161,13 @@
         'test/cctest/node_test_fixture.h',
         'test/cctest/test_aliased_buffer.cc',
         'test/cctest/test_base64.cc',
+        'test/cctest/test_dns_cache.cc',
         'test/cctest/test_node_postmortem_metadata.cc',
         'test/cctest/test_environment.cc',
         'test/cctest/test_linked_binding.cc',
         'test/cctest/test_per_process.cc',
         'test/cctest/test_platform.cc',
+        'test/cctest/test_timer_wheel.cc',
         'test/cctest/test_traced_value.cc',
         'test/cctest/test_util.cc',
         'test/cctest/test_url.cc',
@@ -22,6 +22,7 @@
 #define CARES_STATICLIB
 #include "ares.h"
 #include "async_wrap-inl.h"
+#include "dns_cache.h"
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
 #include "node.h"
@@ -32,6 +33,7 @@
 #include <cerrno>
 #include <cstring>
 #include <memory>
+#include <string>
 #include <vector>
 #include <unordered_set>
 
@@ -57,8 +59,10 @@ namespace node {
 namespace cares_wrap {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
@@ -68,6 +72,7 @@ using v8::Local;
 using v8::Null;
 using v8::Object;
 using v8::String;
+using v8::Uint32;
 using v8::Value;
 
 namespace {
@@ -214,6 +219,11 @@ void ChannelWrap::New(const FunctionCallbackInfo<Value>& args) {
   new ChannelWrap(env, args.This());
 }
 
+}  // anonymous namespace
+
+// A dns.lookup() request. When the DNS cache is enabled, concurrent lookups
+// of the same name are coalesced: only the first request is dispatched, and
+// the others are added to it as followers and completed along with it.
 class GetAddrInfoReqWrap : public ReqWrap<uv_getaddrinfo_t> {
  public:
   GetAddrInfoReqWrap(Environment* env,
@@ -226,8 +236,32 @@ class GetAddrInfoReqWrap : public ReqWrap<uv_getaddrinfo_t> {
 
   bool verbatim() const { return verbatim_; }
 
+  // Passes the result of the lookup to JS.
+  void Complete(int status, const DnsCache::AddressList& addresses);
+  // Completes the request with a cached result on the next loop iteration.
+  // This transfers ownership of the request to the Environment.
+  void CompleteFromCache(int status, DnsCache::AddressList&& addresses);
+
+  inline const std::string& cache_key() const { return cache_key_; }
+  inline void set_cache_key(const std::string& key) { cache_key_ = key; }
+  // Requests that only refresh a stale cache entry do not call into JS.
+  inline bool refresh_only() const { return refresh_only_; }
+  inline void set_refresh_only() { refresh_only_ = true; }
+
+  inline void AddFollower(std::unique_ptr<GetAddrInfoReqWrap> follower) {
+    followers_.emplace_back(std::move(follower));
+  }
+  inline std::vector<std::unique_ptr<GetAddrInfoReqWrap>>* followers() {
+    return &followers_;
+  }
+
  private:
   const bool verbatim_;
+  bool refresh_only_ = false;
+  std::string cache_key_;
+  std::vector<std::unique_ptr<GetAddrInfoReqWrap>> followers_;
+  int cached_status_ = 0;
+  DnsCache::AddressList cached_addresses_;
 };
 
 GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
@@ -237,6 +271,59 @@ GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
     , verbatim_(verbatim) {
 }
 
+void GetAddrInfoReqWrap::Complete(int status,
+                                  const DnsCache::AddressList& addresses) {
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+
+  Local<Value> argv[] = {
+    Integer::New(env()->isolate(), status),
+    Null(env()->isolate())
+  };
+
+  uint64_t n = 0;
+  if (status == 0) {
+    Local<Array> results = Array::New(env()->isolate());
+
+    auto add = [&] (bool want_ipv4, bool want_ipv6) {
+      for (const DnsCache::Address& address : addresses) {
+        if ((want_ipv4 && address.family == AF_INET) ||
+            (want_ipv6 && address.family == AF_INET6)) {
+          Local<String> s = OneByteString(env()->isolate(), address.ip.c_str());
+          results->Set(env()->context(), n, s).Check();
+          n++;
+        }
+      }
+    };
+
+    add(true, verbatim_);
+    if (verbatim_ == false)
+      add(false, true);
+
+    argv[1] = results;
+  }
+
+  TRACE_EVENT_NESTABLE_ASYNC_END2(
+      TRACING_CATEGORY_NODE2(dns, native), "lookup", this,
+      "count", n, "verbatim", verbatim_);
+
+  // Make the callback into JavaScript
+  MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+}
+
+void GetAddrInfoReqWrap::CompleteFromCache(int status,
+                                           DnsCache::AddressList&& addresses) {
+  cached_status_ = status;
+  cached_addresses_ = std::move(addresses);
+  env()->SetImmediate([](Environment* env, void* data) {
+    std::unique_ptr<GetAddrInfoReqWrap> req_wrap {
+        static_cast<GetAddrInfoReqWrap*>(data)};
+    req_wrap->Complete(req_wrap->cached_status_, req_wrap->cached_addresses_);
+  }, static_cast<void*>(this), object());
+}
+
+namespace {
+
 
 class GetNameInfoReqWrap : public ReqWrap<uv_getnameinfo_t> {
  public:
@@ -1806,71 +1893,189 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+uint64_t DnsCacheNow() {
+  return uv_hrtime() / 1000000;
+}
+
+// Stores the result of a lookup in the DNS cache, if it is used for the
+// request, and passes it to JS.
+void FinishLookup(std::unique_ptr<GetAddrInfoReqWrap> req_wrap,
+                  int status,
+                  const DnsCache::AddressList& addresses) {
+  Environment* env = req_wrap->env();
+  const std::string& key = req_wrap->cache_key();
+  if (!key.empty()) {
+    auto it = env->pending_dns_lookups.find(key);
+    if (it != env->pending_dns_lookups.end() && it->second == req_wrap.get())
+      env->pending_dns_lookups.erase(it);
+    DnsCache::GetInstance()->Store(key, DnsCacheNow(), status, addresses);
+  }
+
+  if (!req_wrap->refresh_only())
+    req_wrap->Complete(status, addresses);
+  for (auto& follower : *req_wrap->followers())
+    follower->Complete(status, addresses);
+}
+
 void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
   std::unique_ptr<GetAddrInfoReqWrap> req_wrap {
       static_cast<GetAddrInfoReqWrap*>(req->data)};
-  Environment* env = req_wrap->env();
 
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
+  DnsCache::AddressList addresses;
+  if (status == 0) {
+    for (auto p = res; p != nullptr; p = p->ai_next) {
+      CHECK_EQ(p->ai_socktype, SOCK_STREAM);
+
+      const char* addr;
+      if (p->ai_family == AF_INET) {
+        addr = reinterpret_cast<char*>(
+            &(reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr));
+      } else if (p->ai_family == AF_INET6) {
+        addr = reinterpret_cast<char*>(
+            &(reinterpret_cast<struct sockaddr_in6*>(p->ai_addr)->sin6_addr));
+      } else {
+        continue;
+      }
 
-  Local<Value> argv[] = {
-    Integer::New(env->isolate(), status),
-    Null(env->isolate())
-  };
+      char ip[INET6_ADDRSTRLEN];
+      if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip)))
+        continue;
 
-  uint64_t n = 0;
-  const bool verbatim = req_wrap->verbatim();
+      addresses.push_back(DnsCache::Address { p->ai_family, ip });
+    }
 
-  if (status == 0) {
-    Local<Array> results = Array::New(env->isolate());
+    // No responses were found to return
+    if (addresses.empty())
+      status = UV_EAI_NODATA;
+  }
 
-    auto add = [&] (bool want_ipv4, bool want_ipv6) {
-      for (auto p = res; p != nullptr; p = p->ai_next) {
-        CHECK_EQ(p->ai_socktype, SOCK_STREAM);
-
-        const char* addr;
-        if (want_ipv4 && p->ai_family == AF_INET) {
-          addr = reinterpret_cast<char*>(
-              &(reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr));
-        } else if (want_ipv6 && p->ai_family == AF_INET6) {
-          addr = reinterpret_cast<char*>(
-              &(reinterpret_cast<struct sockaddr_in6*>(p->ai_addr)->sin6_addr));
-        } else {
-          continue;
-        }
+  uv_freeaddrinfo(res);
 
-        char ip[INET6_ADDRSTRLEN];
-        if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip)))
-          continue;
+  FinishLookup(std::move(req_wrap), status, addresses);
+}
 
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(env->context(), n, s).Check();
-        n++;
-      }
-    };
+// Maps c-ares errors to the getaddrinfo() errors that dns.lookup() reports.
+int AresStatusToLookupStatus(int status) {
+  switch (status) {
+    case ARES_SUCCESS:
+      return 0;
+    case ARES_ENODATA:
+      return UV_EAI_NODATA;
+    case ARES_ENOTFOUND:
+    case ARES_EBADNAME:
+      return UV_EAI_NONAME;
+    case ARES_ENOMEM:
+      return UV_EAI_MEMORY;
+    case ARES_ECANCELLED:
+    case ARES_EDESTRUCTION:
+      return UV_EAI_CANCELED;
+    case ARES_ESERVFAIL:
+    case ARES_ETIMEOUT:
+    case ARES_ECONNREFUSED:
+    case ARES_EREFUSED:
+      return UV_EAI_AGAIN;
+    default:
+      return UV_EAI_FAIL;
+  }
+}
 
-    add(true, verbatim);
-    if (verbatim == false)
-      add(false, true);
+// Resolves a host name through c-ares on the event loop rather than through
+// getaddrinfo() on the threadpool. ares_gethostbyname() consults the hosts
+// file and DNS in the order configured by nsswitch.conf or host.conf, but
+// only returns addresses of a single family, so lookups for both families
+// issue one query per family.
+class AresLookup {
+ public:
+  static int Start(ChannelWrap* channel,
+                   GetAddrInfoReqWrap* req_wrap,
+                   const char* hostname,
+                   int family) {
+    AresLookup* lookup = new AresLookup(channel, req_wrap);
+    // IPv6 addresses come first, as with getaddrinfo() on most systems.
+    if (family == AF_UNSPEC || family == AF_INET6)
+      lookup->queries_[lookup->pending_++].family = AF_INET6;
+    if (family == AF_UNSPEC || family == AF_INET)
+      lookup->queries_[lookup->pending_++].family = AF_INET;
+
+    channel->EnsureServers();
+    // Queries may finish synchronously, e.g. when the name is found in the
+    // hosts file, so count them all before starting the first one.
+    const int count = lookup->pending_;
+    channel->ModifyActivityQueryCount(count);
+    for (int i = 0; i < count; i++) {
+      Query* query = &lookup->queries_[i];
+      query->lookup = lookup;
+      ares_gethostbyname(channel->cares_channel(), hostname, query->family,
+                         Callback, query);
+    }
+    return 0;
+  }
 
-    // No responses were found to return
-    if (n == 0) {
-      argv[0] = Integer::New(env->isolate(), UV_EAI_NODATA);
+ private:
+  struct Query {
+    AresLookup* lookup;
+    int family;
+    int status;
+    DnsCache::AddressList addresses;
+  };
+
+  AresLookup(ChannelWrap* channel, GetAddrInfoReqWrap* req_wrap)
+      : channel_(channel), req_wrap_(req_wrap) {}
+
+  static void Callback(void* arg, int status, int timeouts,
+                       struct hostent* host) {
+    Query* query = static_cast<Query*>(arg);
+    AresLookup* lookup = query->lookup;
+    query->status = status;
+    if (status == ARES_SUCCESS) {
+      for (char** addr = host->h_addr_list; *addr != nullptr; addr++) {
+        char ip[INET6_ADDRSTRLEN];
+        if (uv_inet_ntop(host->h_addrtype, *addr, ip, sizeof(ip)) == 0)
+          query->addresses.push_back(
+              DnsCache::Address { host->h_addrtype, ip });
+      }
     }
 
-    argv[1] = results;
-  }
+    lookup->channel_->set_query_last_ok(status != ARES_ECONNREFUSED);
+    lookup->channel_->ModifyActivityQueryCount(-1);
+    if (--lookup->pending_ > 0)
+      return;
 
-  uv_freeaddrinfo(res);
+    // The callback may run synchronously from within ares_gethostbyname(),
+    // or while the channel is being destroyed, so do not call into JS here.
+    lookup->req_wrap_->env()->SetImmediate([](Environment* env, void* data) {
+      std::unique_ptr<AresLookup> lookup { static_cast<AresLookup*>(data) };
+      lookup->Finish();
+    }, lookup, lookup->req_wrap_->object());
+  }
+
+  void Finish() {
+    DnsCache::AddressList addresses;
+    int status = ARES_ENODATA;
+    for (Query& query : queries_) {
+      if (query.family == AF_UNSPEC)
+        continue;
+      addresses.insert(addresses.end(),
+                       query.addresses.begin(), query.addresses.end());
+      // Report the most specific error if none of the queries succeeded.
+      if (status == ARES_ENODATA || query.status == ARES_ENOTFOUND)
+        status = query.status;
+    }
+    if (!addresses.empty())
+      status = ARES_SUCCESS;
+    else if (status == ARES_SUCCESS)
+      status = ARES_ENODATA;
 
-  TRACE_EVENT_NESTABLE_ASYNC_END2(
-      TRACING_CATEGORY_NODE2(dns, native), "lookup", req_wrap.get(),
-      "count", n, "verbatim", verbatim);
+    FinishLookup(std::unique_ptr<GetAddrInfoReqWrap>(req_wrap_),
+                 AresStatusToLookupStatus(status),
+                 addresses);
+  }
 
-  // Make the callback into JavaScript
-  req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
-}
+  ChannelWrap* channel_;
+  GetAddrInfoReqWrap* req_wrap_;
+  int pending_ = 0;
+  Query queries_[2] = { { nullptr, AF_UNSPEC }, { nullptr, AF_UNSPEC } };
+};
 
 
 void AfterGetNameInfo(uv_getnameinfo_t* req,
@@ -1934,7 +2139,57 @@ void CanonicalizeIP(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(val);
 }
 
-void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
+// Starts resolving `hostname`, either through getaddrinfo() or, if `channel`
+// is set, through c-ares.
+int DispatchLookup(GetAddrInfoReqWrap* req_wrap,
+                   ChannelWrap* channel,
+                   const char* hostname,
+                   const struct addrinfo& hints) {
+  if (channel == nullptr) {
+    return req_wrap->Dispatch(uv_getaddrinfo,
+                              AfterGetAddrInfo,
+                              hostname,
+                              nullptr,
+                              &hints);
+  }
+
+  // Make sure the channel stays alive while the lookup is in progress.
+  Environment* env = req_wrap->env();
+  req_wrap->object()->Set(env->context(),
+                          env->channel_string(),
+                          channel->object()).Check();
+  return AresLookup::Start(channel, req_wrap, hostname, hints.ai_family);
+}
+
+// Looks up `hostname` in the background and stores the result in the DNS
+// cache, without calling into JS.
+void RefreshCachedLookup(Environment* env,
+                         ChannelWrap* channel,
+                         const std::string& key,
+                         const char* hostname,
+                         const struct addrinfo& hints) {
+  Local<Object> req_wrap_obj;
+  int err = UV_ENOMEM;
+  if (env->getaddrinfo_req_wrap_template()
+          ->NewInstance(env->context())
+          .ToLocal(&req_wrap_obj)) {
+    auto req_wrap =
+        std::make_unique<GetAddrInfoReqWrap>(env, req_wrap_obj, false);
+    req_wrap->set_cache_key(key);
+    req_wrap->set_refresh_only();
+    err = DispatchLookup(req_wrap.get(), channel, hostname, hints);
+    if (err == 0) {
+      env->pending_dns_lookups.emplace(key, req_wrap.get());
+      USE(req_wrap.release());
+      return;
+    }
+  }
+  // Allow the next lookup to try again.
+  DnsCache::GetInstance()->Store(key, DnsCacheNow(), err, {});
+}
+
+// Implements dns.lookup(). `channel` selects c-ares instead of getaddrinfo().
+void Lookup(const FunctionCallbackInfo<Value>& args, ChannelWrap* channel) {
   Environment* env = Environment::GetCurrent(args);
 
   CHECK(args[0]->IsObject());
@@ -1981,19 +2236,57 @@ void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
       "family",
       family == AF_INET ? "ipv4" : family == AF_INET6 ? "ipv6" : "unspec");
 
-  int err = req_wrap->Dispatch(uv_getaddrinfo,
-                               AfterGetAddrInfo,
-                               *hostname,
-                               nullptr,
-                               &hints);
-  if (err == 0)
+  DnsCache* cache = DnsCache::GetInstance();
+  if (cache->enabled()) {
+    std::string key = DnsCache::MakeKey(*hostname, family, flags);
+    int status;
+    DnsCache::AddressList addresses;
+    switch (cache->Lookup(key, DnsCacheNow(), &status, &addresses)) {
+      case DnsCache::Result::kStale:
+        RefreshCachedLookup(env, channel, key, *hostname, hints);
+        // Fall through.
+      case DnsCache::Result::kHit:
+        req_wrap->CompleteFromCache(status, std::move(addresses));
+        USE(req_wrap.release());
+        args.GetReturnValue().Set(0);
+        return;
+      case DnsCache::Result::kMiss:
+        break;
+    }
+
+    auto pending = env->pending_dns_lookups.find(key);
+    if (pending != env->pending_dns_lookups.end()) {
+      cache->RecordCoalesced();
+      pending->second->AddFollower(std::move(req_wrap));
+      args.GetReturnValue().Set(0);
+      return;
+    }
+    req_wrap->set_cache_key(key);
+  }
+
+  int err = DispatchLookup(req_wrap.get(), channel, *hostname, hints);
+  if (err == 0) {
+    if (!req_wrap->cache_key().empty())
+      env->pending_dns_lookups[req_wrap->cache_key()] = req_wrap.get();
     // Release ownership of the pointer allowing the ownership to be transferred
     USE(req_wrap.release());
+  }
 
   args.GetReturnValue().Set(err);
 }
 
 
+void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
+  Lookup(args, nullptr);
+}
+
+void AresLookupHost(const FunctionCallbackInfo<Value>& args) {
+  ChannelWrap* channel;
+  ASSIGN_OR_RETURN_UNWRAP(&channel, args.Holder());
+  Lookup(args, channel);
+}
+
+
 void GetNameInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2154,6 +2447,40 @@ void Cancel(const FunctionCallbackInfo<Value>& args) {
   ares_cancel(channel->cares_channel());
 }
 
+void SetLookupCacheOptions(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsBoolean());
+  for (int i = 1; i < 5; i++)
+    CHECK(args[i]->IsUint32());
+
+  DnsCache::Options options;
+  options.enabled = args[0]->IsTrue();
+  options.ttl = args[1].As<Uint32>()->Value();
+  options.negative_ttl = args[2].As<Uint32>()->Value();
+  options.stale_ttl = args[3].As<Uint32>()->Value();
+  options.max_entries = args[4].As<Uint32>()->Value();
+  DnsCache::GetInstance()->Configure(options);
+}
+
+void GetLookupCacheStats(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), 6);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  const DnsCache::Stats stats = DnsCache::GetInstance()->stats();
+  fields[0] = static_cast<double>(stats.hits);
+  fields[1] = static_cast<double>(stats.stale_hits);
+  fields[2] = static_cast<double>(stats.misses);
+  fields[3] = static_cast<double>(stats.coalesced);
+  fields[4] = static_cast<double>(stats.evictions);
+  fields[5] = static_cast<double>(stats.size);
+}
+
+void ClearLookupCache(const FunctionCallbackInfo<Value>& args) {
+  DnsCache::GetInstance()->Clear();
+}
+
 const char EMSG_ESETSRVPENDING[] = "There are pending queries.";
 void StrError(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -2177,6 +2504,11 @@ void Initialize(Local<Object> target,
 
   env->SetMethod(target, "strerror", StrError);
 
+  env->SetMethod(target, "setLookupCacheOptions", SetLookupCacheOptions);
+  env->SetMethodNoSideEffect(target, "getLookupCacheStats",
+                             GetLookupCacheStats);
+  env->SetMethod(target, "clearLookupCache", ClearLookupCache);
+
   target->Set(env->context(), FIXED_ONE_BYTE_STRING(env->isolate(), "AF_INET"),
               Integer::New(env->isolate(), AF_INET)).Check();
   target->Set(env->context(), FIXED_ONE_BYTE_STRING(env->isolate(), "AF_INET6"),
@@ -2200,6 +2532,7 @@ void Initialize(Local<Object> target,
   target->Set(env->context(),
               addrInfoWrapString,
               aiw->GetFunction(context).ToLocalChecked()).Check();
+  env->set_getaddrinfo_req_wrap_template(aiw->InstanceTemplate());
 
   Local<FunctionTemplate> niw =
       BaseObject::MakeLazilyInitializedJSTemplate(env);
@@ -2238,6 +2571,7 @@ void Initialize(Local<Object> target,
   env->SetProtoMethod(channel_wrap, "queryNaptr", Query<QueryNaptrWrap>);
   env->SetProtoMethod(channel_wrap, "querySoa", Query<QuerySoaWrap>);
   env->SetProtoMethod(channel_wrap, "getHostByAddr", Query<GetHostByAddrWrap>);
+  env->SetProtoMethod(channel_wrap, "lookup", AresLookupHost);
 
   env->SetProtoMethodNoSideEffect(channel_wrap, "getServers", GetServers);
   env->SetProtoMethod(channel_wrap, "setServers", SetServers);
@@ -96,6 +96,7 @@ void ConnectionWrap<WrapType, UVType>::AfterConnect(uv_connect_t* req,
   if (status) {
     readable = writable = false;
   } else {
+    wrap->UpdateLastActivity();
     readable = uv_is_readable(req->handle) != 0;
     writable = uv_is_writable(req->handle) != 0;
   }
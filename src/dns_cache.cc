@@ -0,0 +1,137 @@
+#include "dns_cache.h"
+#include "uv.h"
+
+#include <algorithm>  // std::min()
+
+namespace node {
+
+DnsCache* DnsCache::GetInstance() {
+  static DnsCache cache;
+  return &cache;
+}
+
+std::string DnsCache::MakeKey(const std::string& hostname,
+                              int family,
+                              int flags) {
+  return std::to_string(family) + ':' + std::to_string(flags) + ':' +
+         hostname;
+}
+
+bool DnsCache::IsCacheable(int status) {
+  return status == 0 || status == UV_EAI_NONAME || status == UV_EAI_NODATA;
+}
+
+DnsCache::Result DnsCache::Lookup(const std::string& key,
+                                  uint64_t now,
+                                  int* status,
+                                  AddressList* addresses) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    stats_.misses++;
+    return Result::kMiss;
+  }
+
+  Entry& entry = *it->second;
+  if (now >= entry.stale_until) {
+    entries_.erase(it->second);
+    index_.erase(it);
+    stats_.misses++;
+    return Result::kMiss;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *status = entry.status;
+  *addresses = entry.addresses;
+  if (now < entry.expires_at) {
+    stats_.hits++;
+    return Result::kHit;
+  }
+
+  stats_.stale_hits++;
+  if (entry.refreshing)
+    return Result::kHit;
+  entry.refreshing = true;
+  return Result::kStale;
+}
+
+void DnsCache::Store(const std::string& key,
+                     uint64_t now,
+                     int status,
+                     const AddressList& addresses,
+                     uint64_t record_ttl) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = index_.find(key);
+
+  uint64_t ttl = status == 0 ? options_.ttl : options_.negative_ttl;
+  ttl = std::min(ttl, record_ttl);
+  if (!enabled_ || !IsCacheable(status) || ttl == 0 ||
+      (status == 0 && addresses.empty())) {
+    if (it != index_.end())
+      it->second->refreshing = false;
+    return;
+  }
+
+  if (it == index_.end()) {
+    entries_.push_front(Entry { key });
+    it = index_.emplace(key, entries_.begin()).first;
+  } else {
+    entries_.splice(entries_.begin(), entries_, it->second);
+  }
+
+  Entry& entry = *it->second;
+  entry.status = status;
+  entry.addresses = addresses;
+  entry.expires_at = now + ttl;
+  // Negative results are not served once they have expired.
+  entry.stale_until = entry.expires_at + (status == 0 ? options_.stale_ttl : 0);
+  entry.refreshing = false;
+
+  EvictLocked(options_.max_entries);
+}
+
+void DnsCache::EvictLocked(size_t max_entries) {
+  while (entries_.size() > max_entries) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+    stats_.evictions++;
+  }
+}
+
+void DnsCache::RecordCoalesced() {
+  Mutex::ScopedLock lock(mutex_);
+  stats_.coalesced++;
+}
+
+void DnsCache::Configure(const Options& options) {
+  Mutex::ScopedLock lock(mutex_);
+  options_ = options;
+  enabled_ = options.enabled;
+  if (!enabled_) {
+    entries_.clear();
+    index_.clear();
+  } else {
+    EvictLocked(options_.max_entries);
+  }
+}
+
+DnsCache::Options DnsCache::options() const {
+  Mutex::ScopedLock lock(mutex_);
+  return options_;
+}
+
+DnsCache::Stats DnsCache::stats() const {
+  Mutex::ScopedLock lock(mutex_);
+  Stats stats = stats_;
+  stats.size = entries_.size();
+  return stats;
+}
+
+void DnsCache::Clear() {
+  Mutex::ScopedLock lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  stats_ = Stats();
+}
+
+}  // namespace node
@@ -0,0 +1,129 @@
+#ifndef SRC_DNS_CACHE_H_
+#define SRC_DNS_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "node_mutex.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+
+// A cache for the results of dns.lookup(). There is a single instance per
+// process, which is shared by the main thread and all Worker threads.
+//
+// Entries expire after their TTL. Expired entries may still be served for
+// a while ("stale-while-revalidate"); the first lookup that hits such an
+// entry is told to refresh it, while later lookups keep getting the stale
+// result until the refresh has finished. Lookups that failed because the
+// name does not exist are cached as well, with a separate, usually shorter
+// TTL. All times are in milliseconds.
+class DnsCache {
+ public:
+  struct Address {
+    int family;  // AF_INET or AF_INET6
+    std::string ip;
+  };
+  typedef std::vector<Address> AddressList;
+
+  struct Options {
+    bool enabled = false;
+    uint64_t ttl = 10000;
+    uint64_t negative_ttl = 1000;
+    uint64_t stale_ttl = 5000;
+    size_t max_entries = 1000;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t stale_hits = 0;
+    uint64_t misses = 0;
+    uint64_t coalesced = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+  };
+
+  enum class Result {
+    kMiss,
+    kHit,
+    // The entry has expired and should be refreshed by the caller.
+    kStale
+  };
+
+  static constexpr uint64_t kNoRecordTtl =
+      std::numeric_limits<uint64_t>::max();
+
+  DnsCache() = default;
+  DnsCache(const DnsCache&) = delete;
+  DnsCache& operator=(const DnsCache&) = delete;
+
+  static DnsCache* GetInstance();
+
+  // Returns the key under which the result of a lookup with the given
+  // parameters is stored.
+  static std::string MakeKey(const std::string& hostname,
+                             int family,
+                             int flags);
+
+  // Whether a lookup that finished with `status` can be cached.
+  static bool IsCacheable(int status);
+
+  inline bool enabled() const { return enabled_; }
+
+  // On kHit and kStale, `status` and `addresses` are set to the cached
+  // result of the lookup.
+  Result Lookup(const std::string& key,
+                uint64_t now,
+                int* status,
+                AddressList* addresses);
+
+  // Stores the result of a lookup. `record_ttl` can be used by resolvers
+  // that know the TTL of the DNS records; the configured TTL then acts as
+  // an upper bound. Results that are not cacheable only end a pending
+  // refresh, so that the stale entry can be refreshed again later.
+  void Store(const std::string& key,
+             uint64_t now,
+             int status,
+             const AddressList& addresses,
+             uint64_t record_ttl = kNoRecordTtl);
+
+  void RecordCoalesced();
+
+  void Configure(const Options& options);
+  Options options() const;
+  Stats stats() const;
+  void Clear();
+
+ private:
+  struct Entry {
+    std::string key;
+    int status;
+    AddressList addresses;
+    uint64_t expires_at;
+    uint64_t stale_until;
+    bool refreshing;
+  };
+  typedef std::list<Entry> EntryList;
+
+  void EvictLocked(size_t max_entries);
+
+  mutable Mutex mutex_;
+  std::atomic<bool> enabled_ { false };
+  Options options_;
+  Stats stats_;
+  // Most recently used entries come first.
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_DNS_CACHE_H_
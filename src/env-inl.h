@@ -586,6 +586,14 @@ inline void Environment::set_http_parser_buffer_in_use(bool in_use) {
   http_parser_buffer_in_use_ = in_use;
 }
 
+inline ReadSlabAllocator* Environment::read_slab_allocator() const {
+  return read_slab_allocator_.get();
+}
+
+inline TimerWheel* Environment::timer_wheel() const {
+  return timer_wheel_.get();
+}
+
 inline http2::Http2State* Environment::http2_state() const {
   return http2_state_.get();
 }
@@ -12,6 +12,8 @@
 #include "node_process.h"
 #include "node_v8_platform-inl.h"
 #include "node_worker.h"
+#include "slab_allocator.h"
+#include "timer_wheel.h"
 #include "tracing/agent.h"
 #include "tracing/traced_value.h"
 #include "util-inl.h"
@@ -387,6 +389,11 @@ Environment::Environment(IsolateData* isolate_data,
     async_hooks_.no_force_checks();
   }
 
+  if (options_->stream_read_slab_size > 0) {
+    read_slab_allocator_ = std::make_unique<ReadSlabAllocator>(
+        this, options_->stream_read_slab_size);
+  }
+
   // TODO(joyeecheung): deserialize when the snapshot covers the environment
   // properties.
   CreateProperties();
@@ -456,6 +463,8 @@ void Environment::InitializeLibuv(bool start_profiler_idle_notifier) {
   CHECK_EQ(0, uv_timer_init(event_loop(), timer_handle()));
   uv_unref(reinterpret_cast<uv_handle_t*>(timer_handle()));
 
+  timer_wheel_ = std::make_unique<TimerWheel>(event_loop());
+
   uv_check_init(event_loop(), immediate_check_handle());
   uv_unref(reinterpret_cast<uv_handle_t*>(immediate_check_handle()));
 
@@ -538,6 +547,10 @@ void Environment::RegisterHandleCleanups() {
       reinterpret_cast<uv_handle_t*>(&idle_check_handle_),
       close_and_finish,
       nullptr);
+  RegisterHandleCleanup(
+      timer_wheel_->handle(),
+      close_and_finish,
+      nullptr);
 }
 
 void Environment::CleanupHandles() {
@@ -1021,6 +1034,7 @@ void Environment::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("async_hooks", async_hooks_);
   tracker->TrackField("immediate_info", immediate_info_);
   tracker->TrackField("tick_info", tick_info_);
+  tracker->TrackField("read_slab_allocator", read_slab_allocator_);
 
 #define V(PropertyName, TypeName)                                              \
   tracker->TrackField(#PropertyName, PropertyName());
@@ -85,6 +85,13 @@ namespace worker {
 class Worker;
 }
 
+class ReadSlabAllocator;
+class TimerWheel;
+
+namespace cares_wrap {
+class GetAddrInfoReqWrap;
+}
+
 namespace loader {
 class ModuleWrap;
 
@@ -122,7 +129,6 @@ constexpr size_t kFsStatsBufferLength = kFsStatsFieldsNumber * 2;
 // for the sake of convenience.  Strings should be ASCII-only and have a
 // "node:" prefix to avoid name clashes with third-party code.
 #define PER_ISOLATE_PRIVATE_SYMBOL_PROPERTIES(V)                              \
-  V(alpn_buffer_private_symbol, "node:alpnBuffer")                            \
   V(arrow_message_private_symbol, "node:arrowMessage")                        \
   V(contextify_context_private_symbol, "node:contextify:context")             \
   V(contextify_global_private_symbol, "node:contextify:global")               \
@@ -267,6 +273,7 @@ constexpr size_t kFsStatsBufferLength = kFsStatsFieldsNumber * 2;
   V(onreadstop_string, "onreadstop")                                           \
   V(onshutdown_string, "onshutdown")                                           \
   V(onsignal_string, "onsignal")                                               \
+  V(ontimeout_string, "ontimeout")                                             \
   V(onunpipe_string, "onunpipe")                                               \
   V(onwrite_string, "onwrite")                                                 \
   V(openssl_error_stack, "opensslErrorStack")                                  \
@@ -352,10 +359,12 @@ constexpr size_t kFsStatsBufferLength = kFsStatsFieldsNumber * 2;
   V(as_callback_data_template, v8::FunctionTemplate)                           \
   V(async_wrap_ctor_template, v8::FunctionTemplate)                            \
   V(async_wrap_object_ctor_template, v8::FunctionTemplate)                     \
+  V(dir_instance_template, v8::ObjectTemplate)                                 \
   V(fd_constructor_template, v8::ObjectTemplate)                               \
   V(fdclose_constructor_template, v8::ObjectTemplate)                          \
   V(filehandlereadwrap_template, v8::ObjectTemplate)                           \
   V(fsreqpromise_constructor_template, v8::ObjectTemplate)                     \
+  V(getaddrinfo_req_wrap_template, v8::ObjectTemplate)                         \
   V(handle_wrap_ctor_template, v8::FunctionTemplate)                           \
   V(http2settings_constructor_template, v8::ObjectTemplate)                    \
   V(http2stream_constructor_template, v8::ObjectTemplate)                      \
@@ -951,6 +960,10 @@ class Environment : public MemoryRetainer {
   std::unordered_map<uint32_t, loader::ModuleWrap*> id_to_module_map;
   std::unordered_map<uint32_t, contextify::ContextifyScript*>
       id_to_script_map;
+  // dns.lookup() requests that are in progress and use the DNS cache, by
+  // cache key. Later lookups of the same name wait for these to finish.
+  std::unordered_map<std::string, cares_wrap::GetAddrInfoReqWrap*>
+      pending_dns_lookups;
   std::unordered_set<CompileFnEntry*> compile_fn_entries;
   std::unordered_map<uint32_t, v8::Global<v8::Function>> id_to_function_map;
 
@@ -977,6 +990,12 @@ class Environment : public MemoryRetainer {
   inline http2::Http2State* http2_state() const;
   inline void set_http2_state(std::unique_ptr<http2::Http2State> state);
 
+  // Returns nullptr unless --stream-read-slab-size was passed.
+  inline ReadSlabAllocator* read_slab_allocator() const;
+
+  // Shared by all timers that do not need millisecond precision.
+  inline TimerWheel* timer_wheel() const;
+
   inline bool debug_enabled(DebugCategory category) const;
   inline void set_debug_enabled(DebugCategory category, bool enabled);
   void set_debug_categories(const std::string& cats, bool enabled);
@@ -1295,6 +1314,8 @@ class Environment : public MemoryRetainer {
   char* http_parser_buffer_ = nullptr;
   bool http_parser_buffer_in_use_ = false;
   std::unique_ptr<http2::Http2State> http2_state_;
+  std::unique_ptr<ReadSlabAllocator> read_slab_allocator_;
+  std::unique_ptr<TimerWheel> timer_wheel_;
 
   bool debug_enabled_[static_cast<int>(DebugCategory::CATEGORY_COUNT)] = {0};
 
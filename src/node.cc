@@ -26,6 +26,7 @@
 #include "debug_utils.h"
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
+#include "node_affinity.h"
 #include "node_binding.h"
 #include "node_errors.h"
 #include "node_internals.h"
@@ -1038,6 +1039,33 @@ void StartupDataHandler::Load(const char* blob_file,
 
 #endif  // V8_USE_EXTERNAL_STARTUP_DATA
 
+// Applies --main-thread-cpus and --threadpool-cpus. The threadpool is started
+// (and pinned, if requested) first, so that its threads do not inherit the
+// main thread's affinity. Threads that are started later, such as the
+// platform workers, do inherit it. The options have already been validated
+// at this point.
+static void PinThreadsToCpus() {
+  const std::string& main_cpus = per_process::cli_options->main_thread_cpus;
+  const std::string& pool_cpus = per_process::cli_options->threadpool_cpus;
+  affinity::CpuSet cpus;
+  std::string unused;
+  if (!pool_cpus.empty() && affinity::ParseCpuSet(pool_cpus, &cpus, &unused)) {
+    int err = affinity::PinThreadpool(cpus);
+    if (err != 0) {
+      fprintf(stderr, "Warning: could not apply --threadpool-cpus: %s\n",
+              uv_strerror(err));
+    }
+  }
+  if (!main_cpus.empty() && affinity::ParseCpuSet(main_cpus, &cpus, &unused)) {
+    if (pool_cpus.empty())
+      affinity::StartThreadpool();
+    int err = affinity::PinCurrentThread("main", cpus);
+    if (err != 0) {
+      fprintf(stderr, "Warning: could not apply --main-thread-cpus: %s\n",
+              uv_strerror(err));
+    }
+  }
+}
 
 InitializationResult InitializeOncePerProcess(int argc, char** argv) {
   atexit(ResetStdio);
@@ -1115,6 +1143,7 @@ InitializationResult InitializeOncePerProcess(int argc, char** argv) {
   if (icu_data)
     udata_setCommonData((uint8_t*)icu_data, &err);
 
+  PinThreadsToCpus();
   InitializeV8Platform(per_process::cli_options->v8_thread_pool_size);
   V8::Initialize();
   //performance::performance_v8_start = PERFORMANCE_NOW();
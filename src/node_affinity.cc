@@ -0,0 +1,289 @@
+#include "node_affinity.h"
+#include "debug_utils.h"
+#include "node_mutex.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace node {
+namespace affinity {
+
+namespace {
+
+struct PinnedThread {
+  std::string name;
+  uv_thread_t thread;
+  CpuSet cpus;
+};
+
+Mutex pinned_threads_mutex;
+std::vector<PinnedThread> pinned_threads;
+
+// Parses a comma-separated list of non-negative integers and ranges.
+bool ParseList(const std::string& list,
+               std::vector<int>* out,
+               std::string* error) {
+  std::istringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    const char* start = item.c_str();
+    char* end;
+    long first = strtol(start, &end, 10);  // NOLINT(runtime/int)
+    long last = first;  // NOLINT(runtime/int)
+    bool valid = end != start && first >= 0;
+    if (valid && *end == '-') {
+      start = end + 1;
+      last = strtol(start, &end, 10);
+      valid = end != start && last >= first;
+    }
+    if (!valid || *end != '\0' || last > INT16_MAX) {
+      *error = "invalid range '" + item + "'";
+      return false;
+    }
+    for (long i = first; i <= last; i++)  // NOLINT(runtime/int)
+      out->push_back(static_cast<int>(i));
+  }
+  if (out->empty()) {
+    *error = "empty list";
+    return false;
+  }
+  return true;
+}
+
+void Normalize(std::vector<int>* list) {
+  std::sort(list->begin(), list->end());
+  list->erase(std::unique(list->begin(), list->end()), list->end());
+}
+
+#ifdef __linux__
+const char kNumaNodePath[] = "/sys/devices/system/node";
+
+// Returns the CPUs of a NUMA node, or false if the node does not exist.
+bool GetNumaNodeCpus(int node, CpuSet* cpus) {
+  std::ifstream file(std::string(kNumaNodePath) + "/node" +
+                     std::to_string(node) + "/cpulist");
+  std::string list;
+  if (!std::getline(file, list))
+    return false;
+  std::string unused;
+  // Nodes without CPUs have an empty list.
+  return list.empty() || ParseList(list, cpus, &unused);
+}
+
+std::vector<int> GetNumaNodeIds() {
+  std::vector<int> nodes;
+  DIR* dir = opendir(kNumaNodePath);
+  if (dir == nullptr)
+    return nodes;
+  while (dirent* entry = readdir(dir)) {
+    const char* name = entry->d_name;
+    if (strncmp(name, "node", 4) != 0 || name[4] < '0' || name[4] > '9')
+      continue;
+    nodes.push_back(atoi(name + 4));
+  }
+  closedir(dir);
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+#endif  // __linux__
+
+}  // anonymous namespace
+
+unsigned int ThreadpoolSize() {
+  // Mirrors init_threads() in deps/uv/src/threadpool.c.
+  unsigned int size = 4;
+  const char* val = getenv("UV_THREADPOOL_SIZE");
+  if (val != nullptr)
+    size = atoi(val);
+  if (size == 0)
+    size = 1;
+  if (size > 1024)
+    size = 1024;
+  return size;
+}
+
+bool IsSupported() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool ParseCpuSet(const std::string& spec, CpuSet* cpus, std::string* error) {
+  static const char kNodePrefix[] = "node:";
+  const size_t prefix_length = sizeof(kNodePrefix) - 1;
+  cpus->clear();
+
+  if (spec.compare(0, prefix_length, kNodePrefix) != 0) {
+    if (!ParseList(spec, cpus, error))
+      return false;
+    Normalize(cpus);
+    return true;
+  }
+
+  std::vector<int> nodes;
+  if (!ParseList(spec.substr(prefix_length), &nodes, error))
+    return false;
+#ifdef __linux__
+  for (int node : nodes) {
+    if (!GetNumaNodeCpus(node, cpus)) {
+      *error = "unknown NUMA node " + std::to_string(node);
+      return false;
+    }
+  }
+  if (cpus->empty()) {
+    *error = "NUMA nodes without CPUs";
+    return false;
+  }
+  Normalize(cpus);
+  return true;
+#else
+  *error = "NUMA nodes are not supported on this platform";
+  return false;
+#endif
+}
+
+std::string FormatCpuSet(const CpuSet& cpus) {
+  std::string result;
+  for (size_t i = 0; i < cpus.size(); i++) {
+    size_t last = i;
+    while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1)
+      last++;
+    if (!result.empty())
+      result += ',';
+    result += std::to_string(cpus[i]);
+    if (last > i)
+      result += '-' + std::to_string(cpus[last]);
+    i = last;
+  }
+  return result;
+}
+
+std::vector<int> GetNumaNodes(const CpuSet& cpus) {
+  std::vector<int> result;
+#ifdef __linux__
+  for (int node : GetNumaNodeIds()) {
+    CpuSet node_cpus;
+    if (!GetNumaNodeCpus(node, &node_cpus))
+      continue;
+    for (int cpu : node_cpus) {
+      if (std::binary_search(cpus.begin(), cpus.end(), cpu)) {
+        result.push_back(node);
+        break;
+      }
+    }
+  }
+#endif
+  return result;
+}
+
+int PinCurrentThread(const std::string& name, const CpuSet& cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= CPU_SETSIZE)
+      return UV_EINVAL;
+    CPU_SET(cpu, &set);
+  }
+  int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (err != 0)
+    return -err;
+
+  uv_thread_t self = uv_thread_self();
+  Mutex::ScopedLock lock(pinned_threads_mutex);
+  for (PinnedThread& thread : pinned_threads) {
+    if (uv_thread_equal(&thread.thread, &self)) {
+      thread.name = name;
+      thread.cpus = cpus;
+      return 0;
+    }
+  }
+  pinned_threads.push_back(PinnedThread { name, self, cpus });
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+void ForgetCurrentThread() {
+  uv_thread_t self = uv_thread_self();
+  Mutex::ScopedLock lock(pinned_threads_mutex);
+  auto it = std::find_if(pinned_threads.begin(), pinned_threads.end(),
+                         [&](const PinnedThread& thread) {
+    return uv_thread_equal(&thread.thread, &self);
+  });
+  if (it != pinned_threads.end())
+    pinned_threads.erase(it);
+}
+
+int PinThreadpool(const CpuSet& cpus) {
+  if (!IsSupported())
+    return UV_ENOTSUP;
+
+  // There is no way to get hold of the threads of libuv's threadpool, so
+  // one task is queued for each of them. Every task waits for all others
+  // to have started, which means that each task runs on a different thread.
+  struct PinState {
+    const CpuSet* cpus;
+    uv_barrier_t barrier;
+    std::atomic<int> next_index { 0 };
+    std::atomic<int> error { 0 };
+  } state;
+  const unsigned int size = ThreadpoolSize();
+  state.cpus = &cpus;
+  CHECK_EQ(0, uv_barrier_init(&state.barrier, size));
+
+  uv_loop_t loop;
+  CHECK_EQ(0, uv_loop_init(&loop));
+  std::vector<uv_work_t> reqs(size);
+  for (uv_work_t& req : reqs) {
+    req.data = &state;
+    CHECK_EQ(0, uv_queue_work(&loop, &req, [](uv_work_t* req) {
+      PinState* state = static_cast<PinState*>(req->data);
+      std::string name = "threadpool " + std::to_string(state->next_index++);
+      int err = PinCurrentThread(name, *state->cpus);
+      if (err != 0)
+        state->error = err;
+      uv_barrier_wait(&state->barrier);
+    }, nullptr));
+  }
+  uv_run(&loop, UV_RUN_DEFAULT);
+  CheckedUvLoopClose(&loop);
+  uv_barrier_destroy(&state.barrier);
+  return state.error;
+}
+
+void StartThreadpool() {
+  uv_loop_t loop;
+  CHECK_EQ(0, uv_loop_init(&loop));
+  uv_work_t req;
+  CHECK_EQ(0, uv_queue_work(&loop, &req, [](uv_work_t* req) {}, nullptr));
+  uv_run(&loop, UV_RUN_DEFAULT);
+  CheckedUvLoopClose(&loop);
+}
+
+std::vector<ThreadPlacement> GetThreadPlacements() {
+  std::vector<ThreadPlacement> result;
+  Mutex::ScopedLock lock(pinned_threads_mutex);
+  for (const PinnedThread& thread : pinned_threads)
+    result.push_back(ThreadPlacement { thread.name, thread.cpus });
+  return result;
+}
+
+}  // namespace affinity
+}  // namespace node
@@ -0,0 +1,62 @@
+#ifndef SRC_NODE_AFFINITY_H_
+#define SRC_NODE_AFFINITY_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <string>
+#include <vector>
+
+namespace node {
+namespace affinity {
+
+// A sorted list of CPU indices.
+typedef std::vector<int> CpuSet;
+
+// Whether threads can be pinned to CPUs on this platform.
+bool IsSupported();
+
+// Parses a CPU list like "0-3,8,10-11". If the list is prefixed with
+// "node:", it is a list of NUMA nodes instead, and the result contains all
+// CPUs that belong to those nodes. On failure, returns false and stores a
+// human-readable description of the problem in `error`.
+bool ParseCpuSet(const std::string& spec, CpuSet* cpus, std::string* error);
+
+// Formats `cpus` in the same format that ParseCpuSet() accepts.
+std::string FormatCpuSet(const CpuSet& cpus);
+
+// Returns the NUMA nodes that the CPUs in `cpus` belong to.
+std::vector<int> GetNumaNodes(const CpuSet& cpus);
+
+// Restricts the calling thread to `cpus`. On success, the thread is recorded
+// under `name`, so that its placement shows up in diagnostic reports.
+// Returns 0 or a libuv error code.
+int PinCurrentThread(const std::string& name, const CpuSet& cpus);
+
+// Removes the calling thread from the list of pinned threads. This needs to
+// be called by threads that have been pinned and exit before the process.
+void ForgetCurrentThread();
+
+// Returns the number of threads in libuv's threadpool.
+unsigned int ThreadpoolSize();
+
+// Pins each of the threads in libuv's threadpool to `cpus`. This blocks
+// until all threads of the pool have been pinned.
+int PinThreadpool(const CpuSet& cpus);
+
+// Makes libuv start its threadpool, which it otherwise does lazily once the
+// first task is queued. The threads inherit the calling thread's affinity.
+void StartThreadpool();
+
+struct ThreadPlacement {
+  std::string name;
+  CpuSet cpus;
+};
+
+std::vector<ThreadPlacement> GetThreadPlacements();
+
+}  // namespace affinity
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_AFFINITY_H_
@@ -24,6 +24,7 @@
 #include "node_crypto_bio.h"
 #include "node_crypto_clienthello-inl.h"
 #include "node_crypto_groups.h"
+#include "node_affinity.h"
 #include "node_errors.h"
 #include "node_mutex.h"
 #include "node_process.h"
@@ -38,6 +39,7 @@
 #include "util-inl.h"
 #include "v8.h"
 
+#include <openssl/async.h>
 #include <openssl/ec.h>
 #include <openssl/ecdh.h>
 #ifndef OPENSSL_NO_ENGINE
@@ -49,13 +51,19 @@
 #include <openssl/hmac.h>
 #include <openssl/rand.h>
 #include <openssl/pkcs12.h>
+#include <openssl/ocsp.h>
 
 #include <cerrno>
 #include <climits>  // INT_MAX
 #include <cstring>
+#include <ctime>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -70,6 +78,8 @@ namespace crypto {
 using node::THROW_ERR_TLS_INVALID_PROTOCOL_METHOD;
 
 using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferCreationMode;
 using v8::ArrayBufferView;
 using v8::Boolean;
 using v8::ConstructorBehavior;
@@ -80,11 +90,14 @@ using v8::Exception;
 using v8::External;
 using v8::False;
 using v8::Function;
+using v8::Float64Array;
 using v8::FunctionCallback;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Global;
 using v8::HandleScope;
 using v8::Int32;
+using v8::Int32Array;
 using v8::Integer;
 using v8::Isolate;
 using v8::Just;
@@ -94,6 +107,7 @@ using v8::MaybeLocal;
 using v8::NewStringType;
 using v8::Nothing;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::PropertyAttribute;
 using v8::ReadOnly;
@@ -101,6 +115,7 @@ using v8::SideEffectType;
 using v8::Signature;
 using v8::String;
 using v8::Uint32;
+using v8::Uint32Array;
 using v8::Undefined;
 using v8::Value;
 
@@ -135,6 +150,7 @@ static const char* const root_certs[] = {
 static const char system_cert_path[] = NODE_OPENSSL_SYSTEM_CERT_PATH;
 
 static X509_STORE* root_cert_store;
+static Mutex root_cert_store_mutex;
 
 static bool extra_root_certs_loaded = false;
 
@@ -495,6 +511,11 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
   env->SetProtoMethod(t, "setTicketKeys", SetTicketKeys);
   env->SetProtoMethod(t, "setFreeListLength", SetFreeListLength);
   env->SetProtoMethod(t, "enableTicketKeyCallback", EnableTicketKeyCallback);
+  env->SetProtoMethod(t, "setSessionCache", SetSessionCache);
+  env->SetProtoMethod(t, "enableAsyncPrivateKey", EnableAsyncPrivateKey);
+  env->SetProtoMethod(t, "setOCSPResponse", SetOCSPResponse);
+  env->SetProtoMethodNoSideEffect(t, "getSessionCacheStats",
+                                  GetSessionCacheStats);
   env->SetProtoMethodNoSideEffect(t, "getCertificate", GetCertificate<true>);
   env->SetProtoMethodNoSideEffect(t, "getIssuer", GetCertificate<false>);
 
@@ -528,6 +549,16 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
 }
 
 
+void SecureContext::MemoryInfo(MemoryTracker* tracker) const {
+  // The certificates may be shared with other SecureContexts, in which case
+  // they are a single node in the graph.
+  tracker->TrackField("cert_chain", cert_chain_.get());
+  for (const auto& certs : ca_certs_)
+    tracker->TrackField("ca_certs", certs.get());
+  tracker->TrackField("root_certs", root_certs_.get());
+}
+
+
 void SecureContext::New(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   new SecureContext(env, args.This());
@@ -693,6 +724,112 @@ static BIOPointer LoadBIO(Environment* env, Local<Value> v) {
 }
 
 
+X509Certificates::X509Certificates(std::vector<X509Pointer>&& certs)
+    : certs_(std::move(certs)) {
+  for (const X509Pointer& cert : certs_) {
+    int length = i2d_X509(cert.get(), nullptr);
+    if (length > 0)
+      size_ += length;
+  }
+}
+
+
+void X509Certificates::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("certs", size_, "X509");
+}
+
+
+std::shared_ptr<const X509Certificates> X509Certificates::FromPEM(
+    const char* data, size_t length, Format format) {
+  static Mutex cache_mutex;
+  // Keyed by the SHA-256 digest of the data and the format. Entries expire
+  // when the last SecureContext that uses them is freed.
+  static std::unordered_map<std::string,
+                            std::weak_ptr<const X509Certificates>> cache;
+  // Expired entries are removed when the cache grows to this size.
+  static size_t sweep_size = 64;
+
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_length;
+  CHECK_EQ(EVP_Digest(data, length, digest, &digest_length, EVP_sha256(),
+                      nullptr), 1);
+  std::string key(reinterpret_cast<const char*>(digest), digest_length);
+  key.push_back(static_cast<char>(format));
+
+  {
+    Mutex::ScopedLock lock(cache_mutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      if (std::shared_ptr<const X509Certificates> certs = it->second.lock())
+        return certs;
+    }
+  }
+
+  // Parse outside of the lock, other threads may load other certificates in
+  // the meantime.
+  ERR_clear_error();
+  BIOPointer bio(NodeBIO::NewFixed(data, length));
+  std::vector<X509Pointer> certs;
+  for (;;) {
+    X509* x509 = format == kTrustedCertificates || certs.empty() ?
+        PEM_read_bio_X509_AUX(bio.get(), nullptr, NoPasswordCallback, nullptr) :
+        PEM_read_bio_X509(bio.get(), nullptr, NoPasswordCallback, nullptr);
+    if (x509 == nullptr)
+      break;
+    certs.emplace_back(x509);
+  }
+
+  if (format == kCertificateChain) {
+    // When the loop ends, it's usually just EOF.
+    unsigned long err = ERR_peek_last_error();  // NOLINT(runtime/int)
+    if (certs.empty() ||
+        ERR_GET_LIB(err) != ERR_LIB_PEM ||
+        ERR_GET_REASON(err) != PEM_R_NO_START_LINE) {
+      return nullptr;
+    }
+  }
+  ERR_clear_error();
+
+  auto result = std::make_shared<const X509Certificates>(std::move(certs));
+
+  Mutex::ScopedLock lock(cache_mutex);
+  if (cache.size() >= sweep_size) {
+    for (auto it = cache.begin(); it != cache.end();) {
+      if (it->second.expired())
+        it = cache.erase(it);
+      else
+        ++it;
+    }
+    sweep_size = std::max<size_t>(64, 2 * cache.size());
+  }
+  cache[key] = result;
+  return result;
+}
+
+
+// Like LoadBIO(), but returns the parsed certificates. Returns nullptr, with
+// the error on the OpenSSL error queue if there is one, on failure.
+static std::shared_ptr<const X509Certificates> LoadCertificates(
+    Environment* env,
+    Local<Value> v,
+    X509Certificates::Format format) {
+  HandleScope scope(env->isolate());
+  ERR_clear_error();
+
+  if (v->IsString()) {
+    const node::Utf8Value s(env->isolate(), v);
+    return X509Certificates::FromPEM(*s, s.length(), format);
+  }
+
+  if (v->IsArrayBufferView()) {
+    ArrayBufferViewContents<char> buf(v.As<ArrayBufferView>());
+    return X509Certificates::FromPEM(buf.data(), buf.length(), format);
+  }
+
+  return nullptr;
+}
+
+
 void SecureContext::SetKey(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -821,55 +958,30 @@ int SSL_CTX_use_certificate_chain(SSL_CTX* ctx,
 }
 
 
-// Read a file that contains our certificate in "PEM" format,
-// possibly followed by a sequence of CA certificates that should be
-// sent to the peer in the Certificate message.
-//
-// Taken from OpenSSL - edited for style.
-int SSL_CTX_use_certificate_chain(SSL_CTX* ctx,
-                                  BIOPointer&& in,
-                                  X509Pointer* cert,
-                                  X509Pointer* issuer) {
-  // Just to ensure that `ERR_peek_last_error` below will return only errors
-  // that we are interested in
-  ERR_clear_error();
-
-  X509Pointer x(
-      PEM_read_bio_X509_AUX(in.get(), nullptr, NoPasswordCallback, nullptr));
-
-  if (!x)
-    return 0;
-
-  unsigned long err = 0;  // NOLINT(runtime/int)
+// Use a certificate that was parsed with kCertificateChain, i.e. followed by
+// a sequence of CA certificates that should be sent to the peer in the
+// Certificate message.
+static int SSL_CTX_use_certificate_chain(SSL_CTX* ctx,
+                                         const X509Certificates& certs,
+                                         X509Pointer* cert,
+                                         X509Pointer* issuer) {
+  CHECK(!certs.certs().empty());
 
   StackOfX509 extra_certs(sk_X509_new_null());
   if (!extra_certs)
     return 0;
 
-  while (X509Pointer extra {PEM_read_bio_X509(in.get(),
-                                    nullptr,
-                                    NoPasswordCallback,
-                                    nullptr)}) {
-    if (sk_X509_push(extra_certs.get(), extra.get())) {
-      extra.release();
-      continue;
-    }
-
-    return 0;
-  }
-
-  // When the while loop ends, it's usually just EOF.
-  err = ERR_peek_last_error();
-  if (ERR_GET_LIB(err) == ERR_LIB_PEM &&
-      ERR_GET_REASON(err) == PEM_R_NO_START_LINE) {
-    ERR_clear_error();
-  } else {
-    // some real error
-    return 0;
+  for (size_t i = 1; i < certs.certs().size(); i++) {
+    X509* extra = certs.certs()[i].get();
+    if (!sk_X509_push(extra_certs.get(), extra))
+      return 0;
+    X509_up_ref(extra);
   }
 
+  X509* x = certs.certs()[0].get();
+  X509_up_ref(x);
   return SSL_CTX_use_certificate_chain(ctx,
-                                       std::move(x),
+                                       X509Pointer(x),
                                        extra_certs.get(),
                                        cert,
                                        issuer);
@@ -886,15 +998,20 @@ void SecureContext::SetCert(const FunctionCallbackInfo<Value>& args) {
     return THROW_ERR_MISSING_ARGS(env, "Certificate argument is mandatory");
   }
 
-  BIOPointer bio(LoadBIO(env, args[0]));
-  if (!bio)
-    return;
-
   sc->cert_.reset();
   sc->issuer_.reset();
 
+  std::shared_ptr<const X509Certificates> certs =
+      LoadCertificates(env, args[0], X509Certificates::kCertificateChain);
+  if (!certs) {
+    unsigned long err = ERR_get_error();  // NOLINT(runtime/int)
+    if (!err)
+      return;
+    return ThrowCryptoError(env, err);
+  }
+
   int rv = SSL_CTX_use_certificate_chain(sc->ctx_.get(),
-                                         std::move(bio),
+                                         *certs,
                                          &sc->cert_,
                                          &sc->issuer_);
 
@@ -905,15 +1022,21 @@ void SecureContext::SetCert(const FunctionCallbackInfo<Value>& args) {
     }
     return ThrowCryptoError(env, err);
   }
+
+  sc->cert_chain_ = std::move(certs);
 }
 
 
-static X509_STORE* NewRootCertStore() {
-  static std::vector<X509*> root_certs_vector;
-  static Mutex root_certs_vector_mutex;
-  Mutex::ScopedLock lock(root_certs_vector_mutex);
+// The built-in root certificates are parsed once, and shared by all stores
+// that contain them.
+static std::shared_ptr<const X509Certificates> BuiltinRootCertificates() {
+  static Mutex mutex;
+  // Never freed, like root_cert_store.
+  static std::shared_ptr<const X509Certificates>* root_certificates;
+  Mutex::ScopedLock lock(mutex);
 
-  if (root_certs_vector.empty()) {
+  if (root_certificates == nullptr) {
+    std::vector<X509Pointer> certs;
     for (size_t i = 0; i < arraysize(root_certs); i++) {
       X509* x509 =
           PEM_read_bio_X509(NodeBIO::NewFixed(root_certs[i],
@@ -925,10 +1048,17 @@ static X509_STORE* NewRootCertStore() {
       // Parse errors from the built-in roots are fatal.
       CHECK_NOT_NULL(x509);
 
-      root_certs_vector.push_back(x509);
+      certs.emplace_back(x509);
     }
+    root_certificates = new std::shared_ptr<const X509Certificates>(
+        std::make_shared<const X509Certificates>(std::move(certs)));
   }
 
+  return *root_certificates;
+}
+
+
+static X509_STORE* NewRootCertStore() {
   X509_STORE* store = X509_STORE_new();
   if (*system_cert_path != '\0') {
     X509_STORE_load_locations(store, system_cert_path, nullptr);
@@ -936,16 +1066,24 @@ static X509_STORE* NewRootCertStore() {
   if (per_process::cli_options->ssl_openssl_cert_store) {
     X509_STORE_set_default_paths(store);
   } else {
-    for (X509* cert : root_certs_vector) {
-      X509_up_ref(cert);
-      X509_STORE_add_cert(store, cert);
-    }
+    for (const X509Pointer& cert : BuiltinRootCertificates()->certs())
+      X509_STORE_add_cert(store, cert.get());
   }
 
   return store;
 }
 
 
+// The store that is shared by all SecureContexts that use the default root
+// certificates. SecureContexts copy it before they add anything to it.
+static X509_STORE* GetRootCertStore() {
+  Mutex::ScopedLock lock(root_cert_store_mutex);
+  if (root_cert_store == nullptr)
+    root_cert_store = NewRootCertStore();
+  return root_cert_store;
+}
+
+
 void GetRootCertificates(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   Local<Array> result = Array::New(env->isolate(), arraysize(root_certs));
@@ -975,21 +1113,22 @@ void SecureContext::AddCACert(const FunctionCallbackInfo<Value>& args) {
     return THROW_ERR_MISSING_ARGS(env, "CA certificate argument is mandatory");
   }
 
-  BIOPointer bio(LoadBIO(env, args[0]));
-  if (!bio)
+  std::shared_ptr<const X509Certificates> certs =
+      LoadCertificates(env, args[0], X509Certificates::kTrustedCertificates);
+  if (!certs)
     return;
 
   X509_STORE* cert_store = SSL_CTX_get_cert_store(sc->ctx_.get());
-  while (X509* x509 = PEM_read_bio_X509_AUX(
-      bio.get(), nullptr, NoPasswordCallback, nullptr)) {
+  for (const X509Pointer& x509 : certs->certs()) {
     if (cert_store == root_cert_store) {
       cert_store = NewRootCertStore();
       SSL_CTX_set_cert_store(sc->ctx_.get(), cert_store);
     }
-    X509_STORE_add_cert(cert_store, x509);
-    SSL_CTX_add_client_CA(sc->ctx_.get(), x509);
-    X509_free(x509);
+    X509_STORE_add_cert(cert_store, x509.get());
+    SSL_CTX_add_client_CA(sc->ctx_.get(), x509.get());
   }
+
+  sc->ca_certs_.push_back(std::move(certs));
 }
 
 
@@ -1056,6 +1195,7 @@ static unsigned long AddCertsFromFile(  // NOLINT(runtime/int)
 
 void UseExtraCaCerts(const std::string& file) {
   ClearErrorOnReturn clear_error_on_return;
+  Mutex::ScopedLock lock(root_cert_store_mutex);
 
   if (root_cert_store == nullptr) {
     root_cert_store = NewRootCertStore();
@@ -1088,13 +1228,14 @@ void SecureContext::AddRootCerts(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
   ClearErrorOnReturn clear_error_on_return;
 
-  if (root_cert_store == nullptr) {
-    root_cert_store = NewRootCertStore();
-  }
+  X509_STORE* store = GetRootCertStore();
 
   // Increment reference count so global store is not deleted along with CTX.
-  X509_STORE_up_ref(root_cert_store);
-  SSL_CTX_set_cert_store(sc->ctx_.get(), root_cert_store);
+  X509_STORE_up_ref(store);
+  SSL_CTX_set_cert_store(sc->ctx_.get(), store);
+
+  if (!per_process::cli_options->ssl_openssl_cert_store)
+    sc->root_certs_ = BuiltinRootCertificates();
 }
 
 
@@ -1468,6 +1609,16 @@ void SecureContext::GetTicketKeys(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
 
   Local<Object> buff = Buffer::New(wrap->env(), 48).ToLocalChecked();
+  if (wrap->session_cache_ && wrap->session_cache_->manages_ticket_keys()) {
+    SessionCache::TicketKey current;
+    SessionCache::TicketKey previous;
+    if (wrap->session_cache_->GetTicketKeys(&current, &previous) == 0)
+      return ThrowCryptoError(wrap->env(), ERR_get_error());
+    memcpy(Buffer::Data(buff), current.name, 16);
+    memcpy(Buffer::Data(buff) + 16, current.hmac, 16);
+    memcpy(Buffer::Data(buff) + 32, current.aes, 16);
+    return args.GetReturnValue().Set(buff);
+  }
   memcpy(Buffer::Data(buff), wrap->ticket_key_name_, 16);
   memcpy(Buffer::Data(buff) + 16, wrap->ticket_key_hmac_, 16);
   memcpy(Buffer::Data(buff) + 32, wrap->ticket_key_aes_, 16);
@@ -1500,6 +1651,14 @@ void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
   memcpy(wrap->ticket_key_hmac_, buf.data() + 16, 16);
   memcpy(wrap->ticket_key_aes_, buf.data() + 32, 16);
 
+  if (wrap->session_cache_ && wrap->session_cache_->manages_ticket_keys()) {
+    SessionCache::TicketKey key;
+    memcpy(key.name, wrap->ticket_key_name_, 16);
+    memcpy(key.hmac, wrap->ticket_key_hmac_, 16);
+    memcpy(key.aes, wrap->ticket_key_aes_, 16);
+    wrap->session_cache_->SetTicketKey(key);
+  }
+
   args.GetReturnValue().Set(true);
 #endif  // !def(OPENSSL_NO_TLSEXT) && def(SSL_CTX_get_tlsext_ticket_keys)
 }
@@ -1509,6 +1668,354 @@ void SecureContext::SetFreeListLength(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void SecureContext::SetSessionCache(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+  Environment* env = sc->env();
+
+  CHECK_EQ(args.Length(), 4);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsUint32());
+  CHECK(args[3]->IsUint32());
+
+  SessionCache::Options options;
+  options.name = *Utf8Value(env->isolate(), args[0]);
+  options.path = *Utf8Value(env->isolate(), args[1]);
+  options.size = args[2].As<Uint32>()->Value();
+  options.ticket_key_rotation = args[3].As<Uint32>()->Value();
+
+  std::string error;
+  std::shared_ptr<SessionCache> cache = SessionCache::Get(options, &error);
+  if (!cache)
+    return env->ThrowError(error.c_str());
+  sc->session_cache_ = std::move(cache);
+}
+
+
+namespace {
+
+thread_local AsyncPrivateKeyListener::Scope* current_private_key_scope =
+    nullptr;
+
+}  // anonymous namespace
+
+
+AsyncPrivateKeyListener::Scope::Scope(Environment* env,
+                                      AsyncPrivateKeyListener* listener)
+    : env_(env),
+      listener_(listener),
+      previous_(current_private_key_scope) {
+  current_private_key_scope = this;
+}
+
+
+AsyncPrivateKeyListener::Scope::~Scope() {
+  current_private_key_scope = previous_;
+}
+
+
+AsyncPrivateKeyListener::Scope* AsyncPrivateKeyListener::Scope::current() {
+  return current_private_key_scope;
+}
+
+
+// Lives on the stack of the paused async job.
+class AsyncPrivateKeyOperation : public ThreadPoolWork {
+ public:
+  AsyncPrivateKeyOperation(Environment* env,
+                           AsyncPrivateKeyListener* listener,
+                           std::function<int()> fn)
+      : ThreadPoolWork(env), listener_(listener), fn_(std::move(fn)) {
+    CHECK_NULL(listener_->pending_operation_);
+    listener_->pending_operation_ = this;
+  }
+
+  void DoThreadPoolWork() override {
+    result_ = fn_();
+    // The error queue is per thread. Keep the errors, so that they can be
+    // reported on the thread of the handshake, see RestoreErrors().
+    while (unsigned long err = ERR_get_error())  // NOLINT(runtime/int)
+      errors_.push_back(err);
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    done_ = true;
+    if (listener_ == nullptr)
+      return;
+    listener_->pending_operation_ = nullptr;
+    listener_->OnAsyncPrivateKeyDone();
+  }
+
+  // The listener is gone, and the job will never be resumed.
+  inline void Detach() { listener_ = nullptr; }
+  inline bool done() const { return done_; }
+  inline int result() const { return result_; }
+
+  void RestoreErrors() const {
+    for (unsigned long err : errors_) {  // NOLINT(runtime/int)
+      ERR_put_error(ERR_GET_LIB(err), ERR_GET_FUNC(err), ERR_GET_REASON(err),
+                    __FILE__, __LINE__);
+    }
+  }
+
+ private:
+  AsyncPrivateKeyListener* listener_;
+  std::function<int()> fn_;
+  std::vector<unsigned long> errors_;  // NOLINT(runtime/int)
+  int result_ = -1;
+  bool done_ = false;
+};
+
+
+AsyncPrivateKeyListener::~AsyncPrivateKeyListener() {
+  if (pending_operation_ != nullptr)
+    pending_operation_->Detach();
+}
+
+
+namespace {
+
+// Runs `fn` on the thread pool and pauses the current async job until it is
+// done, if offloading is possible. Otherwise, runs `fn` synchronously.
+int RunPrivateKeyOperation(std::function<int()> fn) {
+  AsyncPrivateKeyListener::Scope* scope = current_private_key_scope;
+  if (scope == nullptr || ASYNC_get_current_job() == nullptr)
+    return fn();
+
+  AsyncPrivateKeyOperation op(scope->env(), scope->listener(), std::move(fn));
+  scope->listener()->OnAsyncPrivateKeyStart();
+  op.ScheduleWork();
+  // Each retry of the SSL call resumes the job, even if the operation is not
+  // done yet.
+  do {
+    CHECK_EQ(ASYNC_pause_job(), 1);
+  } while (!op.done());
+  op.RestoreErrors();
+  return op.result();
+}
+
+int AsyncRSAPrivateEncrypt(int flen,
+                           const unsigned char* from,
+                           unsigned char* to,
+                           RSA* rsa,
+                           int padding) {
+  return RunPrivateKeyOperation([=]() {
+    return RSA_meth_get_priv_enc(RSA_PKCS1_OpenSSL())(
+        flen, from, to, rsa, padding);
+  });
+}
+
+int AsyncRSAPrivateDecrypt(int flen,
+                           const unsigned char* from,
+                           unsigned char* to,
+                           RSA* rsa,
+                           int padding) {
+  return RunPrivateKeyOperation([=]() {
+    return RSA_meth_get_priv_dec(RSA_PKCS1_OpenSSL())(
+        flen, from, to, rsa, padding);
+  });
+}
+
+typedef int (*ECDSASign)(int type,
+                         const unsigned char* dgst,
+                         int dlen,
+                         unsigned char* sig,
+                         unsigned int* siglen,
+                         const BIGNUM* kinv,
+                         const BIGNUM* r,
+                         EC_KEY* eckey);
+typedef int (*ECDSASignSetup)(EC_KEY* eckey,
+                              BN_CTX* ctx,
+                              BIGNUM** kinv,
+                              BIGNUM** r);
+typedef ECDSA_SIG* (*ECDSASignSig)(const unsigned char* dgst,
+                                   int dgst_len,
+                                   const BIGNUM* kinv,
+                                   const BIGNUM* r,
+                                   EC_KEY* eckey);
+
+int AsyncECDSASign(int type,
+                   const unsigned char* dgst,
+                   int dlen,
+                   unsigned char* sig,
+                   unsigned int* siglen,
+                   const BIGNUM* kinv,
+                   const BIGNUM* r,
+                   EC_KEY* eckey) {
+  ECDSASign sign;
+  EC_KEY_METHOD_get_sign(EC_KEY_OpenSSL(), &sign, nullptr, nullptr);
+  return RunPrivateKeyOperation([=]() {
+    return sign(type, dgst, dlen, sig, siglen, kinv, r, eckey);
+  });
+}
+
+const RSA_METHOD* AsyncRSAMethod() {
+  static RSA_METHOD* method = []() {
+    RSA_METHOD* method = RSA_meth_dup(RSA_PKCS1_OpenSSL());
+    CHECK_NOT_NULL(method);
+    RSA_meth_set_priv_enc(method, AsyncRSAPrivateEncrypt);
+    RSA_meth_set_priv_dec(method, AsyncRSAPrivateDecrypt);
+    return method;
+  }();
+  return method;
+}
+
+const EC_KEY_METHOD* AsyncECKeyMethod() {
+  static EC_KEY_METHOD* method = []() {
+    EC_KEY_METHOD* method = EC_KEY_METHOD_new(EC_KEY_OpenSSL());
+    CHECK_NOT_NULL(method);
+    ECDSASignSetup sign_setup;
+    ECDSASignSig sign_sig;
+    EC_KEY_METHOD_get_sign(EC_KEY_OpenSSL(), nullptr, &sign_setup, &sign_sig);
+    EC_KEY_METHOD_set_sign(method, AsyncECDSASign, sign_setup, sign_sig);
+    return method;
+  }();
+  return method;
+}
+
+// Keys that use an engine, or a type of key that has no method table, keep
+// running synchronously.
+void UseAsyncPrivateKeyMethods(EVP_PKEY* pkey) {
+  switch (EVP_PKEY_base_id(pkey)) {
+    case EVP_PKEY_RSA:
+    case EVP_PKEY_RSA_PSS: {
+      RSA* rsa = EVP_PKEY_get0_RSA(pkey);
+      if (RSA_get_method(rsa) == RSA_PKCS1_OpenSSL())
+        RSA_set_method(rsa, AsyncRSAMethod());
+      break;
+    }
+    case EVP_PKEY_EC: {
+      EC_KEY* ec = EVP_PKEY_get0_EC_KEY(pkey);
+      if (EC_KEY_get_method(ec) == EC_KEY_OpenSSL())
+        EC_KEY_set_method(ec, AsyncECKeyMethod());
+      break;
+    }
+  }
+}
+
+}  // anonymous namespace
+
+
+void SecureContext::EnableAsyncPrivateKey(
+    const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+
+  // Without support for async jobs, handshakes cannot be paused.
+  if (!ASYNC_is_capable())
+    return;
+
+  SSL_CTX* ctx = sc->ctx_.get();
+  X509* current = SSL_CTX_get0_certificate(ctx);
+  for (int r = SSL_CTX_set_current_cert(ctx, SSL_CERT_SET_FIRST);
+       r == 1;
+       r = SSL_CTX_set_current_cert(ctx, SSL_CERT_SET_NEXT)) {
+    EVP_PKEY* pkey = SSL_CTX_get0_privatekey(ctx);
+    if (pkey != nullptr)
+      UseAsyncPrivateKeyMethods(pkey);
+  }
+  // The loop changes which certificate later calls, e.g. those for the
+  // issuer or the certificate chain, apply to.
+  if (current != nullptr)
+    SSL_CTX_select_current_cert(ctx, current);
+  sc->async_private_key_ = true;
+}
+
+
+void SecureContext::GetSessionCacheStats(
+    const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+
+  if (!sc->session_cache_)
+    return args.GetReturnValue().Set(false);
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), 6);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  const SessionCache::Stats stats = sc->session_cache_->GetStats();
+  fields[0] = static_cast<double>(stats.hits);
+  fields[1] = static_cast<double>(stats.misses);
+  fields[2] = static_cast<double>(stats.stores);
+  fields[3] = static_cast<double>(stats.evictions);
+  fields[4] = static_cast<double>(stats.ticket_key_rotations);
+  fields[5] = static_cast<double>(stats.size);
+  args.GetReturnValue().Set(true);
+}
+
+
+// Returns the earliest nextUpdate of the responses in `data`, in milliseconds
+// since the epoch, or Infinity if there is none, e.g. because `data` is not
+// an OCSP response that OpenSSL can parse.
+static double GetOCSPResponseNextUpdate(const unsigned char* data,
+                                        size_t length) {
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+  double expiry = std::numeric_limits<double>::infinity();
+
+  const unsigned char* p = data;
+  DeleteFnPtr<OCSP_RESPONSE, OCSP_RESPONSE_free> response(
+      d2i_OCSP_RESPONSE(nullptr, &p, length));
+  if (!response)
+    return expiry;
+  DeleteFnPtr<OCSP_BASICRESP, OCSP_BASICRESP_free> basic(
+      OCSP_response_get1_basic(response.get()));
+  if (!basic)
+    return expiry;
+
+  const time_t now = time(nullptr);
+  for (int i = 0; i < OCSP_resp_count(basic.get()); i++) {
+    ASN1_GENERALIZEDTIME* next_update = nullptr;
+    OCSP_single_get0_status(OCSP_resp_get0(basic.get(), i),
+                            nullptr, nullptr, nullptr, &next_update);
+    int days, seconds;
+    if (next_update == nullptr ||
+        !ASN1_TIME_diff(&days, &seconds, nullptr, next_update)) {
+      continue;
+    }
+    expiry = std::min(expiry, (now + days * 86400.0 + seconds) * 1000);
+  }
+
+  return expiry;
+}
+
+
+void SecureContext::SetOCSPResponse(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+
+  if (args[0]->IsNullOrUndefined()) {
+    sc->ocsp_response_.clear();
+    return;
+  }
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(env, args[0], "OCSP response");
+  // Responses without a nextUpdate time expire after `default_lifetime`
+  // milliseconds.
+  CHECK(args[1]->IsNumber());
+  const double default_lifetime = args[1].As<Number>()->Value();
+  ArrayBufferViewContents<unsigned char> response(args[0]);
+  sc->ocsp_response_.assign(response.data(),
+                            response.data() + response.length());
+  sc->ocsp_response_expiry_ =
+      GetOCSPResponseNextUpdate(response.data(), response.length());
+  if (sc->ocsp_response_expiry_ == std::numeric_limits<double>::infinity())
+    sc->ocsp_response_expiry_ = time(nullptr) * 1000.0 + default_lifetime;
+  args.GetReturnValue().Set(sc->ocsp_response_expiry_);
+}
+
+
+bool SecureContext::HasOCSPResponse() const {
+  return !ocsp_response_.empty() &&
+         ocsp_response_expiry_ > time(nullptr) * 1000.0;
+}
+
+
 // Currently, EnableTicketKeyCallback and TicketKeyCallback are only present for
 // the regression test in test/parallel/test-https-resume-after-renew.js.
 void SecureContext::EnableTicketKeyCallback(
@@ -1617,6 +2124,9 @@ int SecureContext::TicketCompatibilityCallback(SSL* ssl,
   SecureContext* sc = static_cast<SecureContext*>(
       SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
 
+  if (sc->session_cache_ && sc->session_cache_->manages_ticket_keys())
+    return SessionCacheTicketKeyCallback(ssl, name, iv, ectx, hctx, enc);
+
   if (enc) {
     memcpy(name, sc->ticket_key_name_, sizeof(sc->ticket_key_name_));
     if (RAND_bytes(iv, 16) <= 0 ||
@@ -1644,6 +2154,55 @@ int SecureContext::TicketCompatibilityCallback(SSL* ssl,
 }
 
 
+// Like TicketCompatibilityCallback, but with the keys of the session cache.
+// Tickets that were encrypted with the previous key are still accepted, and
+// are renewed with the current one.
+int SecureContext::SessionCacheTicketKeyCallback(SSL* ssl,
+                                                 unsigned char* name,
+                                                 unsigned char* iv,
+                                                 EVP_CIPHER_CTX* ectx,
+                                                 HMAC_CTX* hctx,
+                                                 int enc) {
+  SecureContext* sc = static_cast<SecureContext*>(
+      SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+
+  SessionCache::TicketKey keys[2];
+  int count = sc->session_cache_->GetTicketKeys(&keys[0], &keys[1]);
+  if (count == 0)
+    return -1;
+
+  const SessionCache::TicketKey* key = nullptr;
+  int r = 1;
+  if (enc) {
+    key = &keys[0];
+    memcpy(name, key->name, sizeof(key->name));
+    if (RAND_bytes(iv, 16) <= 0)
+      return -1;
+  } else {
+    for (int i = 0; i < count; i++) {
+      if (memcmp(name, keys[i].name, sizeof(keys[i].name)) == 0) {
+        key = &keys[i];
+        r = i == 0 ? 1 : 2;
+        break;
+      }
+    }
+    // The ticket key name does not match. Discard the ticket.
+    if (key == nullptr)
+      return 0;
+  }
+
+  int ok = enc ?
+      EVP_EncryptInit_ex(ectx, EVP_aes_128_cbc(), nullptr, key->aes, iv) :
+      EVP_DecryptInit_ex(ectx, EVP_aes_128_cbc(), nullptr, key->aes, iv);
+  if (ok <= 0 ||
+      HMAC_Init_ex(hctx, key->hmac, sizeof(key->hmac), EVP_sha256(),
+                   nullptr) <= 0) {
+    return -1;
+  }
+  return r;
+}
+
+
 void SecureContext::CtxGetter(const FunctionCallbackInfo<Value>& info) {
   SecureContext* sc;
   ASSIGN_OR_RETURN_UNWRAP(&sc, info.This());
@@ -1676,6 +2235,23 @@ void SecureContext::GetCertificate(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static void StoreInSessionCache(SessionCache* cache, SSL_SESSION* sess) {
+  int size = i2d_SSL_SESSION(sess, nullptr);
+  if (size <= 0 || static_cast<size_t>(size) > SessionCache::kMaxSessionSize)
+    return;
+
+  unsigned char data[SessionCache::kMaxSessionSize];
+  unsigned char* p = data;
+  i2d_SSL_SESSION(sess, &p);
+
+  unsigned int id_length;
+  const unsigned char* id = SSL_SESSION_get_id(sess, &id_length);
+  uint64_t expires = static_cast<uint64_t>(SSL_SESSION_get_time(sess)) +
+                     SSL_SESSION_get_timeout(sess);
+  cache->Store(id, id_length, data, size, expires);
+}
+
+
 template <class Base>
 void SSLWrap<Base>::AddMethods(Environment* env, Local<FunctionTemplate> t) {
   HandleScope scope(env->isolate());
@@ -1727,17 +2303,44 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
 
   *copy = 0;
-  return w->next_sess_.release();
+  if (w->next_sess_)
+    return w->next_sess_.release();
+
+  SecureContext* sc = static_cast<SecureContext*>(
+      SSL_CTX_get_app_data(SSL_get_SSL_CTX(s)));
+  if (sc == nullptr || !sc->session_cache_)
+    return nullptr;
+
+  // Sessions from the cache are resumed without calling into JS.
+  std::vector<unsigned char> session;
+  if (!sc->session_cache_->Lookup(key, len, &session))
+    return nullptr;
+  const unsigned char* p = session.data();
+  return d2i_SSL_SESSION(nullptr, &p, session.size());
 }
 
 
 template <class Base>
 int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+  if (ASYNC_get_current_job() != nullptr) {
+    SSL_SESSION_up_ref(sess);
+    std::shared_ptr<SSL_SESSION> ref(sess, SSL_SESSION_free);
+    w->DeferIfInAsyncJob([s, ref]() { NewSessionCallback(s, ref.get()); });
+    return 0;
+  }
+
   Environment* env = w->ssl_env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  if (w->is_server()) {
+    SecureContext* sc = static_cast<SecureContext*>(
+        SSL_CTX_get_app_data(SSL_get_SSL_CTX(s)));
+    if (sc != nullptr && sc->session_cache_)
+      StoreInSessionCache(sc->session_cache_.get(), sess);
+  }
+
   if (!w->session_callbacks_)
     return 0;
 
@@ -1774,6 +2377,12 @@ int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
 template <class Base>
 void SSLWrap<Base>::KeylogCallback(const SSL* s, const char* line) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+  if (ASYNC_get_current_job() != nullptr) {
+    std::string copy(line);
+    w->DeferIfInAsyncJob([s, copy]() { KeylogCallback(s, copy.c_str()); });
+    return;
+  }
+
   Environment* env = w->ssl_env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -2445,7 +3054,11 @@ void SSLWrap<Base>::SetOCSPResponse(const FunctionCallbackInfo<Value>& args) {
 
   THROW_AND_RETURN_IF_NOT_BUFFER(env, args[0], "OCSP response");
 
-  w->ocsp_response_.Reset(args.GetIsolate(), args[0].As<ArrayBufferView>());
+  // Copied, so that TLSExtStatusCallback() does not need to look at the
+  // Buffer, see DeferIfInAsyncJob().
+  ArrayBufferViewContents<unsigned char> response(args[0]);
+  w->ocsp_response_.assign(response.data(),
+                           response.data() + response.length());
 }
 
 
@@ -2640,17 +3253,9 @@ int SSLWrap<Base>::SelectALPNCallback(SSL* s,
                                       unsigned int inlen,
                                       void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
-
-  Local<Value> alpn_buffer =
-      w->object()->GetPrivate(
-          env->context(),
-          env->alpn_buffer_private_symbol()).ToLocalChecked();
-  ArrayBufferViewContents<unsigned char> alpn_protos(alpn_buffer);
+  const std::vector<unsigned char>& alpn_protos = w->alpn_protos_;
   int status = SSL_select_next_proto(const_cast<unsigned char**>(out), outlen,
-                                     alpn_protos.data(), alpn_protos.length(),
+                                     alpn_protos.data(), alpn_protos.size(),
                                      in, inlen);
   // According to 3.2. Protocol Selection of RFC7301, fatal
   // no_application_protocol alert shall be sent but OpenSSL 1.0.2 does not
@@ -2703,11 +3308,11 @@ void SSLWrap<Base>::SetALPNProtocols(const FunctionCallbackInfo<Value>& args) {
         w->ssl_.get(), alpn_protos.data(), alpn_protos.length());
     CHECK_EQ(r, 0);
   } else {
-    CHECK(
-        w->object()->SetPrivate(
-            env->context(),
-            env->alpn_buffer_private_symbol(),
-            args[0]).FromJust());
+    // Copied, so that SelectALPNCallback() does not need to look at the
+    // Buffer, see DeferIfInAsyncJob().
+    ArrayBufferViewContents<unsigned char> alpn_protos(args[0]);
+    w->alpn_protos_.assign(alpn_protos.data(),
+                           alpn_protos.data() + alpn_protos.length());
     // Server should select ALPN protocol from list of advertised by client
     SSL_CTX_set_alpn_select_cb(SSL_get_SSL_CTX(w->ssl_.get()),
                                SelectALPNCallback,
@@ -2720,9 +3325,10 @@ template <class Base>
 int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
   Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
 
   if (w->is_client()) {
+    HandleScope handle_scope(env->isolate());
+
     // Incoming response
     const unsigned char* resp;
     int len = SSL_get_tlsext_status_ocsp_resp(s, &resp);
@@ -2744,20 +3350,35 @@ int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
     return 1;
   } else {
     // Outgoing response
-    if (w->ocsp_response_.IsEmpty())
-      return SSL_TLSEXT_ERR_NOACK;
+    if (w->ocsp_response_.empty()) {
+      // Fall back to the response of the context that was selected by the
+      // SNICallback, if any, or of the server's context otherwise. Stapling
+      // it does not enter JS.
+      SecureContext* sc = w->sni_secure_context_;
+      if (sc == nullptr) {
+        sc = static_cast<SecureContext*>(
+            SSL_CTX_get_app_data(SSL_get_SSL_CTX(s)));
+      }
+      if (sc == nullptr || !sc->HasOCSPResponse())
+        return SSL_TLSEXT_ERR_NOACK;
+
+      size_t len = sc->ocsp_response_.size();
+      unsigned char* data = MallocOpenSSL<unsigned char>(len);
+      memcpy(data, sc->ocsp_response_.data(), len);
+      if (!SSL_set_tlsext_status_ocsp_resp(s, data, len))
+        OPENSSL_free(data);
+      return SSL_TLSEXT_ERR_OK;
+    }
 
-    Local<ArrayBufferView> obj = PersistentToLocal::Default(env->isolate(),
-                                                            w->ocsp_response_);
-    size_t len = obj->ByteLength();
+    size_t len = w->ocsp_response_.size();
 
     // OpenSSL takes control of the pointer after accepting it
     unsigned char* data = MallocOpenSSL<unsigned char>(len);
-    obj->CopyContents(data, len);
+    memcpy(data, w->ocsp_response_.data(), len);
 
     if (!SSL_set_tlsext_status_ocsp_resp(s, data, len))
       OPENSSL_free(data);
-    w->ocsp_response_.Reset();
+    w->ocsp_response_.clear();
 
     return SSL_TLSEXT_ERR_OK;
   }
@@ -2786,6 +3407,11 @@ int SSLWrap<Base>::SSLCertCallback(SSL* s, void* arg) {
     // handshake will continue after certcb is done.
     return -1;
 
+  // Suspend the handshake in the same way, and call into JS once the async
+  // job has returned.
+  if (w->DeferIfInAsyncJob([s, arg]() { SSLCertCallback(s, arg); }))
+    return -1;
+
   Environment* env = w->env();
   Local<Context> context = env->context();
   HandleScope handle_scope(env->isolate());
@@ -2900,6 +3526,7 @@ void SSLWrap<Base>::DestroySSL() {
 
 template <class Base>
 void SSLWrap<Base>::SetSNIContext(SecureContext* sc) {
+  sni_secure_context_ = sc;
   ConfigureSecureContext(sc);
   CHECK_EQ(SSL_set_SSL_CTX(ssl_.get(), sc->ctx_.get()), sc->ctx_.get());
 
@@ -4557,6 +5184,9 @@ void Hash::Initialize(Environment* env, Local<Object> target) {
 
   env->SetProtoMethod(t, "update", HashUpdate);
   env->SetProtoMethod(t, "digest", HashDigest);
+  env->SetProtoMethod(t,
+                      "getPipeTransform",
+                      StreamPipeTransform::GetPipeTransform<Hash>);
 
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "Hash"),
@@ -4598,6 +5228,16 @@ bool Hash::HashUpdate(const char* data, int len) {
 }
 
 
+int Hash::TransformChunks(std::vector<AllocatedBuffer>* chunks, bool finish) {
+  for (const AllocatedBuffer& chunk : *chunks) {
+    // The digest may already have been calculated from JS.
+    if (!HashUpdate(chunk.data(), chunk.size()))
+      return UV_EINVAL;
+  }
+  return 0;
+}
+
+
 void Hash::HashUpdate(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -5938,6 +6578,194 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Incremented in child processes that are created with fork(), e.g. by native
+// addons. lib/internal/crypto/random.js discards its pool of random bytes when
+// this changes, so that a child never hands out the same bytes as its parent.
+static uint32_t random_bytes_pool_fork_generation = 0;
+
+#ifndef _WIN32
+static void OnFork() {
+  random_bytes_pool_fork_generation++;
+}
+#endif  // !_WIN32
+
+
+// Fills the spare buffer of the random bytes pool in
+// lib/internal/crypto/random.js. The pool only serves synchronous calls, so
+// this is not an AsyncWrap. Sets the state to 1 on success and to 0 on failure.
+class RandomBytesPoolRefill : public ThreadPoolWork {
+ public:
+  RandomBytesPoolRefill(Environment* env,
+                        Local<ArrayBufferView> buffer,
+                        Local<Int32Array> state)
+      : ThreadPoolWork(env),
+        buffer_(env->isolate(), buffer),
+        state_(env->isolate(), state) {
+    data_ =
+        static_cast<unsigned char*>(buffer->Buffer()->GetContents().Data()) +
+        buffer->ByteOffset();
+    size_ = buffer->ByteLength();
+    state_data_ = reinterpret_cast<int32_t*>(
+        static_cast<char*>(state->Buffer()->GetContents().Data()) +
+        state->ByteOffset());
+  }
+
+  void DoThreadPoolWork() override {
+    CheckEntropy();
+    ok_ = RAND_bytes(data_, size_) == 1;
+    ERR_clear_error();
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<RandomBytesPoolRefill> self(this);
+    *state_data_ = status == 0 && ok_ ? 1 : 0;
+  }
+
+ private:
+  // Keep the memory alive while the work is pending.
+  Global<ArrayBufferView> buffer_;
+  Global<Int32Array> state_;
+  unsigned char* data_;
+  size_t size_;
+  int32_t* state_data_;
+  bool ok_ = false;
+};
+
+
+void RefillRandomBytesPool(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsArrayBufferView());  // buffer
+  CHECK(args[1]->IsInt32Array());  // state
+  RandomBytesPoolRefill* refill =
+      new RandomBytesPoolRefill(env,
+                                args[0].As<ArrayBufferView>(),
+                                args[1].As<Int32Array>());
+  refill->ScheduleWork();
+}
+
+
+// Splits a computation into `count` independent parts. The parts are run by
+// the thread that calls Run() and by helper tasks on the threadpool. Each
+// part is claimed by exactly one thread, and Run() only waits for parts that
+// another thread has already started, so it makes progress even when all
+// other threads of the pool are busy.
+class ParallelWork {
+ public:
+  inline ParallelWork(size_t count, std::function<void(size_t)> fn)
+      : count_(count), fn_(std::move(fn)) {}
+
+  // Returns how many helper tasks are worth scheduling for `parts` parts,
+  // given that the thread that calls Run() works on them as well.
+  static inline size_t HelperCount(uint64_t parts) {
+    if (parts < 2) return 0;
+    return std::min<uint64_t>(parts, affinity::ThreadpoolSize()) - 1;
+  }
+
+  // Schedules `helpers` tasks that work on the parts of `work`. Needs to be
+  // called on the thread of the event loop.
+  static inline void ScheduleHelpers(Environment* env,
+                                     std::shared_ptr<ParallelWork> work,
+                                     size_t helpers) {
+    for (size_t i = 0; i < helpers; i++)
+      (new Helper(env, work))->ScheduleWork();
+  }
+
+  // Runs the parts that have not been claimed yet, and waits for the others.
+  inline void Run() { Finish(true); }
+
+  // Skips the parts that have not been claimed yet, and waits for the others.
+  inline void Cancel() { Finish(false); }
+
+ private:
+  class Helper : public ThreadPoolWork {
+   public:
+    inline Helper(Environment* env, std::shared_ptr<ParallelWork> work)
+        : ThreadPoolWork(env), work_(std::move(work)) {}
+
+    inline void DoThreadPoolWork() override { work_->RunParts(true); }
+
+    inline void AfterThreadPoolWork(int status) override { delete this; }
+
+   private:
+    std::shared_ptr<ParallelWork> work_;
+  };
+
+  inline void RunParts(bool execute) {
+    size_t finished = 0;
+    for (size_t index = next_++; index < count_; index = next_++) {
+      if (execute) fn_(index);
+      finished++;
+    }
+    if (finished == 0) return;
+    Mutex::ScopedLock lock(mutex_);
+    done_ += finished;
+    if (done_ == count_) done_cond_.Broadcast(lock);
+  }
+
+  inline void Finish(bool execute) {
+    RunParts(execute);
+    Mutex::ScopedLock lock(mutex_);
+    while (done_ < count_) done_cond_.Wait(lock);
+  }
+
+  const size_t count_;
+  const std::function<void(size_t)> fn_;
+  std::atomic<size_t> next_{0};
+  Mutex mutex_;
+  ConditionVariable done_cond_;
+  size_t done_ = 0;  // Guarded by mutex_.
+};
+
+
+// Computes block number `index` (starting at 1) of the PBKDF2 output, which
+// is F(P, S, c, i) in RFC 8018, section 5.2. `out_len` may be smaller than the
+// size of the digest for the last block. This matches PKCS5_PBKDF2_HMAC(),
+// which only computes all blocks one after another.
+static bool PBKDF2Block(const EVP_MD* digest,
+                        const char* pass,
+                        size_t pass_len,
+                        const unsigned char* salt,
+                        size_t salt_len,
+                        uint32_t iteration_count,
+                        uint32_t index,
+                        unsigned char* out,
+                        size_t out_len) {
+  DeleteFnPtr<HMAC_CTX, HMAC_CTX_free> key_ctx(HMAC_CTX_new());
+  DeleteFnPtr<HMAC_CTX, HMAC_CTX_free> ctx(HMAC_CTX_new());
+  if (!key_ctx || !ctx) return false;
+  // HMAC_Init_ex() does not accept a null key for a fresh context.
+  if (pass_len == 0) pass = "";
+  if (!HMAC_Init_ex(key_ctx.get(), pass, pass_len, digest, nullptr))
+    return false;
+
+  const unsigned char counter[4] = {
+    static_cast<unsigned char>(index >> 24),
+    static_cast<unsigned char>(index >> 16),
+    static_cast<unsigned char>(index >> 8),
+    static_cast<unsigned char>(index)
+  };
+  const size_t md_size = EVP_MD_size(digest);
+  unsigned char u[EVP_MAX_MD_SIZE];
+  bool ok = HMAC_CTX_copy(ctx.get(), key_ctx.get()) &&
+            HMAC_Update(ctx.get(), salt, salt_len) &&
+            HMAC_Update(ctx.get(), counter, sizeof(counter)) &&
+            HMAC_Final(ctx.get(), u, nullptr);
+  if (ok) memcpy(out, u, out_len);
+  for (uint32_t i = 1; ok && i < iteration_count; i++) {
+    if (!HMAC_CTX_copy(ctx.get(), key_ctx.get()) ||
+        !HMAC_Update(ctx.get(), u, md_size) ||
+        !HMAC_Final(ctx.get(), u, nullptr)) {
+      ok = false;
+      break;
+    }
+    for (size_t j = 0; j < out_len; j++)
+      out[j] ^= u[j];
+  }
+  OPENSSL_cleanse(u, sizeof(u));
+  return ok;
+}
+
+
 struct PBKDF2Job : public CryptoJob {
   unsigned char* keybuf_data;
   size_t keybuf_size;
@@ -5946,19 +6774,49 @@ struct PBKDF2Job : public CryptoJob {
   uint32_t iteration_count;
   const EVP_MD* digest;
   Maybe<bool> success;
+  std::shared_ptr<ParallelWork> parallel;
+  std::atomic<bool> parallel_ok{true};
 
   inline explicit PBKDF2Job(Environment* env)
       : CryptoJob(env), success(Nothing<bool>()) {}
 
   inline ~PBKDF2Job() override {
+    if (parallel) parallel->Cancel();
     Cleanse();
   }
 
+  // Lets other threads of the pool compute some of the blocks of the key,
+  // if it consists of more than one.
+  inline void Parallelize() {
+    const size_t block_size = EVP_MD_size(digest);
+    const size_t blocks = (keybuf_size + block_size - 1) / block_size;
+    const size_t helpers = ParallelWork::HelperCount(blocks);
+    if (helpers == 0) return;
+    parallel = std::make_shared<ParallelWork>(blocks,
+                                              [this, block_size](size_t i) {
+      auto salt_data = reinterpret_cast<const unsigned char*>(salt.data());
+      const size_t offset = i * block_size;
+      if (!PBKDF2Block(digest, pass.data(), pass.size(), salt_data,
+                       salt.size(), iteration_count, i + 1,
+                       keybuf_data + offset,
+                       std::min(block_size, keybuf_size - offset))) {
+        parallel_ok = false;
+      }
+    });
+    ParallelWork::ScheduleHelpers(env, parallel, helpers);
+  }
+
   inline void DoThreadPoolWork() override {
-    auto salt_data = reinterpret_cast<const unsigned char*>(salt.data());
-    const bool ok =
-        PKCS5_PBKDF2_HMAC(pass.data(), pass.size(), salt_data, salt.size(),
-                          iteration_count, digest, keybuf_size, keybuf_data);
+    bool ok;
+    if (parallel) {
+      parallel->Run();
+      ok = parallel_ok;
+    } else {
+      auto salt_data = reinterpret_cast<const unsigned char*>(salt.data());
+      ok = PKCS5_PBKDF2_HMAC(pass.data(), pass.size(), salt_data, salt.size(),
+                             iteration_count, digest, keybuf_size,
+                             keybuf_data);
+    }
     success = Just(ok);
     Cleanse();
   }
@@ -5999,7 +6857,10 @@ inline void PBKDF2(const FunctionCallbackInfo<Value>& args) {
   Utf8Value digest_name(args.GetIsolate(), args[4]);
   job->digest = EVP_get_digestbyname(*digest_name);
   if (job->digest == nullptr) return rv.Set(-1);
-  if (args[5]->IsObject()) return PBKDF2Job::Run(std::move(job), args[5]);
+  if (args[5]->IsObject()) {
+    job->Parallelize();
+    return PBKDF2Job::Run(std::move(job), args[5]);
+  }
   env->PrintSyncTrace();
   job->DoThreadPoolWork();
   rv.Set(job->ToResult());
@@ -6007,6 +6868,115 @@ inline void PBKDF2(const FunctionCallbackInfo<Value>& args) {
 
 
 #ifndef OPENSSL_NO_SCRYPT
+// scryptBlockMix and scryptROMix from RFC 7914, which EVP_PBE_scrypt() runs
+// for one lane after another. Taken from OpenSSL - edited for style.
+static inline uint32_t ScryptRotate(uint32_t a, int b) {
+  return (a << b) | (a >> (32 - b));
+}
+
+
+static void Salsa208(uint32_t inout[16]) {
+  uint32_t x[16];
+  memcpy(x, inout, sizeof(x));
+  for (int i = 8; i > 0; i -= 2) {
+    x[4] ^= ScryptRotate(x[0] + x[12], 7);
+    x[8] ^= ScryptRotate(x[4] + x[0], 9);
+    x[12] ^= ScryptRotate(x[8] + x[4], 13);
+    x[0] ^= ScryptRotate(x[12] + x[8], 18);
+    x[9] ^= ScryptRotate(x[5] + x[1], 7);
+    x[13] ^= ScryptRotate(x[9] + x[5], 9);
+    x[1] ^= ScryptRotate(x[13] + x[9], 13);
+    x[5] ^= ScryptRotate(x[1] + x[13], 18);
+    x[14] ^= ScryptRotate(x[10] + x[6], 7);
+    x[2] ^= ScryptRotate(x[14] + x[10], 9);
+    x[6] ^= ScryptRotate(x[2] + x[14], 13);
+    x[10] ^= ScryptRotate(x[6] + x[2], 18);
+    x[3] ^= ScryptRotate(x[15] + x[11], 7);
+    x[7] ^= ScryptRotate(x[3] + x[15], 9);
+    x[11] ^= ScryptRotate(x[7] + x[3], 13);
+    x[15] ^= ScryptRotate(x[11] + x[7], 18);
+    x[1] ^= ScryptRotate(x[0] + x[3], 7);
+    x[2] ^= ScryptRotate(x[1] + x[0], 9);
+    x[3] ^= ScryptRotate(x[2] + x[1], 13);
+    x[0] ^= ScryptRotate(x[3] + x[2], 18);
+    x[6] ^= ScryptRotate(x[5] + x[4], 7);
+    x[7] ^= ScryptRotate(x[6] + x[5], 9);
+    x[4] ^= ScryptRotate(x[7] + x[6], 13);
+    x[5] ^= ScryptRotate(x[4] + x[7], 18);
+    x[11] ^= ScryptRotate(x[10] + x[9], 7);
+    x[8] ^= ScryptRotate(x[11] + x[10], 9);
+    x[9] ^= ScryptRotate(x[8] + x[11], 13);
+    x[10] ^= ScryptRotate(x[9] + x[8], 18);
+    x[12] ^= ScryptRotate(x[15] + x[14], 7);
+    x[13] ^= ScryptRotate(x[12] + x[15], 9);
+    x[14] ^= ScryptRotate(x[13] + x[12], 13);
+    x[15] ^= ScryptRotate(x[14] + x[13], 18);
+  }
+  for (int i = 0; i < 16; ++i)
+    inout[i] += x[i];
+  OPENSSL_cleanse(x, sizeof(x));
+}
+
+
+static void ScryptBlockMix(uint32_t* out, const uint32_t* in, uint64_t r) {
+  uint32_t x[16];
+  memcpy(x, in + (r * 2 - 1) * 16, sizeof(x));
+  for (uint64_t i = 0; i < r * 2; i++) {
+    for (uint64_t j = 0; j < 16; j++)
+      x[j] ^= *in++;
+    Salsa208(x);
+    memcpy(out + (i / 2 + (i & 1) * r) * 16, x, sizeof(x));
+  }
+  OPENSSL_cleanse(x, sizeof(x));
+}
+
+
+// Runs scryptROMix on the 128 * r bytes at `block`, using 128 * r * (N + 2)
+// bytes of scratch memory.
+static bool ScryptROMix(unsigned char* block, uint64_t r, uint64_t N) {
+  const size_t words = 32 * r * (N + 2);
+  uint32_t* X = UncheckedMalloc<uint32_t>(words);
+  if (X == nullptr) return false;
+  uint32_t* T = X + 32 * r;
+  uint32_t* V = T + 32 * r;
+
+  // Convert from little endian input.
+  unsigned char* pB = block;
+  uint32_t* pV = V;
+  for (uint64_t i = 0; i < 32 * r; i++, pV++, pB += 4) {
+    *pV = pB[0] | (pB[1] << 8) | (pB[2] << 16) |
+          (static_cast<uint32_t>(pB[3]) << 24);
+  }
+
+  for (uint64_t i = 1; i < N; i++, pV += 32 * r)
+    ScryptBlockMix(pV, pV - 32 * r, r);
+
+  ScryptBlockMix(X, V + (N - 1) * 32 * r, r);
+
+  for (uint64_t i = 0; i < N; i++) {
+    const uint32_t j = X[16 * (2 * r - 1)] % N;
+    pV = V + 32 * r * j;
+    for (uint64_t k = 0; k < 32 * r; k++)
+      T[k] = X[k] ^ pV[k];
+    ScryptBlockMix(X, T, r);
+  }
+
+  // Convert output to little endian.
+  pB = block;
+  for (uint64_t i = 0; i < 32 * r; i++) {
+    const uint32_t xtmp = X[i];
+    *pB++ = xtmp & 0xff;
+    *pB++ = (xtmp >> 8) & 0xff;
+    *pB++ = (xtmp >> 16) & 0xff;
+    *pB++ = (xtmp >> 24) & 0xff;
+  }
+
+  OPENSSL_cleanse(X, words * sizeof(*X));
+  free(X);
+  return true;
+}
+
+
 struct ScryptJob : public CryptoJob {
   unsigned char* keybuf_data;
   size_t keybuf_size;
@@ -6017,10 +6987,15 @@ struct ScryptJob : public CryptoJob {
   uint32_t p;
   uint32_t maxmem;
   CryptoErrorVector errors;
+  // B from RFC 7914, while its lanes are mixed in parallel.
+  std::vector<unsigned char> blocks;
+  std::shared_ptr<ParallelWork> parallel;
+  std::atomic<bool> parallel_ok{true};
 
   inline explicit ScryptJob(Environment* env) : CryptoJob(env) {}
 
   inline ~ScryptJob() override {
+    if (parallel) parallel->Cancel();
     Cleanse();
   }
 
@@ -6035,7 +7010,47 @@ struct ScryptJob : public CryptoJob {
     }
   }
 
+  // Lets other threads of the pool mix some of the p lanes, as far as maxmem
+  // allows for the scratch memory of each lane. Needs to be called after
+  // Validate().
+  inline void Parallelize() {
+    const uint64_t block_size = 128 * static_cast<uint64_t>(r);
+    const uint64_t blocks_size = block_size * p;
+    const uint64_t lane_size = block_size * (N + 2);
+    // Matches SCRYPT_MAX_MEM, which EVP_PBE_scrypt() uses when maxmem is 0.
+    const uint64_t max_size = maxmem != 0 ? maxmem : 32 << 20;
+    const uint64_t lanes = (max_size - blocks_size) / lane_size;
+    const size_t helpers =
+        ParallelWork::HelperCount(std::min<uint64_t>(p, lanes));
+    if (helpers == 0) return;
+    blocks.resize(blocks_size);
+    auto salt_data = reinterpret_cast<const unsigned char*>(salt.data());
+    if (!PKCS5_PBKDF2_HMAC(pass.data(), pass.size(), salt_data, salt.size(),
+                           1, EVP_sha256(), blocks.size(), blocks.data())) {
+      ERR_clear_error();
+      blocks.clear();
+      return;
+    }
+    parallel = std::make_shared<ParallelWork>(p, [this, block_size](size_t i) {
+      if (!ScryptROMix(blocks.data() + i * block_size, r, N))
+        parallel_ok = false;
+    });
+    ParallelWork::ScheduleHelpers(env, parallel, helpers);
+  }
+
   inline void DoThreadPoolWork() override {
+    if (parallel) {
+      parallel->Run();
+      const bool ok = parallel_ok &&
+          PKCS5_PBKDF2_HMAC(pass.data(), pass.size(), blocks.data(),
+                            blocks.size(), 1, EVP_sha256(), keybuf_size,
+                            keybuf_data);
+      OPENSSL_cleanse(blocks.data(), blocks.size());
+      blocks.clear();
+      if (ok) return;
+      // Start over with the serial implementation, which reports the error.
+      ERR_clear_error();
+    }
     auto salt_data = reinterpret_cast<const unsigned char*>(salt.data());
     if (1 != EVP_PBE_scrypt(pass.data(), pass.size(), salt_data, salt.size(),
                             N, r, p, maxmem, keybuf_data, keybuf_size)) {
@@ -6056,8 +7071,10 @@ struct ScryptJob : public CryptoJob {
   inline void Cleanse() {
     OPENSSL_cleanse(pass.data(), pass.size());
     OPENSSL_cleanse(salt.data(), salt.size());
+    OPENSSL_cleanse(blocks.data(), blocks.size());
     pass.clear();
     salt.clear();
+    blocks.clear();
   }
 };
 
@@ -6090,7 +7107,10 @@ void Scrypt(const FunctionCallbackInfo<Value>& args) {
     if (result->IsUndefined()) result = Null(args.GetIsolate());
     return args.GetReturnValue().Set(result);
   }
-  if (args[7]->IsObject()) return ScryptJob::Run(std::move(job), args[7]);
+  if (args[7]->IsObject()) {
+    job->Parallelize();
+    return ScryptJob::Run(std::move(job), args[7]);
+  }
   env->PrintSyncTrace();
   job->DoThreadPoolWork();
   args.GetReturnValue().Set(job->ToResult());
@@ -6806,6 +7826,10 @@ void InitCryptoOnce() {
 #endif  // !OPENSSL_NO_ENGINE
 
   NodeBIO::GetMethod();
+
+#ifndef _WIN32
+  CHECK_EQ(pthread_atfork(nullptr, nullptr, OnFork), 0);
+#endif  // !_WIN32
 }
 
 
@@ -6919,6 +7943,16 @@ void Initialize(Local<Object> target,
   NODE_DEFINE_CONSTANT(target, kKeyTypePublic);
   NODE_DEFINE_CONSTANT(target, kKeyTypePrivate);
   env->SetMethod(target, "randomBytes", RandomBytes);
+  env->SetMethod(target, "refillRandomBytesPool", RefillRandomBytesPool);
+  Local<ArrayBuffer> fork_generation_buffer =
+      ArrayBuffer::New(env->isolate(),
+                       &random_bytes_pool_fork_generation,
+                       sizeof(random_bytes_pool_fork_generation),
+                       ArrayBufferCreationMode::kExternalized);
+  target->Set(env->context(),
+              FIXED_ONE_BYTE_STRING(env->isolate(),
+                                    "randomBytesPoolForkGeneration"),
+              Uint32Array::New(fork_generation_buffer, 0, 1)).Check();
   env->SetMethod(target, "signOneShot", SignOneShot);
   env->SetMethod(target, "verifyOneShot", VerifyOneShot);
   env->SetMethodNoSideEffect(target, "timingSafeEqual", TimingSafeEqual);
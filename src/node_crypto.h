@@ -26,16 +26,23 @@
 
 // ClientHelloParser
 #include "node_crypto_clienthello.h"
+#include "node_crypto_session_cache.h"
 
 #include "env.h"
 #include "base_object.h"
+#include "stream_pipe.h"
 #include "util.h"
 
 #include "v8.h"
 
+#include <openssl/async.h>
 #include <openssl/err.h>
 #include <openssl/ssl.h>
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 namespace node {
 namespace crypto {
 
@@ -77,6 +84,40 @@ extern int VerifyCallback(int preverify_ok, X509_STORE_CTX* ctx);
 
 extern void UseExtraCaCerts(const std::string& file);
 
+// An immutable list of parsed certificates. Parsing PEM data is expensive, so
+// the certificates are cached by a hash of the data, and the SecureContexts
+// that load the same data, e.g. the same `ca` bundle, share one instance.
+class X509Certificates : public MemoryRetainer {
+ public:
+  enum Format {
+    // The format of setCert(): a certificate that may have trust settings,
+    // followed by the rest of its chain. Fails on any parse error.
+    kCertificateChain,
+    // The format of addCACert(): certificates that may have trust settings.
+    // Parsing stops at the first error.
+    kTrustedCertificates
+  };
+
+  // Returns nullptr, with the error on the OpenSSL error queue, if the data
+  // cannot be parsed.
+  static std::shared_ptr<const X509Certificates> FromPEM(const char* data,
+                                                         size_t length,
+                                                         Format format);
+
+  explicit X509Certificates(std::vector<X509Pointer>&& certs);
+
+  const std::vector<X509Pointer>& certs() const { return certs_; }
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(X509Certificates)
+  SET_SELF_SIZE(X509Certificates)
+
+ private:
+  std::vector<X509Pointer> certs_;
+  // The DER encoded size, the parsed certificates take somewhat more.
+  size_t size_ = 0;
+};
+
 void InitCryptoOnce();
 
 class SecureContext : public BaseObject {
@@ -87,8 +128,7 @@ class SecureContext : public BaseObject {
 
   static void Initialize(Environment* env, v8::Local<v8::Object> target);
 
-  // TODO(joyeecheung): track the memory used by OpenSSL types
-  SET_NO_MEMORY_INFO()
+  void MemoryInfo(MemoryTracker* tracker) const override;
   SET_MEMORY_INFO_NAME(SecureContext)
   SET_SELF_SIZE(SecureContext)
 
@@ -112,6 +152,25 @@ class SecureContext : public BaseObject {
   unsigned char ticket_key_aes_[16];
   unsigned char ticket_key_hmac_[16];
 
+  // Set by setSessionCache(), shared with other SecureContexts that use the
+  // same cache.
+  std::shared_ptr<SessionCache> session_cache_;
+
+  // Set by enableAsyncPrivateKey(), see AsyncPrivateKeyListener.
+  bool async_private_key_ = false;
+
+  // The certificates that were loaded into ctx_, kept for sharing them with
+  // other SecureContexts and for memory accounting.
+  std::shared_ptr<const X509Certificates> cert_chain_;
+  std::vector<std::shared_ptr<const X509Certificates>> ca_certs_;
+  std::shared_ptr<const X509Certificates> root_certs_;
+
+  // Set by setOCSPResponse(). Stapled to the handshakes that request it, unless
+  // the connection has a response of its own, until it expires.
+  std::vector<unsigned char> ocsp_response_;
+  double ocsp_response_expiry_ = 0;  // In milliseconds since the epoch.
+  bool HasOCSPResponse() const;
+
  protected:
   // OpenSSL structures are opaque. This is sizeof(SSL_CTX) for OpenSSL 1.1.1b:
   static const int64_t kExternalSize = 1024;
@@ -148,6 +207,12 @@ class SecureContext : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableTicketKeyCallback(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSessionCache(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAsyncPrivateKey(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetSessionCacheStats(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetOCSPResponse(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CtxGetter(const v8::FunctionCallbackInfo<v8::Value>& info);
 
   template <bool primary>
@@ -167,6 +232,13 @@ class SecureContext : public BaseObject {
                                          HMAC_CTX* hctx,
                                          int enc);
 
+  static int SessionCacheTicketKeyCallback(SSL* ssl,
+                                           unsigned char* name,
+                                           unsigned char* iv,
+                                           EVP_CIPHER_CTX* ectx,
+                                           HMAC_CTX* hctx,
+                                           int enc);
+
   SecureContext(Environment* env, v8::Local<v8::Object> wrap)
       : BaseObject(env, wrap) {
     MakeWeak();
@@ -180,9 +252,59 @@ class SecureContext : public BaseObject {
     ctx_.reset();
     cert_.reset();
     issuer_.reset();
+    session_cache_.reset();
+    cert_chain_.reset();
+    ca_certs_.clear();
+    root_certs_.reset();
+    ocsp_response_.clear();
   }
 };
 
+class AsyncPrivateKeyOperation;
+
+// The RSA and EC private keys of a SecureContext with enableAsyncPrivateKey()
+// sign and decrypt on the thread pool when they are used from within an
+// OpenSSL async job, i.e. from SSL_do_handshake() with SSL_MODE_ASYNC. The job
+// is paused until the operation is done, and SSL_do_handshake() fails with
+// SSL_ERROR_WANT_ASYNC in the meantime. Connections implement this interface
+// to learn when to call it again.
+class AsyncPrivateKeyListener {
+ public:
+  virtual ~AsyncPrivateKeyListener();
+
+  // Both are called on the event loop thread.
+  virtual void OnAsyncPrivateKeyStart() = 0;
+  virtual void OnAsyncPrivateKeyDone() = 0;
+
+  // Private key operations are only offloaded while a Scope is active.
+  // Elsewhere, they run synchronously.
+  class Scope {
+   public:
+    Scope(Environment* env, AsyncPrivateKeyListener* listener);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    static Scope* current();
+    inline Environment* env() const { return env_; }
+    inline AsyncPrivateKeyListener* listener() const { return listener_; }
+
+   private:
+    Environment* env_;
+    AsyncPrivateKeyListener* listener_;
+    Scope* previous_;
+  };
+
+ protected:
+  inline bool has_pending_operation() const {
+    return pending_operation_ != nullptr;
+  }
+
+ private:
+  friend class AsyncPrivateKeyOperation;
+  AsyncPrivateKeyOperation* pending_operation_ = nullptr;
+};
+
 // SSLWrap implicitly depends on the inheriting class' handle having an
 // internal pointer to the Base class.
 template <class Base>
@@ -287,6 +409,29 @@ class SSLWrap {
     return env_;
   }
 
+  // JS must not run on the stack of an OpenSSL async job, see
+  // AsyncPrivateKeyListener. Callbacks that are called from within one are
+  // queued instead, and RunDeferredCallbacks() runs them after the SSL call
+  // has returned.
+  template <typename Fn>
+  inline bool DeferIfInAsyncJob(Fn&& fn) {
+    if (ASYNC_get_current_job() == nullptr)
+      return false;
+    deferred_callbacks_.emplace_back(std::forward<Fn>(fn));
+    return true;
+  }
+
+  inline void RunDeferredCallbacks() {
+    std::vector<std::function<void()>> callbacks;
+    callbacks.swap(deferred_callbacks_);
+    for (const auto& callback : callbacks) {
+      // A callback may have destroyed the connection.
+      if (!ssl_)
+        break;
+      callback();
+    }
+  }
+
   Environment* const env_;
   Kind kind_;
   SSLSessionPointer next_sess_;
@@ -301,8 +446,15 @@ class SSLWrap {
 
   ClientHelloParser hello_parser_;
 
-  v8::Global<v8::ArrayBufferView> ocsp_response_;
+  // Raw copies of what JS passed to setOCSPResponse() and, on the server,
+  // setALPNProtocols().
+  std::vector<unsigned char> ocsp_response_;
+  std::vector<unsigned char> alpn_protos_;
   v8::Global<v8::Value> sni_context_;
+  // The SecureContext of sni_context_, which keeps it alive.
+  SecureContext* sni_secure_context_ = nullptr;
+
+  std::vector<std::function<void()>> deferred_callbacks_;
 
   friend class SecureContext;
 };
@@ -576,7 +728,7 @@ class Hmac : public BaseObject {
   DeleteFnPtr<HMAC_CTX, HMAC_CTX_free> ctx_;
 };
 
-class Hash : public BaseObject {
+class Hash : public BaseObject, public StreamPipeTransform {
  public:
   static void Initialize(Environment* env, v8::Local<v8::Object> target);
 
@@ -588,6 +740,11 @@ class Hash : public BaseObject {
   bool HashInit(const char* hash_type);
   bool HashUpdate(const char* data, int len);
 
+  // Hashes the data passing through a StreamPipe, without modifying it.
+  int TransformChunks(std::vector<AllocatedBuffer>* chunks,
+                      bool finish) override;
+  v8::Local<v8::Object> GetTransformObject() override { return object(); }
+
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HashUpdate(const v8::FunctionCallbackInfo<v8::Value>& args);
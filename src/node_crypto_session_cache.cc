@@ -0,0 +1,411 @@
+#include "node_crypto_session_cache.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <openssl/rand.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+namespace crypto {
+
+namespace {
+
+const uint32_t kMagic = 0x4e545343;  // "NTSC"
+const uint32_t kVersion = 1;
+const uint32_t kWays = 4;
+
+Mutex registry_mutex;
+std::unordered_map<std::string, std::weak_ptr<SessionCache>> registry;
+
+uint64_t Now() {
+  return static_cast<uint64_t>(time(nullptr));
+}
+
+uint32_t Hash(const unsigned char* data, size_t length) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Larger caches could not be allocated anyway, and would overflow below.
+const uint32_t kMaxSlots = 1 << 24;
+
+uint32_t NormalizeSize(uint32_t size) {
+  if (size < kWays)
+    return kWays;
+  if (size > kMaxSlots)
+    return kMaxSlots;
+  return RoundUp(size, kWays);
+}
+
+}  // anonymous namespace
+
+// The header and the slots have a fixed layout, so that different versions
+// of Node.js detect files that they cannot use.
+struct SessionCache::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t ticket_key_rotation;
+#ifndef _WIN32
+  pthread_mutex_t mutex;
+#endif
+  // Incremented on each access, used to find the least recently used slot.
+  uint64_t clock;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t stores;
+  uint64_t evictions;
+  uint64_t ticket_key_rotations;
+  // 0 if no ticket key has been generated yet.
+  uint64_t ticket_key_created;
+  uint32_t has_previous_ticket_key;
+  uint32_t reserved;
+  TicketKey current_ticket_key;
+  TicketKey previous_ticket_key;
+};
+
+struct SessionCache::Slot {
+  // 0 if the slot is empty.
+  uint64_t expires;
+  uint64_t last_used;
+  uint32_t id_length;
+  uint32_t session_length;
+  unsigned char id[kMaxSessionIdLength];
+  unsigned char session[kMaxSessionSize];
+};
+
+class SessionCache::ScopedLock {
+ public:
+  explicit ScopedLock(SessionCache* cache) : cache_(cache) {
+#ifndef _WIN32
+    if (cache_->mapped_) {
+      int err = pthread_mutex_lock(&cache_->header_->mutex);
+#ifdef __linux__
+      if (err == EOWNERDEAD) {
+        // Another process died while holding the lock, possibly in the
+        // middle of an update.
+        cache_->ClearLocked();
+        err = pthread_mutex_consistent(&cache_->header_->mutex);
+      }
+#endif
+      CHECK_EQ(err, 0);
+      return;
+    }
+#endif
+    cache_->mutex_.Lock();
+  }
+
+  ~ScopedLock() {
+#ifndef _WIN32
+    if (cache_->mapped_) {
+      CHECK_EQ(pthread_mutex_unlock(&cache_->header_->mutex), 0);
+      return;
+    }
+#endif
+    cache_->mutex_.Unlock();
+  }
+
+ private:
+  SessionCache* cache_;
+};
+
+std::shared_ptr<SessionCache> SessionCache::Get(const Options& options,
+                                                std::string* error) {
+  Options normalized = options;
+  normalized.size = NormalizeSize(options.size);
+
+  Mutex::ScopedLock lock(registry_mutex);
+  std::weak_ptr<SessionCache>& entry = registry[normalized.name];
+  std::shared_ptr<SessionCache> cache = entry.lock();
+  if (cache) {
+    const Options& existing = cache->options();
+    if (existing.path != normalized.path ||
+        existing.size != normalized.size ||
+        existing.ticket_key_rotation != normalized.ticket_key_rotation) {
+      *error = "session cache '" + normalized.name +
+               "' already exists with different options";
+      return nullptr;
+    }
+    return cache;
+  }
+
+  cache.reset(new SessionCache(normalized));
+  if (cache->Map(error) != 0)
+    return nullptr;
+  entry = cache;
+  return cache;
+}
+
+SessionCache::SessionCache(const Options& options) : options_(options) {}
+
+SessionCache::~SessionCache() {
+  if (header_ == nullptr)
+    return;
+#ifndef _WIN32
+  if (mapped_) {
+    munmap(header_, mapping_size_);
+    return;
+  }
+#endif
+  free(header_);
+}
+
+int SessionCache::Map(std::string* error) {
+  const size_t header_size = RoundUp<size_t>(sizeof(Header), 64);
+  mapping_size_ = header_size + sizeof(Slot) * options_.size;
+
+  if (options_.path.empty()) {
+    // calloc() leaves untouched pages unmapped, so the memory is only used
+    // once sessions are stored.
+    header_ = static_cast<Header*>(calloc(1, mapping_size_));
+    if (header_ == nullptr) {
+      *error = "out of memory";
+      return UV_ENOMEM;
+    }
+    header_->magic = kMagic;
+    header_->version = kVersion;
+    header_->slot_count = options_.size;
+    header_->ticket_key_rotation = options_.ticket_key_rotation;
+    return 0;
+  }
+
+#ifdef _WIN32
+  *error = "shared session caches are not supported on this platform";
+  return UV_ENOTSUP;
+#else
+  const char* path = options_.path.c_str();
+  int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd == -1) {
+    *error = std::string("cannot open ") + path + ": " + strerror(errno);
+    return -errno;
+  }
+
+  // Only one process initializes a new file.
+  int err = 0;
+  struct stat s;
+  bool initialize = false;
+  while (flock(fd, LOCK_EX) == -1 && errno == EINTR) {}
+  if (fstat(fd, &s) == -1) {
+    err = -errno;
+  } else if (s.st_size == 0) {
+    initialize = true;
+    if (ftruncate(fd, mapping_size_) == -1)
+      err = -errno;
+  } else if (static_cast<size_t>(s.st_size) != mapping_size_) {
+    err = UV_EINVAL;
+  }
+
+  void* mapping = MAP_FAILED;
+  if (err == 0) {
+    mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+      err = -errno;
+  }
+
+  if (err == 0) {
+    header_ = static_cast<Header*>(mapping);
+    mapped_ = true;
+    if (initialize) {
+      pthread_mutexattr_t attr;
+      CHECK_EQ(pthread_mutexattr_init(&attr), 0);
+      CHECK_EQ(pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED), 0);
+#ifdef __linux__
+      CHECK_EQ(pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST), 0);
+#endif
+      CHECK_EQ(pthread_mutex_init(&header_->mutex, &attr), 0);
+      pthread_mutexattr_destroy(&attr);
+      header_->version = kVersion;
+      header_->slot_count = options_.size;
+      header_->ticket_key_rotation = options_.ticket_key_rotation;
+      header_->magic = kMagic;
+    } else if (header_->magic != kMagic ||
+               header_->version != kVersion ||
+               header_->slot_count != options_.size ||
+               header_->ticket_key_rotation != options_.ticket_key_rotation) {
+      err = UV_EINVAL;
+    }
+  }
+
+  flock(fd, LOCK_UN);
+  close(fd);
+
+  if (err == UV_EINVAL) {
+    *error = std::string(path) +
+             " is in use by a session cache with different options";
+  } else if (err != 0) {
+    *error = std::string("cannot map ") + path + ": " + uv_strerror(err);
+  }
+  return err;
+#endif  // _WIN32
+}
+
+SessionCache::Slot* SessionCache::SlotAt(uint32_t index) const {
+  char* slots = reinterpret_cast<char*>(header_) +
+                RoundUp<size_t>(sizeof(Header), 64);
+  return reinterpret_cast<Slot*>(slots) + index;
+}
+
+void SessionCache::ClearLocked() {
+  for (uint32_t i = 0; i < header_->slot_count; i++)
+    SlotAt(i)->expires = 0;
+}
+
+void SessionCache::Store(const unsigned char* id,
+                         size_t id_length,
+                         const unsigned char* session,
+                         size_t session_length,
+                         uint64_t expires) {
+  if (id_length == 0 || id_length > kMaxSessionIdLength ||
+      session_length > kMaxSessionSize) {
+    return;
+  }
+
+  const uint64_t now = Now();
+  if (expires <= now)
+    return;
+
+  ScopedLock lock(this);
+  const uint32_t first = Hash(id, id_length) % (header_->slot_count / kWays);
+  Slot* match = nullptr;
+  Slot* empty = nullptr;
+  Slot* oldest = nullptr;
+  for (uint32_t i = 0; i < kWays; i++) {
+    Slot* slot = SlotAt(first * kWays + i);
+    if (slot->expires <= now) {
+      if (empty == nullptr)
+        empty = slot;
+    } else if (slot->id_length == id_length &&
+               memcmp(slot->id, id, id_length) == 0) {
+      match = slot;
+      break;
+    } else if (oldest == nullptr || slot->last_used < oldest->last_used) {
+      oldest = slot;
+    }
+  }
+
+  Slot* slot = match != nullptr ? match : empty;
+  if (slot == nullptr) {
+    slot = oldest;
+    header_->evictions++;
+  }
+
+  slot->expires = expires;
+  slot->last_used = ++header_->clock;
+  slot->id_length = static_cast<uint32_t>(id_length);
+  slot->session_length = static_cast<uint32_t>(session_length);
+  memcpy(slot->id, id, id_length);
+  memcpy(slot->session, session, session_length);
+  header_->stores++;
+}
+
+bool SessionCache::Lookup(const unsigned char* id,
+                          size_t id_length,
+                          std::vector<unsigned char>* session) {
+  if (id_length == 0 || id_length > kMaxSessionIdLength)
+    return false;
+
+  const uint64_t now = Now();
+  ScopedLock lock(this);
+  const uint32_t first = Hash(id, id_length) % (header_->slot_count / kWays);
+  for (uint32_t i = 0; i < kWays; i++) {
+    Slot* slot = SlotAt(first * kWays + i);
+    if (slot->expires > now &&
+        slot->id_length == id_length &&
+        memcmp(slot->id, id, id_length) == 0) {
+      slot->last_used = ++header_->clock;
+      session->assign(slot->session, slot->session + slot->session_length);
+      header_->hits++;
+      return true;
+    }
+  }
+
+  header_->misses++;
+  return false;
+}
+
+bool SessionCache::RotateTicketKeyLocked(uint64_t now) {
+  TicketKey key;
+  if (RAND_bytes(reinterpret_cast<unsigned char*>(&key), sizeof(key)) <= 0)
+    return false;
+
+  if (header_->ticket_key_created != 0) {
+    header_->previous_ticket_key = header_->current_ticket_key;
+    header_->has_previous_ticket_key = 1;
+    header_->ticket_key_rotations++;
+  }
+  header_->current_ticket_key = key;
+  header_->ticket_key_created = now;
+  return true;
+}
+
+int SessionCache::GetTicketKeys(TicketKey* current, TicketKey* previous) {
+  const uint64_t now = Now();
+  ScopedLock lock(this);
+  const uint64_t created = header_->ticket_key_created;
+  if (created == 0 || now - created >= options_.ticket_key_rotation) {
+    if (!RotateTicketKeyLocked(now) && created == 0)
+      return 0;
+  }
+
+  *current = header_->current_ticket_key;
+  if (!header_->has_previous_ticket_key)
+    return 1;
+  *previous = header_->previous_ticket_key;
+  return 2;
+}
+
+void SessionCache::SetTicketKey(const TicketKey& key) {
+  ScopedLock lock(this);
+  if (header_->ticket_key_created != 0) {
+    if (memcmp(&key, &header_->current_ticket_key, sizeof(key)) == 0)
+      return;
+    if (header_->has_previous_ticket_key &&
+        memcmp(&key, &header_->previous_ticket_key, sizeof(key)) == 0) {
+      return;
+    }
+    header_->previous_ticket_key = header_->current_ticket_key;
+    header_->has_previous_ticket_key = 1;
+  }
+  header_->current_ticket_key = key;
+  header_->ticket_key_created = Now();
+}
+
+SessionCache::Stats SessionCache::GetStats() {
+  const uint64_t now = Now();
+  ScopedLock lock(this);
+  Stats stats;
+  stats.hits = header_->hits;
+  stats.misses = header_->misses;
+  stats.stores = header_->stores;
+  stats.evictions = header_->evictions;
+  stats.ticket_key_rotations = header_->ticket_key_rotations;
+  stats.size = 0;
+  for (uint32_t i = 0; i < header_->slot_count; i++) {
+    if (SlotAt(i)->expires > now)
+      stats.size++;
+  }
+  return stats;
+}
+
+}  // namespace crypto
+}  // namespace node
@@ -0,0 +1,121 @@
+#ifndef SRC_NODE_CRYPTO_SESSION_CACHE_H_
+#define SRC_NODE_CRYPTO_SESSION_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "node_mutex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace node {
+namespace crypto {
+
+// A cache for server-side TLS sessions, together with the keys that are used
+// to encrypt session tickets. Caches are looked up by name, so that all
+// SecureContexts of a process (on any thread) that use the same name share
+// one cache. If a file path is given, the cache is stored in a memory mapped
+// file instead, and is shared by all processes that use the same path, e.g.
+// the workers of a cluster.
+//
+// Sessions are stored in a fixed number of slots. Each session id maps to a
+// set of four slots; when a set is full, the least recently used session in
+// it is evicted.
+class SessionCache {
+ public:
+  struct Options {
+    std::string name;
+    // Empty for a cache that is private to the process.
+    std::string path;
+    uint32_t size = 4096;
+    // In seconds, 0 disables the management of ticket keys.
+    uint32_t ticket_key_rotation = 0;
+  };
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t evictions;
+    uint64_t ticket_key_rotations;
+    uint64_t size;
+  };
+
+  // The same layout as SecureContext::ticket_key_*.
+  struct TicketKey {
+    unsigned char name[16];
+    unsigned char hmac[16];
+    unsigned char aes[16];
+  };
+
+  static const size_t kMaxSessionIdLength = 32;
+  // Larger sessions, e.g. ones that contain a long client certificate chain,
+  // are not cached.
+  static const size_t kMaxSessionSize = 4000;
+
+  // Returns the cache for `options.name`, creating it if necessary. Returns
+  // nullptr and sets `error` if the cache cannot be created, or if it exists
+  // with different options.
+  static std::shared_ptr<SessionCache> Get(const Options& options,
+                                           std::string* error);
+
+  ~SessionCache();
+  SessionCache(const SessionCache&) = delete;
+  SessionCache& operator=(const SessionCache&) = delete;
+
+  // `expires` is a Unix timestamp in seconds.
+  void Store(const unsigned char* id,
+             size_t id_length,
+             const unsigned char* session,
+             size_t session_length,
+             uint64_t expires);
+  bool Lookup(const unsigned char* id,
+              size_t id_length,
+              std::vector<unsigned char>* session);
+
+  inline bool manages_ticket_keys() const {
+    return options_.ticket_key_rotation > 0;
+  }
+
+  // Returns the current ticket key and, if the keys have been rotated, the
+  // previous one. Keys are rotated when the current key is older than the
+  // rotation interval. Returns the number of keys, or 0 if no key could be
+  // generated.
+  int GetTicketKeys(TicketKey* current, TicketKey* previous);
+  // Replaces the current ticket key. The old one becomes the previous key.
+  // Setting one of the keys that are in use again does nothing, so that it
+  // neither postpones the next rotation nor drops the previous key.
+  void SetTicketKey(const TicketKey& key);
+
+  Stats GetStats();
+  const Options& options() const { return options_; }
+
+ private:
+  struct Header;
+  struct Slot;
+  class ScopedLock;
+
+  explicit SessionCache(const Options& options);
+  int Map(std::string* error);
+  Slot* SlotAt(uint32_t index) const;
+  void ClearLocked();
+  bool RotateTicketKeyLocked(uint64_t now);
+
+  Options options_;
+  // Used instead of the mutex in `header_` for caches that are private to
+  // the process.
+  Mutex mutex_;
+  Header* header_ = nullptr;
+  size_t mapping_size_ = 0;
+  bool mapped_ = false;
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CRYPTO_SESSION_CACHE_H_
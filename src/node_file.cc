@@ -23,8 +23,11 @@
 #include "aliased_buffer.h"
 #include "memory_tracker-inl.h"
 #include "node_buffer.h"
+#include "node_mmap.h"
 #include "node_process.h"
+#include "node_affinity.h"
 #include "node_stat_watcher.h"
+#include "node_tree_walker.h"
 #include "util-inl.h"
 
 #include "tracing/trace_event.h"
@@ -33,6 +36,7 @@
 #include "stream_base-inl.h"
 #include "string_bytes.h"
 #include "string_search.h"
+#include "threadpoolwork-inl.h"
 
 #include <fcntl.h>
 #include <sys/types.h>
@@ -45,6 +49,7 @@
 # include <io.h>
 #endif
 
+#include <algorithm>
 #include <memory>
 
 namespace node {
@@ -66,6 +71,7 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
+using v8::Null;
 using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
@@ -995,6 +1001,384 @@ static void FStat(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// The smallest number of paths that a statMany() call hands to a single
+// threadpool task. Smaller slices are not worth the overhead of scheduling.
+constexpr size_t kStatManySliceSize = 64;
+
+// stat()s paths[begin, end), storing the result in the same index of
+// `stats`, or the libuv error code in the same index of `errors`.
+static void StatPaths(const std::vector<std::string>& paths,
+                      size_t begin,
+                      size_t end,
+                      std::vector<uv_stat_t>* stats,
+                      std::vector<int>* errors) {
+  for (size_t i = begin; i < end; i++) {
+    uv_fs_t req;
+    int err = uv_fs_stat(nullptr, &req, paths[i].c_str(), nullptr);
+    if (err == 0)
+      (*stats)[i] = req.statbuf;
+    (*errors)[i] = err;
+    uv_fs_req_cleanup(&req);
+  }
+}
+
+// Packs the results of a statMany() call into
+// [statsArray, errorsArray]. The stats of the i-th path are stored at
+// offset i * kFsStatsFieldsNumber, in the layout that stat() uses; paths
+// that could not be stat'ed have a non-zero entry in errorsArray instead.
+static Local<Value> StatManyResult(Environment* env,
+                                   bool use_bigint,
+                                   const std::vector<uv_stat_t>& stats,
+                                   const std::vector<int>& errors) {
+  Isolate* isolate = env->isolate();
+  const size_t count = stats.size();
+  CHECK_GT(count, 0);
+  CHECK_EQ(errors.size(), count);
+
+  Local<Value> stats_array;
+  if (use_bigint) {
+    AliasedBigUint64Array arr(isolate, count * kFsStatsFieldsNumber);
+    for (size_t i = 0; i < count; i++) {
+      if (errors[i] == 0)
+        FillStatsArray(&arr, &stats[i], i * kFsStatsFieldsNumber);
+    }
+    stats_array = arr.GetJSArray();
+  } else {
+    AliasedFloat64Array arr(isolate, count * kFsStatsFieldsNumber);
+    for (size_t i = 0; i < count; i++) {
+      if (errors[i] == 0)
+        FillStatsArray(&arr, &stats[i], i * kFsStatsFieldsNumber);
+    }
+    stats_array = arr.GetJSArray();
+  }
+
+  AliasedInt32Array errors_array(isolate, count);
+  for (size_t i = 0; i < count; i++)
+    errors_array[i] = errors[i];
+
+  Local<Value> result[] = { stats_array, errors_array.GetJSArray() };
+  return Array::New(isolate, result, arraysize(result));
+}
+
+// The state of an asynchronous statMany() call. The paths are split into
+// slices that are stat'ed by threadpool tasks of their own, and the request
+// is resolved by the task that finishes last.
+class StatManyJob {
+ public:
+  class Slice;
+
+  StatManyJob(FSReqBase* req_wrap, std::vector<std::string>&& paths)
+      : req_wrap_(req_wrap),
+        paths_(std::move(paths)),
+        stats_(paths_.size()),
+        errors_(paths_.size()) {}
+
+  static void Start(std::shared_ptr<StatManyJob> job);
+
+ private:
+  void OnSliceDone(int status);
+
+  FSReqBase* const req_wrap_;
+  const std::vector<std::string> paths_;
+  std::vector<uv_stat_t> stats_;
+  std::vector<int> errors_;
+  size_t pending_slices_ = 0;
+  int status_ = 0;
+};
+
+class StatManyJob::Slice : public ThreadPoolWork {
+ public:
+  Slice(std::shared_ptr<StatManyJob> job, size_t begin, size_t end)
+      : ThreadPoolWork(job->req_wrap_->env()),
+        job_(std::move(job)),
+        begin_(begin),
+        end_(end) {}
+
+  void DoThreadPoolWork() override {
+    // Every slice writes to a range of its own.
+    StatPaths(job_->paths_, begin_, end_, &job_->stats_, &job_->errors_);
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<Slice> self(this);
+    job_->OnSliceDone(status);
+  }
+
+ private:
+  const std::shared_ptr<StatManyJob> job_;
+  const size_t begin_;
+  const size_t end_;
+};
+
+void StatManyJob::Start(std::shared_ptr<StatManyJob> job) {
+  const size_t count = job->paths_.size();
+  size_t slices = (count + kStatManySliceSize - 1) / kStatManySliceSize;
+  slices = std::max<size_t>(
+      1, std::min<size_t>(slices, affinity::ThreadpoolSize()));
+  job->pending_slices_ = slices;
+
+  for (size_t i = 0; i < slices; i++) {
+    const size_t begin = count * i / slices;
+    const size_t end = count * (i + 1) / slices;
+    (new Slice(job, begin, end))->ScheduleWork();
+  }
+}
+
+void StatManyJob::OnSliceDone(int status) {
+  if (status < 0 && status_ == 0)
+    status_ = status;
+  if (--pending_slices_ > 0)
+    return;
+
+  Environment* env = req_wrap_->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  if (status_ < 0) {
+    req_wrap_->Reject(UVException(env->isolate(), status_, "statMany"));
+  } else {
+    req_wrap_->Resolve(
+        StatManyResult(env, req_wrap_->use_bigint(), stats_, errors_));
+  }
+  delete req_wrap_;
+}
+
+// statMany(paths, use_bigint, req | undefined)
+static void StatMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  const int argc = args.Length();
+  CHECK_GE(argc, 3);
+
+  CHECK(args[0]->IsArray());
+  Local<Array> array = args[0].As<Array>();
+  std::vector<std::string> paths(array->Length());
+  CHECK_GT(paths.size(), 0);
+  for (uint32_t i = 0; i < paths.size(); i++) {
+    Local<Value> value;
+    if (!array->Get(env->context(), i).ToLocal(&value))
+      return;
+    BufferValue path(env->isolate(), value);
+    CHECK_NOT_NULL(*path);
+    paths[i] = std::string(*path, path.length());
+  }
+
+  bool use_bigint = args[1]->IsTrue();
+  FSReqBase* req_wrap_async = GetReqWrap(env, args[2], use_bigint);
+  if (req_wrap_async != nullptr) {  // statMany(paths, use_bigint, req)
+    req_wrap_async->Init("statMany", nullptr, 0, UTF8);
+    StatManyJob::Start(
+        std::make_shared<StatManyJob>(req_wrap_async, std::move(paths)));
+    req_wrap_async->SetReturnValue(args);
+  } else {  // statMany(paths, use_bigint, undefined)
+    std::vector<uv_stat_t> stats(paths.size());
+    std::vector<int> errors(paths.size());
+    FS_SYNC_TRACE_BEGIN(statMany);
+    StatPaths(paths, 0, paths.size(), &stats, &errors);
+    FS_SYNC_TRACE_END(statMany);
+    args.GetReturnValue().Set(
+        StatManyResult(env, use_bigint, stats, errors));
+  }
+}
+
+// The size of the reads for files whose size is not known up front, such as
+// pipes or files in /proc. This matches kReadFileUnknownBufferLength in
+// lib/internal/fs/read_file_context.js.
+constexpr size_t kReadFileUnknownBufferLength = 64 * 1024;
+
+// Reads a whole file within a single threadpool task: open(), fstat(), as
+// many read()s as the file needs and close() happen back to back, instead of
+// each of them being a request of its own.
+class ReadFileJob : public ThreadPoolWork {
+ public:
+  ReadFileJob(FSReqBase* req_wrap, std::string&& path, int flags)
+      : ThreadPoolWork(req_wrap->env()),
+        req_wrap_(req_wrap),
+        path_(std::move(path)),
+        flags_(flags) {}
+
+  ~ReadFileJob() override {
+    free(data_);
+  }
+
+  void DoThreadPoolWork() override;
+  void AfterThreadPoolWork(int status) override;
+
+ private:
+  void ReadAll(uv_file fd);
+  bool Reserve(size_t capacity);
+
+  void SetError(int err, const char* syscall) {
+    if (error_ == 0) {
+      error_ = err;
+      syscall_ = syscall;
+    }
+  }
+
+  FSReqBase* const req_wrap_;
+  const std::string path_;
+  const int flags_;
+
+  char* data_ = nullptr;
+  size_t length_ = 0;
+  size_t capacity_ = 0;
+  // Set instead of data_ if the file does not fit into a Buffer.
+  uint64_t too_large_size_ = 0;
+
+  int error_ = 0;
+  const char* syscall_ = nullptr;
+};
+
+bool ReadFileJob::Reserve(size_t capacity) {
+  if (capacity <= capacity_)
+    return true;
+  char* data = UncheckedRealloc(data_, capacity);
+  if (data == nullptr)
+    return false;
+  data_ = data;
+  capacity_ = capacity;
+  return true;
+}
+
+void ReadFileJob::DoThreadPoolWork() {
+  uv_fs_t req;
+  const uv_file fd =
+      uv_fs_open(nullptr, &req, path_.c_str(), flags_, 0666, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (fd < 0)
+    return SetError(fd, "open");
+
+  ReadAll(fd);
+
+  const int err = uv_fs_close(nullptr, &req, fd, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err < 0)
+    SetError(err, "close");
+}
+
+void ReadFileJob::ReadAll(uv_file fd) {
+  uv_fs_t req;
+  int err = uv_fs_fstat(nullptr, &req, fd, nullptr);
+  const uv_stat_t stat = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  if (err < 0)
+    return SetError(err, "fstat");
+
+  // Like the JS implementation, trust the size of regular files and read
+  // everything else, including regular files that report a size of 0, until
+  // EOF.
+  const bool is_regular = (stat.st_mode & S_IFMT) == S_IFREG;
+  const uint64_t size = is_regular ? stat.st_size : 0;
+  if (size > Buffer::kMaxLength) {
+    too_large_size_ = size;
+    return;
+  }
+  const bool known_size = size > 0;
+
+  while (!known_size || length_ < size) {
+    if (known_size) {
+      if (!Reserve(size))
+        return SetError(UV_ENOMEM, "read");
+    } else if (length_ + kReadFileUnknownBufferLength > capacity_) {
+      const size_t capacity =
+          std::max(capacity_ * 2, length_ + kReadFileUnknownBufferLength);
+      if (!Reserve(capacity))
+        return SetError(UV_ENOMEM, "read");
+    }
+
+    uv_buf_t buf = uv_buf_init(data_ + length_,
+                               known_size ? size - length_ :
+                                            capacity_ - length_);
+    err = uv_fs_read(nullptr, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      return SetError(err, "read");
+    if (err == 0)
+      break;
+    length_ += err;
+    if (length_ > Buffer::kMaxLength) {
+      too_large_size_ = length_;
+      return;
+    }
+  }
+
+  // Give back what was over-allocated while reading until EOF.
+  if (length_ > 0 && length_ < capacity_) {
+    char* data = UncheckedRealloc(data_, length_);
+    if (data != nullptr) {
+      data_ = data;
+      capacity_ = length_;
+    }
+  }
+}
+
+void ReadFileJob::AfterThreadPoolWork(int status) {
+  std::unique_ptr<ReadFileJob> self(this);
+  FSReqBase* req_wrap = req_wrap_;
+  Environment* env = req_wrap->env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  if (status < 0)
+    SetError(status, "read");
+
+  if (error_ < 0) {
+    // Only errors from open() refer to the path, like in the JS version.
+    const bool is_open = strcmp(syscall_, "open") == 0;
+    req_wrap->Reject(UVException(isolate, error_, syscall_, nullptr,
+                                 is_open ? path_.c_str() : nullptr));
+  } else if (too_large_size_ > 0) {
+    // JS turns this into an ERR_FS_FILE_TOO_LARGE error.
+    req_wrap->Resolve(Number::New(isolate,
+                                  static_cast<double>(too_large_size_)));
+  } else if (req_wrap->encoding() == BUFFER) {
+    Local<Object> buffer;
+    MaybeLocal<Object> maybe_buffer = length_ > 0 ?
+        Buffer::New(env, data_, length_, true) : Buffer::New(env, 0);
+    if (maybe_buffer.ToLocal(&buffer)) {
+      data_ = nullptr;  // The Buffer has taken ownership.
+      req_wrap->Resolve(buffer);
+    } else {
+      req_wrap->Reject(UVException(isolate, UV_ENOMEM, "read"));
+    }
+  } else {
+    Local<Value> error;
+    Local<Value> string;
+    if (StringBytes::Encode(isolate, data_, length_, req_wrap->encoding(),
+                            &error).ToLocal(&string)) {
+      req_wrap->Resolve(string);
+    } else {
+      req_wrap->Reject(error);
+    }
+  }
+  delete req_wrap;
+}
+
+// readFile(path, flags, encoding, req)
+static void ReadFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  const int argc = args.Length();
+  CHECK_GE(argc, 4);
+
+  BufferValue path(isolate, args[0]);
+  CHECK_NOT_NULL(*path);
+
+  CHECK(args[1]->IsInt32());
+  const int flags = args[1].As<Int32>()->Value();
+
+  const enum encoding encoding = ParseEncoding(isolate, args[2], BUFFER);
+
+  FSReqBase* req_wrap_async = GetReqWrap(env, args[3]);
+  CHECK_NOT_NULL(req_wrap_async);
+  req_wrap_async->Init("readFile", nullptr, 0, encoding);
+  (new ReadFileJob(req_wrap_async,
+                   std::string(*path, path.length()),
+                   flags))->ScheduleWork();
+  req_wrap_async->SetReturnValue(args);
+}
+
 static void Symlink(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   Isolate* isolate = env->isolate();
@@ -1548,6 +1932,240 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+DirHandle::DirHandle(Environment* env, Local<Object> obj, uv_dir_t* dir)
+    : AsyncWrap(env, obj, AsyncWrap::PROVIDER_DIRHANDLE),
+      dir_(dir) {
+  MakeWeak();
+}
+
+DirHandle* DirHandle::New(Environment* env, uv_dir_t* dir) {
+  Local<Object> obj;
+  if (!env->dir_instance_template()
+          ->NewInstance(env->context())
+          .ToLocal(&obj)) {
+    uv_fs_t req;
+    uv_fs_closedir(nullptr, &req, dir, nullptr);
+    uv_fs_req_cleanup(&req);
+    return nullptr;
+  }
+  return new DirHandle(env, obj, dir);
+}
+
+void DirHandle::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+}
+
+DirHandle::~DirHandle() {
+  GCClose();         // Close synchronously and emit warning
+  CHECK(closed_);    // We have to be closed at the point
+}
+
+void DirHandle::SetBufferSize(size_t size) {
+  CHECK_GT(size, 0);
+  dirents_.resize(size);
+  dir_->dirents = dirents_.data();
+  dir_->nentries = dirents_.size();
+}
+
+// Close the directory stream if it hasn't already been closed. A process
+// warning will be emitted using a SetImmediate to avoid calling back to
+// JS during GC. If closing fails at this point, a fatal exception will crash
+// the process immediately.
+inline void DirHandle::GCClose() {
+  if (closed_) return;
+  uv_fs_t req;
+  int ret = uv_fs_closedir(nullptr, &req, dir_, nullptr);
+  uv_fs_req_cleanup(&req);
+  closed_ = true;
+
+  if (ret < 0) {
+    // Do not unref this
+    env()->SetImmediate([](Environment* env, void* data) {
+      // This exception will end up being fatal for the process because
+      // it is being thrown from within the SetImmediate handler and
+      // there is no JS stack to bubble it to.
+      HandleScope handle_scope(env->isolate());
+      env->ThrowUVException(static_cast<int>(reinterpret_cast<intptr_t>(data)),
+                            "closedir",
+                            "Closing directory handle on garbage collection "
+                            "failed");
+    }, reinterpret_cast<void*>(static_cast<intptr_t>(ret)));
+    return;
+  }
+
+  // Not explicitly closing a directory handle is a bug, so be noisy about it.
+  env()->SetUnrefImmediate([](Environment* env, void* data) {
+    ProcessEmitWarning(env, "Closing directory handle on garbage collection");
+  }, nullptr);
+}
+
+// Returns [names, types] for the first `count` entries of `dirents`, in the
+// same format as readdir() with `withTypes`.
+static MaybeLocal<Array> DirentsToArray(Environment* env,
+                                        const uv_dirent_t* dirents,
+                                        size_t count,
+                                        enum encoding encoding,
+                                        Local<Value>* error) {
+  Isolate* isolate = env->isolate();
+  MaybeStackBuffer<Local<Value>, 64> name_v(count);
+  MaybeStackBuffer<Local<Value>, 64> type_v(count);
+
+  for (size_t i = 0; i < count; i++) {
+    MaybeLocal<Value> filename =
+        StringBytes::Encode(isolate, dirents[i].name, encoding, error);
+    if (filename.IsEmpty())
+      return MaybeLocal<Array>();
+    name_v[i] = filename.ToLocalChecked();
+    type_v[i] = Integer::New(isolate, dirents[i].type);
+  }
+
+  Local<Value> result[] = {
+    Array::New(isolate, name_v.out(), count),
+    Array::New(isolate, type_v.out(), count)
+  };
+  return Array::New(isolate, result, arraysize(result));
+}
+
+void AfterDirRead(uv_fs_t* req) {
+  FSReqBase* req_wrap = FSReqBase::from_req(req);
+  FSReqAfterScope after(req_wrap, req);
+
+  if (!after.Proceed()) {
+    return;
+  }
+
+  Environment* env = req_wrap->env();
+  if (req->result == 0) {  // End of the directory.
+    return req_wrap->Resolve(Null(env->isolate()));
+  }
+
+  uv_dir_t* dir = static_cast<uv_dir_t*>(req->ptr);
+  Local<Value> error;
+  Local<Array> entries;
+  if (!DirentsToArray(env, dir->dirents, req->result, req_wrap->encoding(),
+                      &error).ToLocal(&entries)) {
+    return req_wrap->Reject(error);
+  }
+  req_wrap->Resolve(entries);
+}
+
+void DirHandle::Read(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  const int argc = args.Length();
+  CHECK_GE(argc, 3);
+
+  DirHandle* handle;
+  ASSIGN_OR_RETURN_UNWRAP(&handle, args.Holder());
+  CHECK(!handle->closed_);
+
+  const enum encoding encoding = ParseEncoding(isolate, args[0], UTF8);
+
+  CHECK(args[1]->IsUint32());
+  handle->SetBufferSize(args[1].As<Uint32>()->Value());
+
+  FSReqBase* req_wrap_async = GetReqWrap(env, args[2]);
+  if (req_wrap_async != nullptr) {  // read(encoding, bufferSize, req)
+    AsyncCall(env, req_wrap_async, args, "readdir", encoding,
+              AfterDirRead, uv_fs_readdir, handle->dir());
+  } else {  // read(encoding, bufferSize, undefined, ctx)
+    CHECK_EQ(argc, 4);
+    FSReqWrapSync req_wrap_sync;
+    FS_SYNC_TRACE_BEGIN(readdir);
+    int err = SyncCall(env, args[3], &req_wrap_sync, "readdir",
+                       uv_fs_readdir, handle->dir());
+    FS_SYNC_TRACE_END(readdir);
+    if (err < 0) {
+      return;  // syscall failed, no need to continue, error info is in ctx
+    }
+
+    if (err == 0) {  // End of the directory.
+      return args.GetReturnValue().SetNull();
+    }
+
+    Local<Value> error;
+    Local<Array> entries;
+    if (!DirentsToArray(env, handle->dir()->dirents, err, encoding,
+                        &error).ToLocal(&entries)) {
+      Local<Object> ctx = args[3].As<Object>();
+      ctx->Set(env->context(), env->error_string(), error).Check();
+      return;
+    }
+    args.GetReturnValue().Set(entries);
+  }
+}
+
+void DirHandle::Close(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  const int argc = args.Length();
+  CHECK_GE(argc, 1);
+
+  DirHandle* handle;
+  ASSIGN_OR_RETURN_UNWRAP(&handle, args.Holder());
+  CHECK(!handle->closed_);
+  // uv_fs_closedir() releases the stream even if it fails.
+  handle->closed_ = true;
+
+  FSReqBase* req_wrap_async = GetReqWrap(env, args[0]);
+  if (req_wrap_async != nullptr) {  // close(req)
+    AsyncCall(env, req_wrap_async, args, "closedir", UTF8, AfterNoArgs,
+              uv_fs_closedir, handle->dir());
+  } else {  // close(undefined, ctx)
+    CHECK_EQ(argc, 2);
+    FSReqWrapSync req_wrap_sync;
+    FS_SYNC_TRACE_BEGIN(closedir);
+    SyncCall(env, args[1], &req_wrap_sync, "closedir", uv_fs_closedir,
+             handle->dir());
+    FS_SYNC_TRACE_END(closedir);
+  }
+}
+
+void AfterOpenDir(uv_fs_t* req) {
+  FSReqBase* req_wrap = FSReqBase::from_req(req);
+  FSReqAfterScope after(req_wrap, req);
+
+  if (after.Proceed()) {
+    DirHandle* handle = DirHandle::New(req_wrap->env(),
+                                       static_cast<uv_dir_t*>(req->ptr));
+    if (handle == nullptr) return;
+    req_wrap->Resolve(handle->object());
+  }
+}
+
+static void OpenDir(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  const int argc = args.Length();
+  CHECK_GE(argc, 1);
+
+  BufferValue path(isolate, args[0]);
+  CHECK_NOT_NULL(*path);
+
+  FSReqBase* req_wrap_async = GetReqWrap(env, args[1]);
+  if (req_wrap_async != nullptr) {  // opendir(path, req)
+    AsyncCall(env, req_wrap_async, args, "opendir", UTF8, AfterOpenDir,
+              uv_fs_opendir, *path);
+  } else {  // opendir(path, undefined, ctx)
+    CHECK_EQ(argc, 3);
+    FSReqWrapSync req_wrap_sync;
+    FS_SYNC_TRACE_BEGIN(opendir);
+    int result = SyncCall(env, args[2], &req_wrap_sync, "opendir",
+                          uv_fs_opendir, *path);
+    FS_SYNC_TRACE_END(opendir);
+    if (result < 0) {
+      return;  // error info is in ctx
+    }
+
+    DirHandle* handle =
+        DirHandle::New(env, static_cast<uv_dir_t*>(req_wrap_sync.req.ptr));
+    if (handle == nullptr) return;
+    args.GetReturnValue().Set(handle->object());
+  }
+}
+
 static void Open(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2169,11 +2787,14 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "rmdir", RMDir);
   env->SetMethod(target, "mkdir", MKDir);
   env->SetMethod(target, "readdir", ReadDir);
+  env->SetMethod(target, "opendir", OpenDir);
   env->SetMethod(target, "internalModuleReadJSON", InternalModuleReadJSON);
   env->SetMethod(target, "internalModuleStat", InternalModuleStat);
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
+  env->SetMethod(target, "statMany", StatMany);
+  env->SetMethod(target, "readFile", ReadFile);
   env->SetMethod(target, "link", Link);
   env->SetMethod(target, "symlink", Symlink);
   env->SetMethod(target, "readlink", ReadLink);
@@ -2211,6 +2832,8 @@ void Initialize(Local<Object> target,
               env->fs_stats_field_bigint_array()->GetJSArray()).Check();
 
   StatWatcher::Initialize(env, target);
+  TreeWalker::Initialize(env, target);
+  MappedRegion::Initialize(env, target);
 
   // Create FunctionTemplate for FSReqCallback
   Local<FunctionTemplate> fst = env->NewFunctionTemplate(NewFSReqCallback);
@@ -2262,6 +2885,21 @@ void Initialize(Local<Object> target,
       .Check();
   env->set_fd_constructor_template(fdt);
 
+  // Create FunctionTemplate for DirHandle
+  Local<FunctionTemplate> dir = env->NewFunctionTemplate(DirHandle::New);
+  dir->Inherit(AsyncWrap::GetConstructorTemplate(env));
+  env->SetProtoMethod(dir, "read", DirHandle::Read);
+  env->SetProtoMethod(dir, "close", DirHandle::Close);
+  Local<ObjectTemplate> dirt = dir->InstanceTemplate();
+  dirt->SetInternalFieldCount(1);
+  Local<String> dirString = FIXED_ONE_BYTE_STRING(isolate, "DirHandle");
+  dir->SetClassName(dirString);
+  target
+      ->Set(context, dirString,
+            dir->GetFunction(env->context()).ToLocalChecked())
+      .Check();
+  env->set_dir_instance_template(dirt);
+
   // Create FunctionTemplate for FileHandle::CloseReq
   Local<FunctionTemplate> fdclose = FunctionTemplate::New(isolate);
   fdclose->SetClassName(FIXED_ONE_BYTE_STRING(isolate,
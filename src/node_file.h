@@ -468,6 +468,48 @@ class FileHandle : public AsyncWrap, public StreamBase {
   std::unique_ptr<FileHandleReadWrap> current_read_ = nullptr;
 };
 
+// A wrapper for a directory stream from uv_fs_opendir(). Entries are read in
+// batches of a size that is chosen by each read() call, so that directories
+// can be listed without holding all of their entries in memory at once. The
+// stream is closed when the object is garbage collected.
+class DirHandle : public AsyncWrap {
+ public:
+  static DirHandle* New(Environment* env, uv_dir_t* dir);
+  ~DirHandle() override;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Read(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  uv_dir_t* dir() { return dir_; }
+
+  void MemoryInfo(MemoryTracker* tracker) const override {
+    tracker->TrackFieldWithSize("dirents",
+                                dirents_.capacity() * sizeof(uv_dirent_t));
+  }
+
+  SET_MEMORY_INFO_NAME(DirHandle)
+  SET_SELF_SIZE(DirHandle)
+
+  DirHandle(const DirHandle&) = delete;
+  DirHandle& operator=(const DirHandle&) = delete;
+  DirHandle(const DirHandle&&) = delete;
+  DirHandle& operator=(const DirHandle&&) = delete;
+
+ private:
+  DirHandle(Environment* env, v8::Local<v8::Object> obj, uv_dir_t* dir);
+
+  // Sets up the buffer that the next uv_fs_readdir() call fills.
+  void SetBufferSize(size_t size);
+
+  // Synchronous close that emits a warning
+  void GCClose();
+
+  uv_dir_t* dir_;
+  std::vector<uv_dirent_t> dirents_;
+  bool closed_ = false;
+};
+
 int MKDirpSync(uv_loop_t* loop,
                uv_fs_t* req,
                const std::string& path,
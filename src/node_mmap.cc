@@ -0,0 +1,319 @@
+#include "node_mmap.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "node_mutex.h"
+#include "sharedarraybuffer_metadata.h"
+#include "util-inl.h"
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#include <map>
+
+namespace node {
+namespace fs {
+
+using v8::ArrayBuffer;
+using v8::ArrayBufferView;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Int32;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::SharedArrayBuffer;
+using v8::Uint32;
+using v8::Value;
+using worker::SharedArrayBufferMetadata;
+using worker::SharedArrayBufferMetadataReference;
+
+namespace {
+
+// The values of the `advice` argument of madvise(), in the order of the
+// names in lib/fs.js.
+enum MadviseAdvice {
+  kAdviceNormal,
+  kAdviceRandom,
+  kAdviceSequential,
+  kAdviceWillNeed,
+  kAdviceDontNeed
+};
+
+// All live mappings, by the address of their data.
+Mutex registry_mutex;
+std::map<const char*, MappedRegion*> registry;
+
+// Returns the mapping that contains [data, data + length), or nullptr. The
+// caller needs to hold registry_mutex.
+MappedRegion* FindRegion(const char* data, size_t length) {
+  auto it = registry.upper_bound(data);
+  if (it == registry.begin()) return nullptr;
+  MappedRegion* region = (--it)->second;
+  if (data + length > region->data() + region->length()) return nullptr;
+  return region;
+}
+
+size_t MappingGranularity() {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+#else
+  return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+void SetError(Environment* env,
+              Local<Value> ctx,
+              int err,
+              const char* syscall) {
+  Local<Context> context = env->context();
+  Local<Object> ctx_obj = ctx.As<Object>();
+  Isolate* isolate = env->isolate();
+  ctx_obj->Set(context,
+               env->errno_string(),
+               Integer::New(isolate, err)).Check();
+  ctx_obj->Set(context,
+               env->syscall_string(),
+               OneByteString(isolate, syscall)).Check();
+}
+
+}  // anonymous namespace
+
+
+int MappedRegion::Map(uv_file fd,
+                      int64_t offset,
+                      size_t length,
+                      bool read_only,
+                      bool shared,
+                      std::unique_ptr<MappedRegion>* region) {
+  CHECK_GE(offset, 0);
+  CHECK_GT(length, 0);
+
+  // Accessing a mapping beyond the end of the file raises SIGBUS, so refuse
+  // to create such mappings in the first place.
+  uv_fs_t req;
+  int err = uv_fs_fstat(nullptr, &req, fd, nullptr);
+  const uint64_t size = req.statbuf.st_size;
+  uv_fs_req_cleanup(&req);
+  if (err < 0) return err;
+  if (static_cast<uint64_t>(offset) + length > size) return UV_EINVAL;
+
+  // Mappings have to start at a multiple of the page size (or, on Windows,
+  // the allocation granularity).
+  const size_t delta = offset % MappingGranularity();
+  const int64_t base_offset = offset - delta;
+  const size_t base_length = length + delta;
+
+#ifdef _WIN32
+  HANDLE file = reinterpret_cast<HANDLE>(uv_get_osfhandle(fd));
+  if (file == INVALID_HANDLE_VALUE) return UV_EBADF;
+
+  DWORD protect =
+      read_only ? PAGE_READONLY : shared ? PAGE_READWRITE : PAGE_WRITECOPY;
+  HANDLE mapping = CreateFileMappingW(file, nullptr, protect, 0, 0, nullptr);
+  if (mapping == nullptr) return uv_translate_sys_error(GetLastError());
+
+  DWORD access =
+      read_only ? FILE_MAP_READ : shared ? FILE_MAP_WRITE : FILE_MAP_COPY;
+  void* base = MapViewOfFile(mapping,
+                             access,
+                             static_cast<DWORD>(base_offset >> 32),
+                             static_cast<DWORD>(base_offset & 0xFFFFFFFF),
+                             base_length);
+  const DWORD error = GetLastError();
+  // The view keeps the mapping object alive.
+  CloseHandle(mapping);
+  if (base == nullptr) return uv_translate_sys_error(error);
+#else
+  const int prot = read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+  const int flags = shared ? MAP_SHARED : MAP_PRIVATE;
+  void* base = mmap(nullptr, base_length, prot, flags, fd, base_offset);
+  if (base == MAP_FAILED) return -errno;
+#endif
+
+  region->reset(new MappedRegion());
+  (*region)->base_ = base;
+  (*region)->base_length_ = base_length;
+  (*region)->data_ = static_cast<char*>(base) + delta;
+  (*region)->length_ = length;
+  return 0;
+}
+
+
+MappedRegion::~MappedRegion() {
+#ifdef _WIN32
+  CHECK(UnmapViewOfFile(base_));
+#else
+  CHECK_EQ(munmap(base_, base_length_), 0);
+#endif
+}
+
+
+void MappedRegion::ReleaseFile() {
+#ifndef _WIN32
+  // MAP_FIXED replaces the pages atomically, so the range is never unmapped
+  // in between, and cannot be taken by another mapping.
+  void* base = mmap(base_, base_length_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+  CHECK_EQ(base, base_);
+#endif
+}
+
+
+void MappedRegion::FreeArrayBuffer(char* data, void* hint) {
+  MappedRegion* region = static_cast<MappedRegion*>(hint);
+  {
+    Mutex::ScopedLock lock(registry_mutex);
+    // The mapping may have been released through fs.munmap() already.
+    auto it = registry.find(region->data_);
+    if (it != registry.end() && it->second == region)
+      registry.erase(it);
+  }
+  delete region;
+}
+
+
+void MappedRegion::FreeSharedArrayBuffer(void* data,
+                                         size_t length,
+                                         void* hint) {
+  MappedRegion* region = static_cast<MappedRegion*>(hint);
+  {
+    Mutex::ScopedLock lock(registry_mutex);
+    registry.erase(region->data_);
+  }
+  delete region;
+}
+
+
+void MappedRegion::Mmap(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK_EQ(args.Length(), 7);
+
+  CHECK(args[0]->IsInt32());
+  const uv_file fd = args[0].As<Int32>()->Value();
+  CHECK(args[1]->IsNumber());
+  const int64_t offset = args[1].As<Integer>()->Value();
+  CHECK(args[2]->IsUint32());
+  const size_t length = args[2].As<Uint32>()->Value();
+  CHECK_LE(length, Buffer::kMaxLength);
+  const bool read_only = args[3]->IsTrue();
+  const bool shared = args[4]->IsTrue();
+  const bool use_shared_array_buffer = args[5]->IsTrue();
+
+  std::unique_ptr<MappedRegion> region;
+  int err = Map(fd, offset, length, read_only, shared, &region);
+  if (err != 0) return SetError(env, args[6], err, "mmap");
+
+  char* data = region->data_;
+  region->releasable_ = !use_shared_array_buffer;
+  {
+    Mutex::ScopedLock lock(registry_mutex);
+    registry[data] = region.get();
+  }
+
+  if (use_shared_array_buffer) {
+    SharedArrayBufferMetadataReference metadata =
+        SharedArrayBufferMetadata::ForExternalMemory(
+            data, length, FreeSharedArrayBuffer, region.release());
+    Local<SharedArrayBuffer> sab;
+    if (metadata->GetSharedArrayBuffer(env, env->context()).ToLocal(&sab))
+      args.GetReturnValue().Set(sab);
+    return;
+  }
+
+  // From here on, the ArrayBuffer owns the mapping and releases it through
+  // FreeArrayBuffer().
+  Local<Object> buffer;
+  if (Buffer::New(env, data, length, FreeArrayBuffer,
+                  region.release()).ToLocal(&buffer)) {
+    args.GetReturnValue().Set(buffer.As<ArrayBufferView>()->Buffer());
+  }
+}
+
+
+void MappedRegion::Munmap(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsArrayBufferView());
+  Local<ArrayBuffer> ab = args[0].As<ArrayBufferView>()->Buffer();
+  const char* data = static_cast<const char*>(ab->GetContents().Data());
+
+  MappedRegion* region;
+  {
+    Mutex::ScopedLock lock(registry_mutex);
+    auto it = registry.find(data);
+    if (it == registry.end() ||
+        !it->second->releasable_ ||
+        !ab->IsDetachable() ||
+        ab->ByteLength() != it->second->length_) {
+      return args.GetReturnValue().Set(false);
+    }
+    region = it->second;
+    registry.erase(it);
+  }
+
+  // Make the memory inaccessible from JS. Native operations that are still
+  // pending keep the ArrayBuffer alive, and with it the memory, which
+  // FreeArrayBuffer() unmaps.
+  ab->Detach();
+  region->ReleaseFile();
+  args.GetReturnValue().Set(true);
+}
+
+
+void MappedRegion::Madvise(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK_EQ(args.Length(), 3);
+
+  SPREAD_BUFFER_ARG(args[0], view);
+  CHECK(args[1]->IsUint32());
+  const uint32_t advice = args[1].As<Uint32>()->Value();
+
+  Mutex::ScopedLock lock(registry_mutex);
+  if (view_length == 0 || FindRegion(view_data, view_length) == nullptr)
+    return args.GetReturnValue().Set(false);
+
+#ifndef _WIN32
+  // The advice has to start at a page boundary. Mappings themselves do, so
+  // this stays within the mapping.
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const uintptr_t start = reinterpret_cast<uintptr_t>(view_data);
+  const uintptr_t aligned_start = start - start % page_size;
+
+  int posix_advice;
+  switch (advice) {
+    case kAdviceNormal: posix_advice = POSIX_MADV_NORMAL; break;
+    case kAdviceRandom: posix_advice = POSIX_MADV_RANDOM; break;
+    case kAdviceSequential: posix_advice = POSIX_MADV_SEQUENTIAL; break;
+    case kAdviceWillNeed: posix_advice = POSIX_MADV_WILLNEED; break;
+    case kAdviceDontNeed: posix_advice = POSIX_MADV_DONTNEED; break;
+    default: UNREACHABLE();
+  }
+
+  const int err = posix_madvise(reinterpret_cast<void*>(aligned_start),
+                                view_length + (start - aligned_start),
+                                posix_advice);
+  if (err != 0) SetError(env, args[2], -err, "madvise");
+#else
+  // There is no equivalent of madvise() on Windows, and the advice is only a
+  // hint anyway.
+  CHECK_LE(advice, kAdviceDontNeed);
+  USE(env);
+#endif
+  args.GetReturnValue().Set(true);
+}
+
+
+void MappedRegion::Initialize(Environment* env, Local<Object> target) {
+  env->SetMethod(target, "mmap", Mmap);
+  env->SetMethod(target, "munmap", Munmap);
+  env->SetMethod(target, "madvise", Madvise);
+}
+
+}  // namespace fs
+}  // namespace node
@@ -0,0 +1,88 @@
+#ifndef SRC_NODE_MMAP_H_
+#define SRC_NODE_MMAP_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "env.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace node {
+namespace fs {
+
+// A part of a file that is mapped into memory, and backs a Buffer returned by
+// fs.mmap().
+//
+// Mappings are either owned by an ArrayBuffer, in which case they are
+// unmapped when it is garbage collected, or by a SharedArrayBuffer, in which
+// case they can be posted to Workers without copying and are unmapped once no
+// thread refers to them anymore. All live mappings are kept in a process-wide
+// registry, so that Buffers can be checked for whether they point into one.
+//
+// fs.munmap() releases the file of a mapping that is owned by an ArrayBuffer
+// right away, but the memory stays reserved until the ArrayBuffer is garbage
+// collected, as native operations that are still pending may use it.
+class MappedRegion {
+ public:
+  // Registers the mmap(), munmap() and madvise() bindings on `target`.
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  // Maps `length` bytes of `fd`, starting at `offset`. Returns 0 or a libuv
+  // error code; UV_EINVAL if the range extends past the end of the file.
+  static int Map(uv_file fd,
+                 int64_t offset,
+                 size_t length,
+                 bool read_only,
+                 bool shared,
+                 std::unique_ptr<MappedRegion>* region);
+
+  ~MappedRegion();
+
+  char* data() const { return data_; }
+  size_t length() const { return length_; }
+
+  // Replaces the mapping with anonymous memory, except on Windows, where it
+  // is kept until the region is deleted.
+  void ReleaseFile();
+
+  MappedRegion(const MappedRegion&) = delete;
+  MappedRegion& operator=(const MappedRegion&) = delete;
+
+ private:
+  MappedRegion() = default;
+
+  // mmap(fd, offset, length, readOnly, shared, sharedArrayBuffer, ctx)
+  static void Mmap(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // munmap(buffer), returns false if `buffer` is not backed by a mapping
+  // that can be released explicitly.
+  static void Munmap(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // madvise(buffer, advice, ctx), returns false if `buffer` does not point
+  // into a mapping.
+  static void Madvise(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // The callbacks that release mappings owned by ArrayBuffers and
+  // SharedArrayBuffers, respectively. `hint` is the MappedRegion.
+  static void FreeArrayBuffer(char* data, void* hint);
+  static void FreeSharedArrayBuffer(void* data, size_t length, void* hint);
+
+  // The mapping starts at an aligned offset of the file, which may be before
+  // the requested one.
+  void* base_ = nullptr;
+  size_t base_length_ = 0;
+  char* data_ = nullptr;
+  size_t length_ = 0;
+
+  // Whether the mapping is owned by an ArrayBuffer, and can be released
+  // through fs.munmap().
+  bool releasable_ = false;
+};
+
+}  // namespace fs
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_MMAP_H_
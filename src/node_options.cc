@@ -2,6 +2,7 @@
 #include "node_options-inl.h"
 
 #include "env-inl.h"
+#include "node_affinity.h"
 #include "node_binding.h"
 
 #include <cstdlib>  // strtoul, errno
@@ -62,6 +63,25 @@ void DebugOptions::CheckOptions(std::vector<std::string>* errors) {
 }
 
 void PerProcessOptions::CheckOptions(std::vector<std::string>* errors) {
+  const std::pair<const char*, const std::string*> cpu_options[] = {
+    { "--main-thread-cpus", &main_thread_cpus },
+    { "--platform-thread-cpus", &platform_thread_cpus },
+    { "--threadpool-cpus", &threadpool_cpus }
+  };
+  for (const auto& option : cpu_options) {
+    if (option.second->empty())
+      continue;
+    affinity::CpuSet cpus;
+    std::string error;
+    if (!affinity::IsSupported()) {
+      errors->push_back(std::string(option.first) +
+                        " is not supported on this platform");
+    } else if (!affinity::ParseCpuSet(*option.second, &cpus, &error)) {
+      errors->push_back(std::string("invalid value for ") + option.first +
+                        ": " + error);
+    }
+  }
+
 #if HAVE_OPENSSL
   if (use_openssl_ca && use_bundled_ca) {
     errors->push_back("either --use-openssl-ca or --use-bundled-ca can be "
@@ -156,6 +176,10 @@ void EnvironmentOptions::CheckOptions(std::vector<std::string>* errors) {
     errors->push_back("invalid value for --http-parser");
   }
 
+  if (dns_lookup_mode != "getaddrinfo" && dns_lookup_mode != "cares") {
+    errors->push_back("invalid value for --dns-lookup-mode");
+  }
+
   if (!unhandled_rejections.empty() &&
       unhandled_rejections != "strict" &&
       unhandled_rejections != "warn" &&
@@ -427,10 +451,22 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "profile generated with --heap-prof. (default: 512 * 1024)",
             &EnvironmentOptions::heap_prof_interval);
 #endif  // HAVE_INSPECTOR
+  AddOption("--dns-lookup-mode",
+            "resolve host names for dns.lookup() with 'getaddrinfo' on the "
+            "threadpool or with 'cares' on the event loop "
+            "(default: getaddrinfo)",
+            &EnvironmentOptions::dns_lookup_mode,
+            kAllowedInEnvironment);
   AddOption("--redirect-warnings",
             "write warnings to file instead of stderr",
             &EnvironmentOptions::redirect_warnings,
             kAllowedInEnvironment);
+  AddOption("--stream-read-slab-size",
+            "read network and pipe data into shared slabs of this size in "
+            "bytes instead of allocating memory for each read "
+            "(default: 0, disabled)",
+            &EnvironmentOptions::stream_read_slab_size,
+            kAllowedInEnvironment);
   AddOption("--throw-deprecation",
             "throw an exception on deprecations",
             &EnvironmentOptions::throw_deprecation,
@@ -606,6 +642,21 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "set V8's thread pool size",
             &PerProcessOptions::v8_thread_pool_size,
             kAllowedInEnvironment);
+  AddOption("--main-thread-cpus",
+            "restrict the main thread to a list of CPUs (e.g. 0-3,8) or "
+            "NUMA nodes (e.g. node:0)",
+            &PerProcessOptions::main_thread_cpus,
+            kAllowedInEnvironment);
+  AddOption("--platform-thread-cpus",
+            "restrict V8's platform worker threads to a list of CPUs or "
+            "NUMA nodes",
+            &PerProcessOptions::platform_thread_cpus,
+            kAllowedInEnvironment);
+  AddOption("--threadpool-cpus",
+            "restrict the threads of libuv's threadpool to a list of CPUs "
+            "or NUMA nodes",
+            &PerProcessOptions::threadpool_cpus,
+            kAllowedInEnvironment);
   AddOption("--zero-fill-buffers",
             "automatically zero-fill all newly allocated Buffer and "
             "SlowBuffer instances",
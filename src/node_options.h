@@ -112,6 +112,7 @@ class EnvironmentOptions : public Options {
   std::string heap_snapshot_signal;
   std::string http_parser = "llhttp";
   uint64_t http_server_default_timeout = 120000;
+  uint64_t stream_read_slab_size = 0;
   bool no_deprecation = false;
   bool no_force_async_hooks_checks = false;
   bool no_warnings = false;
@@ -131,6 +132,7 @@ class EnvironmentOptions : public Options {
   uint64_t heap_prof_interval = kDefaultHeapProfInterval;
   bool heap_prof = false;
 #endif  // HAVE_INSPECTOR
+  std::string dns_lookup_mode = "getaddrinfo";
   std::string redirect_warnings;
   bool throw_deprecation = false;
   bool trace_deprecation = false;
@@ -194,6 +196,9 @@ class PerProcessOptions : public Options {
   std::string trace_event_file_pattern = "node_trace.${rotation}.log";
   uint64_t max_http_header_size = 8 * 1024;
   int64_t v8_thread_pool_size = 4;
+  std::string main_thread_cpus;
+  std::string platform_thread_cpus;
+  std::string threadpool_cpus;
   bool zero_fill_all_buffers = false;
   bool debug_arraybuffer_allocations = false;
 
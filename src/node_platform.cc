@@ -24,6 +24,7 @@ struct PlatformWorkerData {
   ConditionVariable* platform_workers_ready;
   int* pending_platform_workers;
   int id;
+  const affinity::CpuSet* cpus;
 };
 
 static void PlatformWorkerThread(void* data) {
@@ -34,6 +35,12 @@ static void PlatformWorkerThread(void* data) {
   TRACE_EVENT_METADATA1("__metadata", "thread_name", "name",
                         "PlatformWorkerThread");
 
+  if (!worker_data->cpus->empty()) {
+    affinity::PinCurrentThread(
+        "platform worker " + std::to_string(worker_data->id),
+        *worker_data->cpus);
+  }
+
   // Notify the main thread that the platform worker is ready.
   {
     Mutex::ScopedLock lock(*worker_data->platform_workers_mutex);
@@ -45,6 +52,9 @@ static void PlatformWorkerThread(void* data) {
     task->Run();
     pending_worker_tasks->NotifyOfCompletion();
   }
+
+  if (!worker_data->cpus->empty())
+    affinity::ForgetCurrentThread();
 }
 
 }  // namespace
@@ -165,7 +175,9 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
   std::unordered_set<uv_timer_t*> timers_;
 };
 
-WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size) {
+WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(
+    int thread_pool_size, const affinity::CpuSet& thread_cpus)
+    : thread_cpus_(thread_cpus) {
   Mutex platform_workers_mutex;
   ConditionVariable platform_workers_ready;
 
@@ -179,7 +191,7 @@ WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size) {
   for (int i = 0; i < thread_pool_size; i++) {
     PlatformWorkerData* worker_data = new PlatformWorkerData{
       &pending_worker_tasks_, &platform_workers_mutex,
-      &platform_workers_ready, &pending_platform_workers, i
+      &platform_workers_ready, &pending_platform_workers, i, &thread_cpus_
     };
     std::unique_ptr<uv_thread_t> t { new uv_thread_t() };
     if (uv_thread_create(t.get(), PlatformWorkerThread,
@@ -196,8 +208,9 @@ WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size) {
   }
 }
 
-void WorkerThreadsTaskRunner::PostTask(std::unique_ptr<Task> task) {
-  pending_worker_tasks_.Push(std::move(task));
+void WorkerThreadsTaskRunner::PostTask(std::unique_ptr<Task> task,
+                                       TaskPriority priority) {
+  pending_worker_tasks_.Push(std::move(task), priority);
 }
 
 void WorkerThreadsTaskRunner::PostDelayedTask(std::unique_ptr<Task> task,
@@ -228,6 +241,11 @@ PerIsolatePlatformData::PerIsolatePlatformData(
   CHECK_EQ(0, uv_async_init(loop, flush_tasks_, FlushTasks));
   flush_tasks_->data = static_cast<void*>(this);
   uv_unref(reinterpret_cast<uv_handle_t*>(flush_tasks_));
+
+  idle_period_ = new uv_prepare_t();
+  CHECK_EQ(0, uv_prepare_init(loop, idle_period_));
+  idle_period_->data = static_cast<void*>(this);
+  uv_unref(reinterpret_cast<uv_handle_t*>(idle_period_));
 }
 
 void PerIsolatePlatformData::FlushTasks(uv_async_t* handle) {
@@ -236,12 +254,21 @@ void PerIsolatePlatformData::FlushTasks(uv_async_t* handle) {
 }
 
 void PerIsolatePlatformData::PostIdleTask(std::unique_ptr<v8::IdleTask> task) {
-  UNREACHABLE();
+  CHECK_NOT_NULL(flush_tasks_);
+  idle_tasks_.Push(std::move(task));
+  // Idle tasks may be posted from other threads, so starting the prepare
+  // handle is left to FlushForegroundTasksInternal().
+  uv_async_send(flush_tasks_);
 }
 
 void PerIsolatePlatformData::PostTask(std::unique_ptr<Task> task) {
+  PostTask(std::move(task), TaskPriority::kUserVisible);
+}
+
+void PerIsolatePlatformData::PostTask(std::unique_ptr<Task> task,
+                                      TaskPriority priority) {
   CHECK_NOT_NULL(flush_tasks_);
-  foreground_tasks_.Push(std::move(task));
+  foreground_tasks_.Push(std::move(task), priority);
   uv_async_send(flush_tasks_);
 }
 
@@ -283,6 +310,14 @@ void PerIsolatePlatformData::Shutdown() {
   CHECK_NULL(foreground_tasks_.Pop());
   CancelPendingDelayedTasks();
 
+  // Idle tasks are not guaranteed to run.
+  idle_tasks_.PopAll();
+  uv_close(reinterpret_cast<uv_handle_t*>(idle_period_),
+           [](uv_handle_t* handle) {
+    delete reinterpret_cast<uv_prepare_t*>(handle);
+  });
+  idle_period_ = nullptr;
+
   ShutdownCbList* copy = new ShutdownCbList(std::move(shutdown_callbacks_));
   flush_tasks_->data = copy;
   uv_close(reinterpret_cast<uv_handle_t*>(flush_tasks_),
@@ -297,14 +332,16 @@ void PerIsolatePlatformData::Shutdown() {
 }
 
 NodePlatform::NodePlatform(int thread_pool_size,
-                           v8::TracingController* tracing_controller) {
+                           v8::TracingController* tracing_controller,
+                           const affinity::CpuSet& worker_thread_cpus) {
   if (tracing_controller) {
     tracing_controller_ = tracing_controller;
   } else {
     tracing_controller_ = new TracingController();
   }
   worker_thread_task_runner_ =
-      std::make_shared<WorkerThreadsTaskRunner>(thread_pool_size);
+      std::make_shared<WorkerThreadsTaskRunner>(thread_pool_size,
+                                                worker_thread_cpus);
 }
 
 void NodePlatform::RegisterIsolate(Isolate* isolate, uv_loop_t* loop) {
@@ -381,6 +418,39 @@ void PerIsolatePlatformData::CancelPendingDelayedTasks() {
   scheduled_delayed_tasks_.clear();
 }
 
+bool PerIsolatePlatformData::RunIdleTasks(double deadline_in_seconds) {
+  Isolate* isolate = Isolate::GetCurrent();
+  while (uv_hrtime() / 1e9 < deadline_in_seconds) {
+    std::unique_ptr<v8::IdleTask> task = idle_tasks_.Pop();
+    if (!task)
+      return false;
+    DebugSealHandleScope scope(isolate);
+    task->Run(deadline_in_seconds);
+  }
+  return !idle_tasks_.IsEmpty();
+}
+
+void PerIsolatePlatformData::OnIdlePeriod(uv_prepare_t* handle) {
+  auto platform_data = static_cast<PerIsolatePlatformData*>(handle->data);
+  uv_loop_t* loop = handle->loop;
+
+  // A timeout of 0 means that the loop has other work to do, a negative
+  // timeout means that it would block until I/O arrives.
+  int timeout = uv_backend_timeout(loop);
+  if (timeout == 0)
+    return;
+  uint64_t idle_ms = kMaxIdlePeriodMs;
+  if (timeout > 0)
+    idle_ms = std::min(idle_ms, static_cast<uint64_t>(timeout));
+
+  double deadline_in_seconds = uv_hrtime() / 1e9 + idle_ms / 1e3;
+  if (!platform_data->RunIdleTasks(deadline_in_seconds))
+    uv_prepare_stop(handle);
+  // libuv computes the poll timeout after running prepare handles, based on
+  // the cached loop time. Account for the time spent in idle tasks.
+  uv_update_time(loop);
+}
+
 void NodePlatform::DrainTasks(Isolate* isolate) {
   std::shared_ptr<PerIsolatePlatformData> per_isolate = ForIsolate(isolate);
 
@@ -423,6 +493,9 @@ bool PerIsolatePlatformData::FlushForegroundTasksInternal() {
     did_work = true;
     RunForegroundTask(std::move(task));
   }
+
+  if (idle_period_ != nullptr && !idle_tasks_.IsEmpty())
+    uv_prepare_start(idle_period_, OnIdlePeriod);
   return did_work;
 }
 
@@ -430,6 +503,17 @@ void NodePlatform::CallOnWorkerThread(std::unique_ptr<Task> task) {
   worker_thread_task_runner_->PostTask(std::move(task));
 }
 
+void NodePlatform::CallBlockingTaskOnWorkerThread(std::unique_ptr<Task> task) {
+  worker_thread_task_runner_->PostTask(std::move(task),
+                                       TaskPriority::kUserBlocking);
+}
+
+void NodePlatform::CallLowPriorityTaskOnWorkerThread(
+    std::unique_ptr<Task> task) {
+  worker_thread_task_runner_->PostTask(std::move(task),
+                                       TaskPriority::kBestEffort);
+}
+
 void NodePlatform::CallDelayedOnWorkerThread(std::unique_ptr<Task> task,
                                              double delay_in_seconds) {
   worker_thread_task_runner_->PostDelayedTask(std::move(task),
@@ -453,7 +537,9 @@ void NodePlatform::CancelPendingDelayedTasks(Isolate* isolate) {
   ForIsolate(isolate)->CancelPendingDelayedTasks();
 }
 
-bool NodePlatform::IdleTasksEnabled(Isolate* isolate) { return false; }
+bool NodePlatform::IdleTasksEnabled(Isolate* isolate) {
+  return ForIsolate(isolate)->IdleTasksEnabled();
+}
 
 std::shared_ptr<v8::TaskRunner>
 NodePlatform::GetForegroundTaskRunner(Isolate* isolate) {
@@ -477,39 +563,52 @@ v8::TracingController* NodePlatform::GetTracingController() {
 template <class T>
 TaskQueue<T>::TaskQueue()
     : lock_(), tasks_available_(), tasks_drained_(),
-      outstanding_tasks_(0), stopped_(false), task_queue_() { }
+      outstanding_tasks_(0), stopped_(false), size_(0) { }
 
 template <class T>
-void TaskQueue<T>::Push(std::unique_ptr<T> task) {
+void TaskQueue<T>::Push(std::unique_ptr<T> task, TaskPriority priority) {
   Mutex::ScopedLock scoped_lock(lock_);
   outstanding_tasks_++;
-  task_queue_.push(std::move(task));
+  size_++;
+  task_queues_[static_cast<size_t>(priority)].push(std::move(task));
   tasks_available_.Signal(scoped_lock);
 }
 
+template <class T>
+std::unique_ptr<T> TaskQueue<T>::PopLocked() {
+  for (std::queue<std::unique_ptr<T>>& queue : task_queues_) {
+    if (queue.empty())
+      continue;
+    std::unique_ptr<T> result = std::move(queue.front());
+    queue.pop();
+    size_--;
+    return result;
+  }
+  return std::unique_ptr<T>(nullptr);
+}
+
 template <class T>
 std::unique_ptr<T> TaskQueue<T>::Pop() {
   Mutex::ScopedLock scoped_lock(lock_);
-  if (task_queue_.empty()) {
-    return std::unique_ptr<T>(nullptr);
-  }
-  std::unique_ptr<T> result = std::move(task_queue_.front());
-  task_queue_.pop();
-  return result;
+  return PopLocked();
 }
 
 template <class T>
 std::unique_ptr<T> TaskQueue<T>::BlockingPop() {
   Mutex::ScopedLock scoped_lock(lock_);
-  while (task_queue_.empty() && !stopped_) {
+  while (size_ == 0 && !stopped_) {
     tasks_available_.Wait(scoped_lock);
   }
   if (stopped_) {
     return std::unique_ptr<T>(nullptr);
   }
-  std::unique_ptr<T> result = std::move(task_queue_.front());
-  task_queue_.pop();
-  return result;
+  return PopLocked();
+}
+
+template <class T>
+bool TaskQueue<T>::IsEmpty() {
+  Mutex::ScopedLock scoped_lock(lock_);
+  return size_ == 0;
 }
 
 template <class T>
@@ -539,7 +638,13 @@ template <class T>
 std::queue<std::unique_ptr<T>> TaskQueue<T>::PopAll() {
   Mutex::ScopedLock scoped_lock(lock_);
   std::queue<std::unique_ptr<T>> result;
-  result.swap(task_queue_);
+  for (std::queue<std::unique_ptr<T>>& queue : task_queues_) {
+    while (!queue.empty()) {
+      result.push(std::move(queue.front()));
+      queue.pop();
+    }
+  }
+  size_ = 0;
   return result;
 }
 
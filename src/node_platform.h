@@ -10,6 +10,7 @@
 
 #include "libplatform/libplatform.h"
 #include "node.h"
+#include "node_affinity.h"
 #include "node_mutex.h"
 #include "tracing/agent.h"
 #include "uv.h"
@@ -20,27 +21,43 @@ class NodePlatform;
 class IsolateData;
 class PerIsolatePlatformData;
 
+// Tasks with a higher priority are always run before tasks with a lower
+// priority, tasks of the same priority are run in FIFO order.
+enum class TaskPriority {
+  kUserBlocking,  // The main thread is waiting for the task to finish.
+  kUserVisible,   // Default.
+  kBestEffort     // May be delayed for an arbitrarily long time.
+};
+
+static constexpr size_t kTaskPriorityCount = 3;
+
 template <class T>
 class TaskQueue {
  public:
   TaskQueue();
   ~TaskQueue() = default;
 
-  void Push(std::unique_ptr<T> task);
+  void Push(std::unique_ptr<T> task,
+            TaskPriority priority = TaskPriority::kUserVisible);
   std::unique_ptr<T> Pop();
   std::unique_ptr<T> BlockingPop();
+  // Returns all pending tasks, ordered by priority.
   std::queue<std::unique_ptr<T>> PopAll();
+  bool IsEmpty();
   void NotifyOfCompletion();
   void BlockingDrain();
   void Stop();
 
  private:
+  std::unique_ptr<T> PopLocked();
+
   Mutex lock_;
   ConditionVariable tasks_available_;
   ConditionVariable tasks_drained_;
   int outstanding_tasks_;
   bool stopped_;
-  std::queue<std::unique_ptr<T>> task_queue_;
+  size_t size_;
+  std::queue<std::unique_ptr<T>> task_queues_[kTaskPriorityCount];
 };
 
 struct DelayedTask {
@@ -59,10 +76,13 @@ class PerIsolatePlatformData :
   ~PerIsolatePlatformData() override;
 
   void PostTask(std::unique_ptr<v8::Task> task) override;
+  // V8 does not pass priorities for foreground tasks, so this is only used
+  // by Node.js itself.
+  void PostTask(std::unique_ptr<v8::Task> task, TaskPriority priority);
   void PostIdleTask(std::unique_ptr<v8::IdleTask> task) override;
   void PostDelayedTask(std::unique_ptr<v8::Task> task,
                        double delay_in_seconds) override;
-  bool IdleTasksEnabled() override { return false; }
+  bool IdleTasksEnabled() override { return true; }
 
   // Non-nestable tasks are treated like regular tasks.
   bool NonNestableTasksEnabled() const override { return true; }
@@ -80,14 +100,26 @@ class PerIsolatePlatformData :
   bool FlushForegroundTasksInternal();
   void CancelPendingDelayedTasks();
 
+  // Runs pending idle tasks until `deadline_in_seconds` has been reached.
+  // Returns true if there are idle tasks left.
+  bool RunIdleTasks(double deadline_in_seconds);
+
   const uv_loop_t* event_loop() const { return loop_; }
 
+  // Upper bound for the time that is given to idle tasks per event loop
+  // iteration, so that I/O that arrives in the meantime is not delayed
+  // for too long.
+  static constexpr uint64_t kMaxIdlePeriodMs = 50;
+
  private:
   void DeleteFromScheduledTasks(DelayedTask* task);
 
   static void FlushTasks(uv_async_t* handle);
   static void RunForegroundTask(std::unique_ptr<v8::Task> task);
   static void RunForegroundTask(uv_timer_t* timer);
+  // Idle tasks are run right before the event loop would block for I/O,
+  // for at most as long as it would block.
+  static void OnIdlePeriod(uv_prepare_t* handle);
 
   struct ShutdownCallback {
     void (*cb)(void*);
@@ -98,8 +130,10 @@ class PerIsolatePlatformData :
 
   uv_loop_t* const loop_;
   uv_async_t* flush_tasks_ = nullptr;
+  uv_prepare_t* idle_period_ = nullptr;
   TaskQueue<v8::Task> foreground_tasks_;
   TaskQueue<DelayedTask> foreground_delayed_tasks_;
+  TaskQueue<v8::IdleTask> idle_tasks_;
 
   // Use a custom deleter because libuv needs to close the handle first.
   typedef std::unique_ptr<DelayedTask, std::function<void(DelayedTask*)>>
@@ -110,9 +144,12 @@ class PerIsolatePlatformData :
 // This acts as the single worker thread task runner for all Isolates.
 class WorkerThreadsTaskRunner {
  public:
-  explicit WorkerThreadsTaskRunner(int thread_pool_size);
+  explicit WorkerThreadsTaskRunner(
+      int thread_pool_size,
+      const affinity::CpuSet& thread_cpus = affinity::CpuSet());
 
-  void PostTask(std::unique_ptr<v8::Task> task);
+  void PostTask(std::unique_ptr<v8::Task> task,
+                TaskPriority priority = TaskPriority::kUserVisible);
   void PostDelayedTask(std::unique_ptr<v8::Task> task,
                        double delay_in_seconds);
 
@@ -123,6 +160,8 @@ class WorkerThreadsTaskRunner {
 
  private:
   TaskQueue<v8::Task> pending_worker_tasks_;
+  // Platform worker threads are restricted to these CPUs, unless empty.
+  const affinity::CpuSet thread_cpus_;
 
   class DelayedTaskScheduler;
   std::unique_ptr<DelayedTaskScheduler> delayed_task_scheduler_;
@@ -133,7 +172,9 @@ class WorkerThreadsTaskRunner {
 class NodePlatform : public MultiIsolatePlatform {
  public:
   NodePlatform(int thread_pool_size,
-               v8::TracingController* tracing_controller);
+               v8::TracingController* tracing_controller,
+               const affinity::CpuSet& worker_thread_cpus =
+                   affinity::CpuSet());
   ~NodePlatform() override = default;
 
   void DrainTasks(v8::Isolate* isolate) override;
@@ -143,6 +184,9 @@ class NodePlatform : public MultiIsolatePlatform {
   // v8::Platform implementation.
   int NumberOfWorkerThreads() override;
   void CallOnWorkerThread(std::unique_ptr<v8::Task> task) override;
+  void CallBlockingTaskOnWorkerThread(std::unique_ptr<v8::Task> task) override;
+  void CallLowPriorityTaskOnWorkerThread(
+      std::unique_ptr<v8::Task> task) override;
   void CallDelayedOnWorkerThread(std::unique_ptr<v8::Task> task,
                                  double delay_in_seconds) override;
   void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override {
@@ -153,6 +197,10 @@ class NodePlatform : public MultiIsolatePlatform {
                                      double delay_in_seconds) override {
     UNREACHABLE();
   }
+  void CallIdleOnForegroundThread(v8::Isolate* isolate,
+                                  v8::IdleTask* task) override {
+    UNREACHABLE();
+  }
   bool IdleTasksEnabled(v8::Isolate* isolate) override;
   double MonotonicallyIncreasingTime() override;
   double CurrentClockTimeMillis() override;
@@ -2,6 +2,7 @@
 #include "node_report.h"
 #include "debug_utils.h"
 #include "diagnosticfilename-inl.h"
+#include "node_affinity.h"
 #include "node_internals.h"
 #include "node_metadata.h"
 #include "util.h"
@@ -67,6 +68,7 @@ static void PrintLoadedLibraries(JSONWriter* writer);
 static void PrintComponentVersions(JSONWriter* writer);
 static void PrintRelease(JSONWriter* writer);
 static void PrintCpuInfo(JSONWriter* writer);
+static void PrintThreadAffinity(JSONWriter* writer);
 
 // External function to trigger a report, writing to file.
 // The 'name' parameter is in/out: an input filename is used
@@ -264,6 +266,9 @@ static void WriteNodeReport(Isolate* isolate,
 
   writer.json_arrayend();
 
+  // Report the CPUs that threads have been restricted to
+  PrintThreadAffinity(&writer);
+
   // Report operating system information
   PrintSystemInformation(&writer);
 
@@ -348,6 +353,23 @@ static void PrintCpuInfo(JSONWriter* writer) {
   }
 }
 
+// Report the threads that have been pinned to specific CPUs.
+static void PrintThreadAffinity(JSONWriter* writer) {
+  writer->json_arraystart("threadAffinity");
+  for (const node::affinity::ThreadPlacement& thread :
+       node::affinity::GetThreadPlacements()) {
+    writer->json_start();
+    writer->json_keyvalue("name", thread.name);
+    writer->json_keyvalue("cpus", node::affinity::FormatCpuSet(thread.cpus));
+    writer->json_arraystart("numaNodes");
+    for (int node : node::affinity::GetNumaNodes(thread.cpus))
+      writer->json_element(node);
+    writer->json_arrayend();
+    writer->json_end();
+  }
+  writer->json_arrayend();
+}
+
 // Report the JavaScript stack.
 static void PrintJavaScriptStack(JSONWriter* writer,
                                  Isolate* isolate,
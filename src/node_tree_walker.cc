@@ -0,0 +1,407 @@
+#include "node_tree_walker.h"
+#include "async_wrap-inl.h"
+#include "env-inl.h"
+#include "memory_tracker-inl.h"
+#include "node_affinity.h"
+#include "node_file.h"
+#include "threadpoolwork-inl.h"
+#include "util-inl.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <memory>
+
+namespace node {
+namespace fs {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::Float64Array;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Global;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::NewStringType;
+using v8::Null;
+using v8::Object;
+using v8::String;
+using v8::Uint32;
+using v8::Uint8Array;
+using v8::Undefined;
+using v8::Value;
+
+namespace {
+
+bool StartsWith(const std::string& str, const std::string& prefix) {
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+uv_dirent_type_t DirentTypeFromMode(uint64_t mode) {
+  switch (mode & S_IFMT) {
+    case S_IFREG: return UV_DIRENT_FILE;
+    case S_IFDIR: return UV_DIRENT_DIR;
+    case S_IFCHR: return UV_DIRENT_CHAR;
+#ifdef S_IFLNK
+    case S_IFLNK: return UV_DIRENT_LINK;
+#endif
+#ifdef S_IFIFO
+    case S_IFIFO: return UV_DIRENT_FIFO;
+#endif
+#ifdef S_IFSOCK
+    case S_IFSOCK: return UV_DIRENT_SOCKET;
+#endif
+#ifdef S_IFBLK
+    case S_IFBLK: return UV_DIRENT_BLOCK;
+#endif
+    default: return UV_DIRENT_UNKNOWN;
+  }
+}
+
+// Uses the same layout as FillStatsArray().
+void AppendStats(const uv_stat_t* s, std::vector<double>* out) {
+  const double fields[] = {
+    static_cast<double>(s->st_dev),
+    static_cast<double>(s->st_mode),
+    static_cast<double>(s->st_nlink),
+    static_cast<double>(s->st_uid),
+    static_cast<double>(s->st_gid),
+    static_cast<double>(s->st_rdev),
+    static_cast<double>(s->st_blksize),
+    static_cast<double>(s->st_ino),
+    static_cast<double>(s->st_size),
+    static_cast<double>(s->st_blocks),
+    ToNative<double>(s->st_atim),
+    ToNative<double>(s->st_mtim),
+    ToNative<double>(s->st_ctim),
+    ToNative<double>(s->st_birthtim)
+  };
+  static_assert(arraysize(fields) == kFsStatsFieldsNumber,
+                "Stats fields are out of sync");
+  out->insert(out->end(), fields, fields + arraysize(fields));
+}
+
+}  // anonymous namespace
+
+
+// Lists one directory on the threadpool. Holds a strong reference to the
+// walker, so that it stays alive until all scans are done.
+class TreeWalker::ScanWork : public ThreadPoolWork {
+ public:
+  ScanWork(TreeWalker* walker, Directory&& dir)
+      : ThreadPoolWork(walker->env()),
+        walker_(walker),
+        object_(walker->env()->isolate(), walker->object()),
+        dir_(std::move(dir)) {}
+
+  void DoThreadPoolWork() override;
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<ScanWork> self(this);
+    walker_->OnScanDone(this, status);
+  }
+
+  TreeWalker* const walker_;
+  Global<Object> object_;
+  const Directory dir_;
+
+  int error_ = 0;
+  std::vector<std::string> paths_;
+  std::vector<uint8_t> types_;
+  std::vector<double> stats_;
+  std::vector<Directory> subdirs_;
+
+ private:
+  std::string FullPath(const std::string& path) const {
+    if (path.empty()) return walker_->root_;
+    return walker_->root_ + kPathSeparator + path;
+  }
+};
+
+
+void TreeWalker::ScanWork::DoThreadPoolWork() {
+  const TreeWalker* walker = walker_;
+  const std::string& prefix = walker->prefix_;
+
+  uv_fs_t req;
+  int err = uv_fs_scandir(nullptr, &req, FullPath(dir_.path).c_str(), 0,
+                          nullptr);
+  if (err < 0) {
+    uv_fs_req_cleanup(&req);
+    error_ = err;
+    return;
+  }
+
+  uv_dirent_t ent;
+  while ((err = uv_fs_scandir_next(&req, &ent)) == 0) {
+    if (ent.type == UV_DIRENT_DIR && walker->skip_dirs_.count(ent.name) != 0)
+      continue;
+
+    std::string path = dir_.path.empty() ?
+        std::string(ent.name) : dir_.path + kPathSeparator + ent.name;
+    const bool matches = StartsWith(path, prefix);
+    // Directories that are a part of the prefix need to be listed, but are
+    // not reported themselves.
+    const bool leads_to_prefix =
+        !matches && StartsWith(prefix, path + kPathSeparator);
+    if (!matches && !leads_to_prefix) continue;
+
+    uv_dirent_type_t type = ent.type;
+    uv_stat_t stat = uv_stat_t();
+    const bool need_stat =
+        type == UV_DIRENT_UNKNOWN || (matches && walker->with_stats_);
+    if (need_stat) {
+      uv_fs_t stat_req;
+      err = uv_fs_lstat(nullptr, &stat_req, FullPath(path).c_str(), nullptr);
+      if (err == 0) stat = stat_req.statbuf;
+      uv_fs_req_cleanup(&stat_req);
+      // The entry may have been removed since the directory was listed.
+      if (err == UV_ENOENT) continue;
+      if (err < 0) {
+        error_ = err;
+        break;
+      }
+      if (type == UV_DIRENT_UNKNOWN) type = DirentTypeFromMode(stat.st_mode);
+    }
+
+    // The type of some entries is only known after lstat().
+    const bool is_dir = type == UV_DIRENT_DIR;
+    if (is_dir && walker->skip_dirs_.count(ent.name) != 0) continue;
+
+    if (matches) {
+      types_.push_back(type);
+      if (walker->with_stats_) AppendStats(&stat, &stats_);
+    }
+    if (is_dir && dir_.depth < walker->max_depth_)
+      subdirs_.push_back(Directory { path, dir_.depth + 1 });
+    if (matches)
+      paths_.emplace_back(std::move(path));
+  }
+  if (err != UV_EOF && error_ == 0) error_ = err;
+  uv_fs_req_cleanup(&req);
+}
+
+
+TreeWalker::TreeWalker(Environment* env, Local<Object> object)
+    : AsyncWrap(env, object, AsyncWrap::PROVIDER_TREEWALKER) {
+  MakeWeak();
+}
+
+
+void TreeWalker::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  new TreeWalker(env, args.This());
+}
+
+
+void TreeWalker::Start(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  TreeWalker* walker;
+  ASSIGN_OR_RETURN_UNWRAP(&walker, args.Holder());
+  CHECK(walker->root_.empty());
+
+  BufferValue root(env->isolate(), args[0]);
+  CHECK_NOT_NULL(*root);
+  CHECK(args[1]->IsUint32());  // maxDepth
+  CHECK(args[2]->IsString());  // prefix
+  CHECK(args[3]->IsArray());  // skipDirs
+  CHECK(args[4]->IsBoolean());  // withStats
+  CHECK(args[5]->IsUint32());  // batchSize
+  CHECK(args[6]->IsUint32());  // concurrency, or 0 for the threadpool size
+
+  walker->root_ = std::string(*root, root.length());
+  walker->max_depth_ = args[1].As<Uint32>()->Value();
+  walker->prefix_ = *Utf8Value(env->isolate(), args[2]);
+  Local<Array> skip_dirs = args[3].As<Array>();
+  for (uint32_t i = 0; i < skip_dirs->Length(); i++) {
+    Local<Value> name;
+    if (!skip_dirs->Get(env->context(), i).ToLocal(&name)) return;
+    walker->skip_dirs_.emplace(*Utf8Value(env->isolate(), name));
+  }
+  walker->with_stats_ = args[4]->IsTrue();
+  walker->batch_size_ = args[5].As<Uint32>()->Value();
+  CHECK_GT(walker->batch_size_, 0);
+  walker->concurrency_ = args[6].As<Uint32>()->Value();
+  if (walker->concurrency_ == 0)
+    walker->concurrency_ = affinity::ThreadpoolSize();
+
+  walker->pending_dirs_.push_back(Directory { "", 0 });
+  walker->Schedule();
+}
+
+
+void TreeWalker::Read(const FunctionCallbackInfo<Value>& args) {
+  TreeWalker* walker;
+  ASSIGN_OR_RETURN_UNWRAP(&walker, args.Holder());
+  CHECK(!walker->closed_);
+  CHECK(!walker->reading_);
+  walker->reading_ = true;
+  // A batch may be ready already. Deliver it on a stack of its own, as it
+  // would be if it was not, so that oncomplete never runs inside read().
+  walker->env()->SetImmediate([](Environment*, void* data) {
+    static_cast<TreeWalker*>(data)->MaybeDeliver();
+  }, walker, walker->object());
+}
+
+
+void TreeWalker::Close(const FunctionCallbackInfo<Value>& args) {
+  TreeWalker* walker;
+  ASSIGN_OR_RETURN_UNWRAP(&walker, args.Holder());
+  // Scans that are in progress finish in the background.
+  walker->closed_ = true;
+  walker->reading_ = false;
+  walker->pending_dirs_.clear();
+  walker->paths_.clear();
+  walker->types_.clear();
+  walker->stats_.clear();
+}
+
+
+void TreeWalker::Schedule() {
+  while (!closed_ && error_ == 0 && !pending_dirs_.empty() &&
+         active_scans_ < concurrency_ && paths_.size() < 2 * batch_size_) {
+    // Going depth first keeps the list of pending directories short.
+    Directory dir = std::move(pending_dirs_.back());
+    pending_dirs_.pop_back();
+    active_scans_++;
+    (new ScanWork(this, std::move(dir)))->ScheduleWork();
+  }
+}
+
+
+void TreeWalker::OnScanDone(ScanWork* work, int status) {
+  active_scans_--;
+  if (closed_ || status == UV_ECANCELED) return;
+
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+
+  int err = work->error_;
+  // Directories other than the root may have been removed, or replaced, since
+  // their parent was listed.
+  if (!work->dir_.path.empty() && (err == UV_ENOENT || err == UV_ENOTDIR))
+    err = 0;
+
+  if (err < 0) {
+    if (error_ == 0) {
+      error_ = err;
+      error_path_ = work->dir_.path.empty() ?
+          root_ : root_ + kPathSeparator + work->dir_.path;
+    }
+    pending_dirs_.clear();
+  } else {
+    std::move(work->paths_.begin(), work->paths_.end(),
+              std::back_inserter(paths_));
+    types_.insert(types_.end(), work->types_.begin(), work->types_.end());
+    stats_.insert(stats_.end(), work->stats_.begin(), work->stats_.end());
+    std::move(work->subdirs_.begin(), work->subdirs_.end(),
+              std::back_inserter(pending_dirs_));
+  }
+
+  Schedule();
+  MaybeDeliver();
+}
+
+
+void TreeWalker::MaybeDeliver() {
+  if (!reading_) return;
+  const bool done = pending_dirs_.empty() && active_scans_ == 0;
+  if (error_ == 0 && !done && paths_.size() < batch_size_) return;
+  reading_ = false;
+
+  Isolate* isolate = env()->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env()->context());
+
+  if (error_ != 0) {
+    Local<Value> argv[] = {
+      Integer::New(isolate, error_),
+      String::NewFromUtf8(isolate, error_path_.data(), NewStringType::kNormal,
+                          error_path_.size()).ToLocalChecked()
+    };
+    MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+    return;
+  }
+
+  const size_t count = std::min(batch_size_, paths_.size());
+  if (count == 0) {
+    Local<Value> argv[] = { Integer::New(isolate, 0), Null(isolate) };
+    MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+    return;
+  }
+
+  MaybeStackBuffer<Local<Value>, 64> paths(count);
+  for (size_t i = 0; i < count; i++) {
+    const std::string& path = paths_[i];
+    paths[i] = String::NewFromUtf8(isolate, path.data(),
+                                   NewStringType::kNormal,
+                                   path.size()).ToLocalChecked();
+  }
+
+  Local<ArrayBuffer> types_buffer = ArrayBuffer::New(isolate, count);
+  std::copy(types_.begin(), types_.begin() + count,
+            static_cast<uint8_t*>(types_buffer->GetContents().Data()));
+
+  Local<Value> stats = Undefined(isolate);
+  if (with_stats_) {
+    const size_t stats_count = count * kFsStatsFieldsNumber;
+    Local<ArrayBuffer> stats_buffer =
+        ArrayBuffer::New(isolate, stats_count * sizeof(double));
+    std::copy(stats_.begin(), stats_.begin() + stats_count,
+              static_cast<double*>(stats_buffer->GetContents().Data()));
+    stats_.erase(stats_.begin(), stats_.begin() + stats_count);
+    stats = Float64Array::New(stats_buffer, 0, stats_count);
+  }
+
+  paths_.erase(paths_.begin(), paths_.begin() + count);
+  types_.erase(types_.begin(), types_.begin() + count);
+
+  Local<Value> argv[] = {
+    Integer::New(isolate, 0),
+    Array::New(isolate, paths.out(), count),
+    Uint8Array::New(types_buffer, 0, count),
+    stats
+  };
+  // There is room for more entries now.
+  Schedule();
+  MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+}
+
+
+void TreeWalker::MemoryInfo(MemoryTracker* tracker) const {
+  size_t paths_size = 0;
+  for (const std::string& path : paths_)
+    paths_size += path.capacity();
+  tracker->TrackFieldWithSize("paths", paths_size);
+  tracker->TrackFieldWithSize("types", types_.size());
+  tracker->TrackFieldWithSize("stats", stats_.size() * sizeof(double));
+  tracker->TrackFieldWithSize("pending_dirs",
+                              pending_dirs_.size() * sizeof(Directory));
+}
+
+
+void TreeWalker::Initialize(Environment* env, Local<Object> target) {
+  HandleScope scope(env->isolate());
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(TreeWalker::New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  Local<String> treeWalkerString =
+      FIXED_ONE_BYTE_STRING(env->isolate(), "TreeWalker");
+  t->SetClassName(treeWalkerString);
+  t->Inherit(AsyncWrap::GetConstructorTemplate(env));
+
+  env->SetProtoMethod(t, "start", TreeWalker::Start);
+  env->SetProtoMethod(t, "read", TreeWalker::Read);
+  env->SetProtoMethod(t, "close", TreeWalker::Close);
+
+  target->Set(env->context(), treeWalkerString,
+              t->GetFunction(env->context()).ToLocalChecked()).Check();
+}
+
+}  // namespace fs
+}  // namespace node
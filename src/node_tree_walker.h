@@ -0,0 +1,89 @@
+#ifndef SRC_NODE_TREE_WALKER_H_
+#define SRC_NODE_TREE_WALKER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "async_wrap.h"
+#include "env.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace node {
+namespace fs {
+
+// Walks a directory tree on the threadpool. Each directory is listed (and its
+// entries optionally lstat'ed) by a threadpool task of its own, and up to
+// `concurrency` directories are listed at the same time.
+//
+// Entries are collected on the thread of the event loop and handed to JS in
+// batches, one per read() call, in a packed format: an array of paths that
+// are relative to the root, a Uint8Array of UV_DIRENT_* types and, if stats
+// were requested, a Float64Array with kFsStatsFieldsNumber fields per entry.
+// No new directories are listed while two batches are waiting to be read.
+class TreeWalker : public AsyncWrap {
+ public:
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(TreeWalker)
+  SET_SELF_SIZE(TreeWalker)
+
+ private:
+  class ScanWork;
+
+  struct Directory {
+    std::string path;  // Relative to the root.
+    uint32_t depth;
+  };
+
+  TreeWalker(Environment* env, v8::Local<v8::Object> object);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // start(root, maxDepth, prefix, skipDirs, withStats, batchSize, concurrency)
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Read(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Starts listing pending directories, as far as the limits allow.
+  void Schedule();
+  void OnScanDone(ScanWork* work, int status);
+  // Calls oncomplete(errno, errorPath) or oncomplete(0, paths, types, stats)
+  // if a read is pending and a full batch, the last batch or an error is
+  // available. The end of the walk is signaled with oncomplete(0, null).
+  // Never called from within read().
+  void MaybeDeliver();
+
+  // These are not modified after Start(), so that ScanWork can read them on
+  // the threadpool.
+  std::string root_;
+  std::string prefix_;
+  std::unordered_set<std::string> skip_dirs_;
+  uint32_t max_depth_ = 0;
+  bool with_stats_ = false;
+  size_t batch_size_ = 0;
+  size_t concurrency_ = 0;
+
+  std::vector<Directory> pending_dirs_;
+  size_t active_scans_ = 0;
+
+  std::deque<std::string> paths_;
+  std::deque<uint8_t> types_;
+  std::deque<double> stats_;
+
+  int error_ = 0;
+  std::string error_path_;
+  bool reading_ = false;
+  bool closed_ = false;
+};
+
+}  // namespace fs
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_TREE_WALKER_H_
@@ -7,6 +7,7 @@
 
 #include "env-inl.h"
 #include "node.h"
+#include "node_affinity.h"
 #include "node_metadata.h"
 #include "node_options.h"
 #include "tracing/node_trace_writer.h"
@@ -101,7 +102,15 @@ struct V8Platform {
     v8::V8::InitializePlatform(platform_);
 #endif
     tracing_agent_.reset(nullptr);
-    platform_ = new NodePlatform(thread_pool_size, new v8::TracingController());
+    // The option has already been validated at this point.
+    affinity::CpuSet worker_thread_cpus;
+    std::string unused;
+    const std::string& cpus = per_process::cli_options->platform_thread_cpus;
+    if (!cpus.empty())
+      affinity::ParseCpuSet(cpus, &worker_thread_cpus, &unused);
+    platform_ = new NodePlatform(thread_pool_size,
+                                 new v8::TracingController(),
+                                 worker_thread_cpus);
     v8::V8::InitializePlatform(platform_);
   }
 
@@ -486,6 +486,25 @@ void Worker::SetEnvVars(const FunctionCallbackInfo<Value>& args) {
                                 args[0].As<Object>());
 }
 
+void Worker::SetCpuAffinity(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
+  CHECK(w->thread_joined_);  // The Worker has not started yet.
+
+  CHECK(args[0]->IsString());
+  Utf8Value spec(args.GetIsolate(), args[0]);
+  std::string error;
+  if (!affinity::IsSupported()) {
+    error = "not supported on this platform";
+  } else if (affinity::ParseCpuSet(*spec, &w->cpus_, &error)) {
+    return;
+  }
+  // Return a description of the problem to JS, which throws the actual error.
+  args.GetReturnValue().Set(
+      String::NewFromUtf8(args.GetIsolate(), error.c_str(),
+                          v8::NewStringType::kNormal).ToLocalChecked());
+}
+
 void Worker::StartThread(const FunctionCallbackInfo<Value>& args) {
   Worker* w;
   ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
@@ -518,8 +537,16 @@ void Worker::StartThread(const FunctionCallbackInfo<Value>& args) {
     // some space to do work in C++ land.
     w->stack_base_ = stack_top - (kStackSize - kStackBufferSize);
 
+    if (!w->cpus_.empty()) {
+      affinity::PinCurrentThread("worker " + std::to_string(w->thread_id_),
+                                 w->cpus_);
+    }
+
     w->Run();
 
+    if (!w->cpus_.empty())
+      affinity::ForgetCurrentThread();
+
     Mutex::ScopedLock lock(w->mutex_);
     w->on_thread_finished_.Stop();
   }, static_cast<void*>(w)), 0);
@@ -583,6 +610,7 @@ void InitWorker(Local<Object> target,
 
     env->SetProtoMethod(w, "setEnvVars", Worker::SetEnvVars);
     env->SetProtoMethod(w, "cloneParentEnvVars", Worker::CloneParentEnvVars);
+    env->SetProtoMethod(w, "setCpuAffinity", Worker::SetCpuAffinity);
     env->SetProtoMethod(w, "startThread", Worker::StartThread);
     env->SetProtoMethod(w, "stopThread", Worker::StopThread);
     env->SetProtoMethod(w, "ref", Worker::Ref);
@@ -4,6 +4,7 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include <unordered_map>
+#include "node_affinity.h"
 #include "node_messaging.h"
 #include "uv.h"
 
@@ -46,6 +47,7 @@ class Worker : public AsyncWrap {
   static void CloneParentEnvVars(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetEnvVars(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetCpuAffinity(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void StartThread(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void StopThread(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Ref(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -62,6 +64,8 @@ class Worker : public AsyncWrap {
   v8::Isolate* isolate_ = nullptr;
   bool start_profiler_idle_notifier_;
   uv_thread_t tid_;
+  // The worker thread restricts itself to these CPUs, unless empty.
+  affinity::CpuSet cpus_;
 
 #if NODE_USE_V8_PLATFORM && HAVE_INSPECTOR
   std::unique_ptr<inspector::ParentInspectorHandle> inspector_parent_handle_;
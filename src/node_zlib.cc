@@ -25,6 +25,7 @@
 
 #include "async_wrap-inl.h"
 #include "env-inl.h"
+#include "stream_pipe.h"
 #include "threadpoolwork-inl.h"
 #include "util-inl.h"
 
@@ -123,6 +124,8 @@ struct CompressionError {
 
 class ZlibContext : public MemoryRetainer {
  public:
+  static constexpr int kFinishFlush = Z_FINISH;
+
   ZlibContext() = default;
 
   // Streaming-related, should be available for all compression libraries:
@@ -172,6 +175,8 @@ class ZlibContext : public MemoryRetainer {
 // so some of the specifics are implemented in more specific subclasses
 class BrotliContext : public MemoryRetainer {
  public:
+  static constexpr int kFinishFlush = BROTLI_OPERATION_FINISH;
+
   BrotliContext() = default;
 
   void SetBuffers(char* in, uint32_t in_len, char* out, uint32_t out_len);
@@ -240,7 +245,9 @@ class BrotliDecoderContext final : public BrotliContext {
 };
 
 template <typename CompressionContext>
-class CompressionStream : public AsyncWrap, public ThreadPoolWork {
+class CompressionStream : public AsyncWrap,
+                          public ThreadPoolWork,
+                          public StreamPipeTransform {
  public:
   CompressionStream(Environment* env, Local<Object> wrap)
       : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_ZLIB),
@@ -366,6 +373,34 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
     ctx_.GetAfterWriteOffsets(&write_result_[1], &write_result_[0]);
   }
 
+  // Used when this stream is part of a StreamPipe. The data is processed
+  // synchronously, like `writeSync()` does, since the pipe passes it on
+  // right away.
+  int TransformChunks(std::vector<AllocatedBuffer>* chunks,
+                      bool finish) override {
+    AllocScope alloc_scope(this);
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+
+    CHECK(init_done_ && "write before init");
+    if (closed_ || write_in_progress_)
+      return UV_EBUSY;
+
+    std::vector<AllocatedBuffer> input = std::move(*chunks);
+    chunks->clear();
+    for (AllocatedBuffer& chunk : input) {
+      if (!TransformChunk(chunk.data(), chunk.size(), Z_NO_FLUSH, chunks))
+        return UV_EPROTO;
+    }
+    if (finish &&
+        !TransformChunk(nullptr, 0, CompressionContext::kFinishFlush, chunks)) {
+      return UV_EPROTO;
+    }
+    return 0;
+  }
+
+  Local<Object> GetTransformObject() override { return object(); }
+
   // thread pool!
   // This function may be called multiple times on the uv_work pool
   // for a single write() call, until all of the input bytes have
@@ -452,6 +487,32 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
  protected:
   CompressionContext* context() { return &ctx_; }
 
+  // Run the input through the compression context until it is fully
+  // consumed, collecting the output in chunks of Z_DEFAULT_CHUNK bytes.
+  bool TransformChunk(char* in,
+                      uint32_t in_len,
+                      int flush,
+                      std::vector<AllocatedBuffer>* out) {
+    uint32_t avail_in = in_len;
+    uint32_t avail_out;
+    ctx_.SetFlush(flush);
+    do {
+      AllocatedBuffer buf = env()->AllocateManaged(Z_DEFAULT_CHUNK);
+      ctx_.SetBuffers(in + (in_len - avail_in), avail_in,
+                      buf.data(), buf.size());
+      ctx_.DoThreadPoolWork();
+      if (!CheckError())
+        return false;
+      ctx_.GetAfterWriteOffsets(&avail_in, &avail_out);
+      size_t produced = buf.size() - avail_out;
+      if (produced > 0) {
+        buf.Resize(produced);
+        out->emplace_back(std::move(buf));
+      }
+    } while (avail_out == 0);
+    return true;
+  }
+
   void InitStream(uint32_t* write_result, Local<Function> write_js_callback) {
     write_result_ = write_result;
     write_js_callback_.Reset(env()->isolate(), write_js_callback);
@@ -1223,6 +1284,9 @@ struct MakeClass {
     env->SetProtoMethod(z, "init", Stream::Init);
     env->SetProtoMethod(z, "params", Stream::Params);
     env->SetProtoMethod(z, "reset", Stream::Reset);
+    env->SetProtoMethod(z,
+                        "getPipeTransform",
+                        StreamPipeTransform::GetPipeTransform<Stream>);
 
     Local<String> zlibString = OneByteString(env->isolate(), name);
     z->SetClassName(zlibString);
@@ -92,12 +92,25 @@ SharedArrayBufferMetadata::ForSharedArrayBuffer(
   }
 
   SharedArrayBuffer::Contents contents = source->Externalize();
-  SharedArrayBufferMetadataReference r(new SharedArrayBufferMetadata(contents));
+  SharedArrayBufferMetadataReference r(
+      new SharedArrayBufferMetadata(contents.Data(),
+                                    contents.ByteLength(),
+                                    contents.Deleter(),
+                                    contents.DeleterData()));
   if (r->AssignToSharedArrayBuffer(env, context, source).IsNothing())
     return nullptr;
   return r;
 }
 
+SharedArrayBufferMetadataReference
+SharedArrayBufferMetadata::ForExternalMemory(void* data,
+                                             size_t byte_length,
+                                             DeleterCallback deleter,
+                                             void* deleter_data) {
+  return SharedArrayBufferMetadataReference(
+      new SharedArrayBufferMetadata(data, byte_length, deleter, deleter_data));
+}
+
 Maybe<bool> SharedArrayBufferMetadata::AssignToSharedArrayBuffer(
     Environment* env, Local<Context> context,
     Local<SharedArrayBuffer> target) {
@@ -114,21 +127,23 @@ Maybe<bool> SharedArrayBufferMetadata::AssignToSharedArrayBuffer(
 }
 
 SharedArrayBufferMetadata::SharedArrayBufferMetadata(
-    const SharedArrayBuffer::Contents& contents)
-  : contents_(contents) { }
+    void* data,
+    size_t byte_length,
+    DeleterCallback deleter,
+    void* deleter_data)
+  : data_(data),
+    byte_length_(byte_length),
+    deleter_(deleter),
+    deleter_data_(deleter_data) { }
 
 SharedArrayBufferMetadata::~SharedArrayBufferMetadata() {
-  contents_.Deleter()(contents_.Data(),
-                      contents_.ByteLength(),
-                      contents_.DeleterData());
+  deleter_(data_, byte_length_, deleter_data_);
 }
 
 MaybeLocal<SharedArrayBuffer> SharedArrayBufferMetadata::GetSharedArrayBuffer(
     Environment* env, Local<Context> context) {
   Local<SharedArrayBuffer> obj =
-      SharedArrayBuffer::New(env->isolate(),
-                             contents_.Data(),
-                             contents_.ByteLength());
+      SharedArrayBuffer::New(env->isolate(), data_, byte_length_);
 
   if (AssignToSharedArrayBuffer(env, context, obj).IsNothing())
     return MaybeLocal<SharedArrayBuffer>();
@@ -25,10 +25,20 @@ typedef std::shared_ptr<SharedArrayBufferMetadata>
 class SharedArrayBufferMetadata
     : public std::enable_shared_from_this<SharedArrayBufferMetadata> {
  public:
+  typedef v8::SharedArrayBuffer::Contents::DeleterCallback DeleterCallback;
+
   static SharedArrayBufferMetadataReference ForSharedArrayBuffer(
       Environment* env,
       v8::Local<v8::Context> context,
       v8::Local<v8::SharedArrayBuffer> source);
+  // Wraps memory that V8 did not allocate, e.g. a memory-mapped file, so that
+  // it can be shared between threads like a SharedArrayBuffer. `deleter` is
+  // called once no thread refers to the memory anymore.
+  static SharedArrayBufferMetadataReference ForExternalMemory(
+      void* data,
+      size_t byte_length,
+      DeleterCallback deleter,
+      void* deleter_data);
   ~SharedArrayBufferMetadata();
 
   // Create a SharedArrayBuffer object for a specific Environment and Context.
@@ -46,7 +56,10 @@ class SharedArrayBufferMetadata
   SharedArrayBufferMetadata(const SharedArrayBufferMetadata&) = delete;
 
  private:
-  explicit SharedArrayBufferMetadata(const v8::SharedArrayBuffer::Contents&);
+  SharedArrayBufferMetadata(void* data,
+                            size_t byte_length,
+                            DeleterCallback deleter,
+                            void* deleter_data);
 
   // Attach a lifetime tracker object with a reference count to `target`.
   v8::Maybe<bool> AssignToSharedArrayBuffer(
@@ -54,7 +67,10 @@ class SharedArrayBufferMetadata
       v8::Local<v8::Context> context,
       v8::Local<v8::SharedArrayBuffer> target);
 
-  v8::SharedArrayBuffer::Contents contents_;
+  void* const data_;
+  const size_t byte_length_;
+  const DeleterCallback deleter_;
+  void* const deleter_data_;
 };
 
 }  // namespace worker
@@ -0,0 +1,177 @@
+#include "slab_allocator.h"
+
+#include "env-inl.h"
+#include "util-inl.h"
+
+#include <algorithm>  // std::min()
+
+namespace node {
+
+using v8::ArrayBuffer;
+using v8::ArrayBufferCreationMode;
+using v8::Local;
+using v8::WeakCallbackInfo;
+using v8::WeakCallbackType;
+
+ReadSlab::ReadSlab(ReadSlabAllocator* allocator, char* data, size_t size)
+    : allocator_(allocator), data_(data), size_(size) {
+  Environment* env = allocator->env_;
+  // The memory is owned by the allocator, so that it can be recycled once
+  // the ArrayBuffer has been garbage collected.
+  Local<ArrayBuffer> ab =
+      ArrayBuffer::New(env->isolate(),
+                       data,
+                       size,
+                       ArrayBufferCreationMode::kExternalized);
+  array_buffer_.Reset(env->isolate(), ab);
+}
+
+ReadSlab::~ReadSlab() {
+  CHECK_EQ(refs_, 0);
+  CHECK(array_buffer_.IsEmpty());
+}
+
+void ReadSlab::Ref() {
+  // Once a slab has been handed over to the GC, it may not be revived.
+  CHECK(!array_buffer_.IsWeak());
+  refs_++;
+}
+
+void ReadSlab::Unref() {
+  CHECK_GT(refs_, 0);
+  if (--refs_ == 0)
+    array_buffer_.SetWeak(this, WeakCallback, WeakCallbackType::kParameter);
+}
+
+void ReadSlab::WeakCallback(const WeakCallbackInfo<ReadSlab>& data) {
+  ReadSlab* slab = data.GetParameter();
+  slab->array_buffer_.Reset();
+  if (slab->allocator_ != nullptr) {
+    slab->allocator_->OnSlabCollected(slab);
+    return;
+  }
+
+  // The allocator has already been destroyed together with its Environment.
+  data.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(
+      -static_cast<int64_t>(slab->size_));
+  free(slab->data_);
+  delete slab;
+}
+
+
+ReadSlabAllocator::ReadSlabAllocator(Environment* env, size_t slab_size)
+    : env_(env), slab_size_(slab_size) {
+  CHECK_GT(slab_size_, 0);
+}
+
+ReadSlabAllocator::~ReadSlabAllocator() {
+  if (current_ != nullptr)
+    RetireCurrentSlab();
+
+  // Slabs that are still referenced from JS free themselves once they
+  // are garbage collected. Reads that were still pending will never be
+  // committed, so their references are dropped here; otherwise, the slabs
+  // that they were made into would never be handed over to the GC.
+  for (ReadSlab* slab : live_slabs_) {
+    slab->allocator_ = nullptr;
+    if (slab->refs_ > 0) {
+      slab->refs_ = 1;
+      slab->Unref();
+    }
+  }
+
+  for (char* data : free_slabs_) {
+    free(data);
+    env_->isolate()->AdjustAmountOfExternalAllocatedMemory(
+        -static_cast<int64_t>(slab_size_));
+  }
+}
+
+uv_buf_t ReadSlabAllocator::Allocate(size_t suggested_size, ReadSlab** slab) {
+  size_t size = std::min(suggested_size, slab_size_);
+  CHECK_GT(size, 0);
+
+  if (current_ != nullptr && current_->size_ - current_->used_ < size)
+    RetireCurrentSlab();
+
+  if (current_ == nullptr) {
+    current_ = NewSlab();
+    current_->Ref();
+  }
+
+  ReadSlab* s = current_;
+  uv_buf_t buf = uv_buf_init(s->data_ + s->used_, size);
+  s->used_ += size;
+  s->Ref();
+  *slab = s;
+  return buf;
+}
+
+Local<ArrayBuffer> ReadSlabAllocator::Commit(ReadSlab* slab,
+                                             const uv_buf_t& buf,
+                                             ssize_t nread,
+                                             size_t* offset) {
+  CHECK_GE(buf.base, slab->data_);
+  CHECK_LE(buf.base + buf.len, slab->data_ + slab->size_);
+
+  size_t used = nread > 0 ? static_cast<size_t>(nread) : 0;
+  CHECK_LE(used, buf.len);
+
+  *offset = buf.base - slab->data_;
+  // Only the most recent reservation in a slab can be shrunk; if another
+  // read was started in the meantime, the unused tail is simply lost.
+  if (*offset + buf.len == slab->used_)
+    slab->used_ = *offset + used;
+
+  Local<ArrayBuffer> ab =
+      Local<ArrayBuffer>::New(env_->isolate(), slab->array_buffer_);
+  slab->Unref();
+  return ab;
+}
+
+ReadSlab* ReadSlabAllocator::NewSlab() {
+  char* data;
+  if (!free_slabs_.empty()) {
+    data = free_slabs_.back();
+    free_slabs_.pop_back();
+    slabs_recycled_++;
+  } else {
+    data = Malloc(slab_size_);
+    env_->isolate()->AdjustAmountOfExternalAllocatedMemory(slab_size_);
+    slabs_created_++;
+  }
+
+  ReadSlab* slab = new ReadSlab(this, data, slab_size_);
+  live_slabs_.insert(slab);
+  return slab;
+}
+
+void ReadSlabAllocator::RetireCurrentSlab() {
+  ReadSlab* slab = current_;
+  current_ = nullptr;
+  slab->Unref();
+}
+
+void ReadSlabAllocator::OnSlabCollected(ReadSlab* slab) {
+  CHECK_NE(slab, current_);
+  live_slabs_.erase(slab);
+
+  if (free_slabs_.size() < kMaxFreeSlabs) {
+    free_slabs_.push_back(slab->data_);
+  } else {
+    free(slab->data_);
+    env_->isolate()->AdjustAmountOfExternalAllocatedMemory(
+        -static_cast<int64_t>(slab_size_));
+  }
+
+  delete slab;
+}
+
+void ReadSlabAllocator::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize(
+      "live_slabs", live_slabs_.size() * slab_size_, "ReadSlab");
+  tracker->TrackFieldWithSize(
+      "free_slabs", free_slabs_.size() * slab_size_, "ReadSlab");
+}
+
+}  // namespace node
@@ -0,0 +1,110 @@
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "memory_tracker.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <unordered_set>
+#include <vector>
+
+namespace node {
+
+class Environment;
+class ReadSlabAllocator;
+
+// A single slab of memory that stream reads are carved out of. The slab is
+// exposed to JS as one ArrayBuffer, and each read is handed out as a view
+// into it. While the slab is still used for new reads or while a read into
+// it is pending, it is kept alive by a strong reference; after that, the
+// reference is made weak, and the memory is returned to the allocator once
+// all views onto it have been garbage collected.
+class ReadSlab {
+ public:
+  inline char* data() const { return data_; }
+  inline size_t size() const { return size_; }
+  inline size_t used() const { return used_; }
+
+ private:
+  ReadSlab(ReadSlabAllocator* allocator, char* data, size_t size);
+  ~ReadSlab();
+
+  void Ref();
+  void Unref();
+  static void WeakCallback(const v8::WeakCallbackInfo<ReadSlab>& data);
+
+  ReadSlabAllocator* allocator_;
+  char* const data_;
+  const size_t size_;
+  size_t used_ = 0;
+  // One reference for being the current slab, plus one per pending read.
+  uint32_t refs_ = 0;
+  v8::Global<v8::ArrayBuffer> array_buffer_;
+
+  friend class ReadSlabAllocator;
+};
+
+// Per-Environment allocator for stream reads that are passed to JS through
+// the default `EmitToJSStreamListener`. Instead of allocating a new
+// 64 KB chunk for every read and shrinking it afterwards, reads land in
+// shared slabs, and memory of slabs that are no longer referenced from JS is
+// recycled rather than returned to the system.
+class ReadSlabAllocator : public MemoryRetainer {
+ public:
+  // The maximum number of unused slabs that are kept around for re-use.
+  static constexpr size_t kMaxFreeSlabs = 4;
+
+  ReadSlabAllocator(Environment* env, size_t slab_size);
+  ~ReadSlabAllocator() override;
+
+  ReadSlabAllocator(const ReadSlabAllocator&) = delete;
+  ReadSlabAllocator& operator=(const ReadSlabAllocator&) = delete;
+
+  // Reserve at most `suggested_size` bytes from the current slab, starting
+  // a new slab if there is not enough space left in it. `*slab` is set to
+  // the slab that backs the returned buffer, and must be passed to
+  // `Commit()` once the read has finished.
+  uv_buf_t Allocate(size_t suggested_size, ReadSlab** slab);
+
+  // Called once `nread` bytes have been read into `buf`. This gives the
+  // unused part of the reservation back to the slab if possible, and returns
+  // the ArrayBuffer backing `slab`, with `*offset` set to the offset of `buf`
+  // within it. If `nread` is not positive, the whole reservation is given
+  // back, and the returned ArrayBuffer should not be used.
+  v8::Local<v8::ArrayBuffer> Commit(ReadSlab* slab,
+                                    const uv_buf_t& buf,
+                                    ssize_t nread,
+                                    size_t* offset);
+
+  inline size_t slab_size() const { return slab_size_; }
+  inline uint64_t slabs_created() const { return slabs_created_; }
+  inline uint64_t slabs_recycled() const { return slabs_recycled_; }
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(ReadSlabAllocator)
+  SET_SELF_SIZE(ReadSlabAllocator)
+
+ private:
+  ReadSlab* NewSlab();
+  void RetireCurrentSlab();
+  // Called when the JS side of a retired slab has been garbage collected.
+  void OnSlabCollected(ReadSlab* slab);
+
+  Environment* const env_;
+  const size_t slab_size_;
+  ReadSlab* current_ = nullptr;
+  std::vector<char*> free_slabs_;
+  std::unordered_set<ReadSlab*> live_slabs_;
+  uint64_t slabs_created_ = 0;
+  uint64_t slabs_recycled_ = 0;
+
+  friend class ReadSlab;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
@@ -26,7 +26,9 @@
 #include "string_bytes.h"
 #include "util-inl.h"
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 
 
 namespace node {
@@ -50,59 +52,21 @@ using v8::Object;
 using v8::String;
 using v8::Value;
 
-void SyncProcessOutputBuffer::OnAlloc(size_t suggested_size,
-                                      uv_buf_t* buf) const {
-  if (used() == kBufferSize)
-    *buf = uv_buf_init(nullptr, 0);
-  else
-    *buf = uv_buf_init(data_ + used(), available());
-}
-
-
-void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
-  // If we hand out the same chunk twice, this should catch it.
-  CHECK_EQ(buf->base, data_ + used());
-  used_ += static_cast<unsigned int>(nread);
-}
-
-
-size_t SyncProcessOutputBuffer::Copy(char* dest) const {
-  memcpy(dest, data_, used());
-  return used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::available() const {
-  return sizeof data_ - used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::used() const {
-  return used_;
-}
-
-
-SyncProcessOutputBuffer* SyncProcessOutputBuffer::next() const {
-  return next_;
-}
-
-
-void SyncProcessOutputBuffer::set_next(SyncProcessOutputBuffer* next) {
-  next_ = next;
-}
-
-
 SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
                                            bool readable,
                                            bool writable,
-                                           uv_buf_t input_buffer)
+                                           uv_buf_t input_buffer,
+                                           const uv_buf_t* output_buffer)
     : process_handler_(process_handler),
       readable_(readable),
       writable_(writable),
       input_buffer_(input_buffer),
 
-      first_output_buffer_(nullptr),
-      last_output_buffer_(nullptr),
+      output_(uv_buf_init(nullptr, 0)),
+      output_length_(0),
+      external_output_(output_buffer != nullptr),
+      overflow_byte_(0),
+      overflow_error_(UV_ENOBUFS),
 
       uv_pipe_(),
       write_req_(),
@@ -110,19 +74,16 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
 
       lifecycle_(kUninitialized) {
   CHECK(readable || writable);
+  if (external_output_)
+    output_ = *output_buffer;
 }
 
 
 SyncProcessStdioPipe::~SyncProcessStdioPipe() {
   CHECK(lifecycle_ == kUninitialized || lifecycle_ == kClosed);
 
-  SyncProcessOutputBuffer* buf;
-  SyncProcessOutputBuffer* next;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = next) {
-    next = buf->next();
-    delete buf;
-  }
+  if (!external_output_ && output_.base != nullptr)
+    process_handler_->env()->Free(output_.base, output_.len);
 }
 
 
@@ -184,11 +145,17 @@ void SyncProcessStdioPipe::Close() {
 }
 
 
-Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) const {
-  size_t length = OutputLength();
-  Local<Object> js_buffer = Buffer::New(env, length).ToLocalChecked();
-  CopyOutput(Buffer::Data(js_buffer));
-  return js_buffer;
+Local<Value> SyncProcessStdioPipe::GetOutput(Environment* env) {
+  if (external_output_)
+    return Number::New(env->isolate(), static_cast<double>(output_length_));
+
+  AllocatedBuffer buffer(env, output_);
+  output_ = uv_buf_init(nullptr, 0);
+  // Give back the unused part of the allocation. This usually happens in
+  // place, so the output is never copied.
+  if (buffer.size() != output_length_)
+    buffer.Resize(output_length_);
+  return buffer.ToBuffer().ToLocalChecked();
 }
 
 
@@ -231,45 +198,52 @@ uv_handle_t* SyncProcessStdioPipe::uv_handle() const {
 }
 
 
-size_t SyncProcessStdioPipe::OutputLength() const {
-  SyncProcessOutputBuffer* buf;
-  size_t size = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    size += buf->used();
-
-  return size;
-}
-
-
-void SyncProcessStdioPipe::CopyOutput(char* dest) const {
-  SyncProcessOutputBuffer* buf;
-  size_t offset = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    offset += buf->Copy(dest + offset);
+int SyncProcessStdioPipe::GrowOutput() {
+  if (external_output_)
+    return UV_ENOBUFS;
+
+  // Like a single read, the first allocation may exceed `maxBuffer`.
+  size_t limit = process_handler_->OutputSizeLimit();
+  if (limit < kInitialOutputSize)
+    limit = kInitialOutputSize;
+  size_t size = output_.len == 0 ? kInitialOutputSize : output_.len * 2;
+  if (size < output_.len || size > limit)
+    size = limit;
+  if (size <= output_.len)
+    return UV_ENOBUFS;
+
+  Environment* env = process_handler_->env();
+  char* data = output_.base == nullptr ?
+      env->AllocateUnchecked(size) :
+      env->Reallocate(output_.base, output_.len, size);
+  if (data == nullptr)
+    return UV_ENOMEM;
+  // Not using `uv_buf_init` here because it takes an unsigned int.
+  output_.base = data;
+  output_.len = size;
+  return 0;
 }
 
 
 void SyncProcessStdioPipe::OnAlloc(size_t suggested_size, uv_buf_t* buf) {
   // This function assumes that libuv will never allocate two buffers for the
-  // same stream at the same time. There's an assert in
-  // SyncProcessOutputBuffer::OnRead that would fail if this assumption was
-  // ever violated.
-
-  if (last_output_buffer_ == nullptr) {
-    // Allocate the first capture buffer.
-    first_output_buffer_ = new SyncProcessOutputBuffer();
-    last_output_buffer_ = first_output_buffer_;
-
-  } else if (last_output_buffer_->available() == 0) {
-    // The current capture buffer is full so get us a new one.
-    SyncProcessOutputBuffer* buf = new SyncProcessOutputBuffer();
-    last_output_buffer_->set_next(buf);
-    last_output_buffer_ = buf;
+  // same stream at the same time. There's an assert in OnRead() that would
+  // fail if this assumption was ever violated.
+
+  if (output_length_ == output_.len) {
+    int r = GrowOutput();
+    if (r < 0) {
+      overflow_error_ = r;
+      *buf = uv_buf_init(&overflow_byte_, 1);
+      return;
+    }
   }
 
-  last_output_buffer_->OnAlloc(suggested_size, buf);
+  // `uv_buf_init` takes an unsigned int.
+  size_t available = std::min<size_t>(output_.len - output_length_,
+                                      std::numeric_limits<unsigned int>::max());
+  *buf = uv_buf_init(output_.base + output_length_,
+                     static_cast<unsigned int>(available));
 }
 
 
@@ -282,8 +256,17 @@ void SyncProcessStdioPipe::OnRead(const uv_buf_t* buf, ssize_t nread) {
     // At some point libuv should really implicitly stop reading on error.
     uv_read_stop(uv_stream());
 
+  } else if (buf->base == &overflow_byte_) {
+    // There is more output than fits into the output buffer.
+    if (nread > 0) {
+      process_handler_->SetError(overflow_error_);
+      process_handler_->Kill();
+    }
+
   } else {
-    last_output_buffer_->OnRead(buf, nread);
+    // If we hand out the same chunk twice, this should catch it.
+    CHECK_EQ(buf->base, output_.base + output_length_);
+    output_length_ += nread;
     process_handler_->IncrementBufferSizeAndCheckOverflow(nread);
   }
 }
@@ -630,6 +613,17 @@ void SyncProcessRunner::IncrementBufferSizeAndCheckOverflow(ssize_t length) {
 }
 
 
+size_t SyncProcessRunner::OutputSizeLimit() const {
+  // Allow for one byte more than `maxBuffer`, so that the overflow is
+  // detected by IncrementBufferSizeAndCheckOverflow().
+  if (max_buffer_ > 0 &&
+      max_buffer_ < static_cast<double>(std::numeric_limits<size_t>::max())) {
+    return static_cast<size_t>(max_buffer_) + 1;
+  }
+  return std::numeric_limits<size_t>::max();
+}
+
+
 void SyncProcessRunner::OnExit(int64_t exit_status, int term_signal) {
   if (exit_status < 0)
     return SetError(static_cast<int>(exit_status));
@@ -727,7 +721,7 @@ Local<Array> SyncProcessRunner::BuildOutputArray() {
   for (uint32_t i = 0; i < stdio_pipes_.size(); i++) {
     SyncProcessStdioPipe* h = stdio_pipes_[i].get();
     if (h != nullptr && h->writable())
-      js_output->Set(context, i, h->GetOutputAsBuffer(env())).Check();
+      js_output->Set(context, i, h->GetOutput(env())).Check();
     else
       js_output->Set(context, i, Null(env()->isolate())).Check();
   }
@@ -912,7 +906,24 @@ int SyncProcessRunner::ParseStdioOption(int child_fd,
       }
     }
 
-    return AddStdioPipe(child_fd, readable, writable, buf);
+    uv_buf_t output_buffer;
+    bool has_output_buffer = false;
+
+    if (writable) {
+      Local<Value> output =
+          js_stdio_option->Get(context, env()->output_string())
+              .ToLocalChecked();
+      if (Buffer::HasInstance(output)) {
+        output_buffer.base = Buffer::Data(output);
+        output_buffer.len = Buffer::Length(output);
+        has_output_buffer = true;
+      } else if (!output->IsUndefined()) {
+        return UV_EINVAL;
+      }
+    }
+
+    return AddStdioPipe(child_fd, readable, writable, buf,
+                        has_output_buffer ? &output_buffer : nullptr);
 
   } else if (js_type->StrictEquals(env()->inherit_string()) ||
              js_type->StrictEquals(env()->fd_string())) {
@@ -940,12 +951,14 @@ int SyncProcessRunner::AddStdioIgnore(uint32_t child_fd) {
 int SyncProcessRunner::AddStdioPipe(uint32_t child_fd,
                                     bool readable,
                                     bool writable,
-                                    uv_buf_t input_buffer) {
+                                    uv_buf_t input_buffer,
+                                    const uv_buf_t* output_buffer) {
   CHECK_LT(child_fd, stdio_count_);
   CHECK(!stdio_pipes_[child_fd]);
 
   std::unique_ptr<SyncProcessStdioPipe> h(
-      new SyncProcessStdioPipe(this, readable, writable, input_buffer));
+      new SyncProcessStdioPipe(this, readable, writable, input_buffer,
+                               output_buffer));
 
   int r = h->Initialize(uv_loop_);
   if (r < 0) {
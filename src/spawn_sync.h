@@ -32,37 +32,10 @@ namespace node {
 
 
 
-class SyncProcessOutputBuffer;
 class SyncProcessStdioPipe;
 class SyncProcessRunner;
 
 
-class SyncProcessOutputBuffer {
-  static const unsigned int kBufferSize = 65536;
-
- public:
-  inline SyncProcessOutputBuffer() = default;
-
-  inline void OnAlloc(size_t suggested_size, uv_buf_t* buf) const;
-  inline void OnRead(const uv_buf_t* buf, size_t nread);
-
-  inline size_t Copy(char* dest) const;
-
-  inline unsigned int available() const;
-  inline unsigned int used() const;
-
-  inline SyncProcessOutputBuffer* next() const;
-  inline void set_next(SyncProcessOutputBuffer* next);
-
- private:
-  // Use unsigned int because that's what `uv_buf_init` takes.
-  mutable char data_[kBufferSize];
-  unsigned int used_ = 0;
-
-  SyncProcessOutputBuffer* next_ = nullptr;
-};
-
-
 class SyncProcessStdioPipe {
   enum Lifecycle {
     kUninitialized = 0,
@@ -72,18 +45,26 @@ class SyncProcessStdioPipe {
     kClosed
   };
 
+  static const size_t kInitialOutputSize = 65536;
+
  public:
+  // If `output_buffer` is set, output is read into that buffer instead of
+  // memory that is allocated by the pipe.
   SyncProcessStdioPipe(SyncProcessRunner* process_handler,
                        bool readable,
                        bool writable,
-                       uv_buf_t input_buffer);
+                       uv_buf_t input_buffer,
+                       const uv_buf_t* output_buffer);
   ~SyncProcessStdioPipe();
 
   int Initialize(uv_loop_t* loop);
   int Start();
   void Close();
 
-  v8::Local<v8::Object> GetOutputAsBuffer(Environment* env) const;
+  // Returns the output as a Buffer, without copying it. If the output was
+  // read into a buffer supplied by the caller, returns the number of bytes
+  // that were written to it instead.
+  v8::Local<v8::Value> GetOutput(Environment* env);
 
   inline bool readable() const;
   inline bool writable() const;
@@ -94,8 +75,7 @@ class SyncProcessStdioPipe {
   inline uv_handle_t* uv_handle() const;
 
  private:
-  inline size_t OutputLength() const;
-  inline void CopyOutput(char* dest) const;
+  int GrowOutput();
 
   inline void OnAlloc(size_t suggested_size, uv_buf_t* buf);
   inline void OnRead(const uv_buf_t* buf, ssize_t nread);
@@ -121,8 +101,16 @@ class SyncProcessStdioPipe {
   bool writable_;
   uv_buf_t input_buffer_;
 
-  SyncProcessOutputBuffer* first_output_buffer_;
-  SyncProcessOutputBuffer* last_output_buffer_;
+  // Output is stored contiguously. Memory allocated by the pipe is grown
+  // geometrically up to the runner's output limit, and handed to JS as is
+  // once the process has exited.
+  uv_buf_t output_;
+  size_t output_length_;
+  bool external_output_;
+  // Once `output_` is full, one more byte is read into `overflow_byte_` to
+  // find out whether the child has more output than fits.
+  char overflow_byte_;
+  int overflow_error_;
 
   mutable uv_pipe_t uv_pipe_;
   uv_write_t write_req_;
@@ -163,6 +151,7 @@ class SyncProcessRunner {
 
   void Kill();
   void IncrementBufferSizeAndCheckOverflow(ssize_t length);
+  size_t OutputSizeLimit() const;
 
   void OnExit(int64_t exit_status, int term_signal);
   void OnKillTimerTimeout();
@@ -182,7 +171,8 @@ class SyncProcessRunner {
   inline int AddStdioPipe(uint32_t child_fd,
                           bool readable,
                           bool writable,
-                          uv_buf_t input_buffer);
+                          uv_buf_t input_buffer,
+                          const uv_buf_t* output_buffer);
   inline int AddStdioInheritFD(uint32_t child_fd, int inherit_fd);
 
   static bool IsSet(v8::Local<v8::Value> value);
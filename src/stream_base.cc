@@ -7,6 +7,8 @@
 #include "node_errors.h"
 #include "env-inl.h"
 #include "js_stream.h"
+#include "slab_allocator.h"
+#include "stream_framing.h"
 #include "string_bytes.h"
 #include "util-inl.h"
 #include "v8.h"
@@ -26,9 +28,11 @@ using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::MaybeLocal;
 using v8::Object;
 using v8::ReadOnly;
 using v8::String;
+using v8::Uint32;
 using v8::Value;
 
 template int StreamBase::WriteString<ASCII>(
@@ -161,6 +165,45 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+int StreamBase::UseUserBuffer(const FunctionCallbackInfo<Value>& args) {
+  CHECK(Buffer::HasInstance(args[0]));
+
+  uv_buf_t buf = uv_buf_init(Buffer::Data(args[0]), Buffer::Length(args[0]));
+  PushStreamListener(new CustomBufferJSListener(buf));
+  return 0;
+}
+
+
+int StreamBase::UseLengthPrefixedFraming(
+    const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());  // headerSize
+  CHECK(args[1]->IsUint32());  // lengthOffset
+  CHECK(args[2]->IsUint32());  // lengthSize
+  CHECK(args[5]->IsUint32());  // maxFrameSize
+
+  PushStreamListener(new LengthPrefixedFramer(
+      args[0].As<Uint32>()->Value(),
+      args[1].As<Uint32>()->Value(),
+      args[2].As<Uint32>()->Value(),
+      args[3]->IsTrue(),
+      args[4]->IsTrue(),
+      args[5].As<Uint32>()->Value()));
+  return 0;
+}
+
+int StreamBase::UseDelimiterFraming(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsArrayBufferView());  // delimiter
+  CHECK(args[1]->IsUint32());  // maxFrameSize
+
+  ArrayBufferViewContents<char> delimiter(args[0]);
+  CHECK_GT(delimiter.length(), 0);
+  PushStreamListener(new DelimiterFramer(
+      std::string(delimiter.data(), delimiter.length()),
+      args[1].As<Uint32>()->Value()));
+  return 0;
+}
+
+
 int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsObject());
 
@@ -291,33 +334,40 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-void StreamBase::CallJSOnreadMethod(ssize_t nread,
-                                    Local<ArrayBuffer> ab,
-                                    size_t offset) {
+MaybeLocal<Value> StreamBase::CallJSOnreadMethod(ssize_t nread,
+                                                 Local<ArrayBuffer> ab,
+                                                 size_t offset,
+                                                 StreamBaseJSChecks checks,
+                                                 Local<Array> frame_ends) {
   Environment* env = env_;
 
   DCHECK_EQ(static_cast<int32_t>(nread), nread);
   DCHECK_LE(offset, INT32_MAX);
 
-  if (ab.IsEmpty()) {
-    DCHECK_EQ(offset, 0);
-    DCHECK_LE(nread, 0);
-  } else {
-    DCHECK_GE(nread, 0);
+  if (checks == DONT_SKIP_NREAD_CHECKS) {
+    if (ab.IsEmpty()) {
+      DCHECK_EQ(offset, 0);
+      DCHECK_LE(nread, 0);
+    } else {
+      DCHECK_GE(nread, 0);
+    }
   }
 
   env->stream_base_state()[kReadBytesOrError] = nread;
   env->stream_base_state()[kArrayBufferOffset] = offset;
 
   Local<Value> argv[] = {
-    ab.IsEmpty() ? Undefined(env->isolate()).As<Value>() : ab.As<Value>()
+    ab.IsEmpty() ? Undefined(env->isolate()).As<Value>() : ab.As<Value>(),
+    frame_ends.IsEmpty() ? Undefined(env->isolate()).As<Value>() :
+                           frame_ends.As<Value>()
   };
+  int argc = frame_ends.IsEmpty() ? 1 : 2;
 
   AsyncWrap* wrap = GetAsyncWrap();
   CHECK_NOT_NULL(wrap);
   Local<Value> onread = wrap->object()->GetInternalField(kOnReadFunctionField);
   CHECK(onread->IsFunction());
-  wrap->MakeCallback(onread.As<Function>(), arraysize(argv), argv);
+  return wrap->MakeCallback(onread.As<Function>(), argc, argv);
 }
 
 
@@ -368,6 +418,14 @@ void StreamBase::AddMethods(Environment* env, Local<FunctionTemplate> t) {
   env->SetProtoMethod(t, "shutdown", JSMethod<&StreamBase::Shutdown>);
   env->SetProtoMethod(t, "writev", JSMethod<&StreamBase::Writev>);
   env->SetProtoMethod(t, "writeBuffer", JSMethod<&StreamBase::WriteBuffer>);
+  env->SetProtoMethod(
+      t, "useUserBuffer", JSMethod<&StreamBase::UseUserBuffer>);
+  env->SetProtoMethod(t,
+                      "useLengthPrefixedFraming",
+                      JSMethod<&StreamBase::UseLengthPrefixedFraming>);
+  env->SetProtoMethod(t,
+                      "useDelimiterFraming",
+                      JSMethod<&StreamBase::UseDelimiterFraming>);
   env->SetProtoMethod(
       t, "writeAsciiString", JSMethod<&StreamBase::WriteString<ASCII>>);
   env->SetProtoMethod(
@@ -448,6 +506,11 @@ void StreamResource::ClearError() {
 uv_buf_t EmitToJSStreamListener::OnStreamAlloc(size_t suggested_size) {
   CHECK_NOT_NULL(stream_);
   Environment* env = static_cast<StreamBase*>(stream_)->stream_env();
+  ReadSlabAllocator* slab_allocator = env->read_slab_allocator();
+  if (slab_allocator != nullptr) {
+    CHECK_NULL(pending_slab_);
+    return slab_allocator->Allocate(suggested_size, &pending_slab_);
+  }
   return env->AllocateManaged(suggested_size).release();
 }
 
@@ -457,6 +520,20 @@ void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf_) {
   Environment* env = stream->stream_env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
+
+  if (pending_slab_ != nullptr) {
+    ReadSlab* slab = pending_slab_;
+    pending_slab_ = nullptr;
+    size_t offset;
+    Local<ArrayBuffer> ab =
+        env->read_slab_allocator()->Commit(slab, buf_, nread, &offset);
+    if (nread < 0)
+      stream->CallJSOnreadMethod(nread, Local<ArrayBuffer>());
+    else if (nread > 0)
+      stream->CallJSOnreadMethod(nread, ab, offset);
+    return;
+  }
+
   AllocatedBuffer buf(env, buf_);
 
   if (nread <= 0)  {
@@ -472,6 +549,41 @@ void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf_) {
 }
 
 
+
+uv_buf_t CustomBufferJSListener::OnStreamAlloc(size_t suggested_size) {
+  return buffer_;
+}
+
+
+void CustomBufferJSListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
+  CHECK_NOT_NULL(stream_);
+
+  StreamBase* stream = static_cast<StreamBase*>(stream_);
+  Environment* env = stream->stream_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  // In the case that there's an error and buf is null, return early.
+  if (nread < 0 || buf.base == nullptr) {
+    stream->CallJSOnreadMethod(nread, Local<ArrayBuffer>());
+    return;
+  }
+
+  CHECK_EQ(buf.base, buffer_.base);
+
+  MaybeLocal<Value> ret = stream->CallJSOnreadMethod(nread,
+                             Local<ArrayBuffer>(),
+                             0,
+                             StreamBase::SKIP_NREAD_CHECKS);
+  // The JS side may return a new buffer to read the next chunk of data into.
+  Local<Value> next_buf_v;
+  if (ret.ToLocal(&next_buf_v) && !next_buf_v->IsUndefined()) {
+    buffer_.base = Buffer::Data(next_buf_v);
+    buffer_.len = Buffer::Length(next_buf_v);
+  }
+}
+
+
 void ReportWritesToJSStreamListener::OnStreamAfterReqFinished(
     StreamReq* req_wrap, int status) {
   StreamBase* stream = static_cast<StreamBase*>(stream_);
@@ -17,6 +17,7 @@ class ShutdownWrap;
 class WriteWrap;
 class StreamBase;
 class StreamResource;
+class ReadSlab;
 
 struct StreamWriteResult {
   bool async;
@@ -173,10 +174,32 @@ class ReportWritesToJSStreamListener : public StreamListener {
 
 // A default emitter that just pushes data chunks as Buffer instances to
 // JS land via the handle’s .ondata method.
+// If the Environment has a `ReadSlabAllocator`, data is read into shared
+// slabs and the Buffers are views into those.
 class EmitToJSStreamListener : public ReportWritesToJSStreamListener {
  public:
   uv_buf_t OnStreamAlloc(size_t suggested_size) override;
   void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+
+ private:
+  // The slab backing the buffer returned from the last `OnStreamAlloc()`
+  // call, if any.
+  ReadSlab* pending_slab_ = nullptr;
+};
+
+
+// An alternative listener that uses a custom, user-provided buffer
+// for reading data.
+class CustomBufferJSListener : public ReportWritesToJSStreamListener {
+ public:
+  uv_buf_t OnStreamAlloc(size_t suggested_size) override;
+  void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+  void OnStreamDestroy() override { delete this; }
+
+  explicit CustomBufferJSListener(uv_buf_t buffer) : buffer_(buffer) {}
+
+ private:
+  uv_buf_t buffer_;
 };
 
 
@@ -265,6 +288,8 @@ class StreamBase : public StreamResource {
   static constexpr int kOnReadFunctionField = 2;
   static constexpr int kStreamBaseFieldCount = 3;
 
+  enum StreamBaseJSChecks { DONT_SKIP_NREAD_CHECKS, SKIP_NREAD_CHECKS };
+
   static void AddMethods(Environment* env,
                          v8::Local<v8::FunctionTemplate> target);
 
@@ -273,9 +298,18 @@ class StreamBase : public StreamResource {
   virtual bool IsIPCPipe();
   virtual int GetFD();
 
-  void CallJSOnreadMethod(ssize_t nread,
-                          v8::Local<v8::ArrayBuffer> ab,
-                          size_t offset = 0);
+  // Call the JS `onread` method. If `checks` is `SKIP_NREAD_CHECKS`,
+  // `ab` may be empty even though `nread` is positive, which is the case
+  // when data was read into a user-provided buffer.
+  // If `frame_ends` is not empty, it is passed as a second argument, and
+  // contains the end offsets of the frames in `ab` that were split off by
+  // a `FramingStreamListener`.
+  v8::MaybeLocal<v8::Value> CallJSOnreadMethod(
+      ssize_t nread,
+      v8::Local<v8::ArrayBuffer> ab,
+      size_t offset = 0,
+      StreamBaseJSChecks checks = DONT_SKIP_NREAD_CHECKS,
+      v8::Local<v8::Array> frame_ends = v8::Local<v8::Array>());
 
   // This is named `stream_env` to avoid name clashes, because a lot of
   // subclasses are also `BaseObject`s.
@@ -321,6 +355,10 @@ class StreamBase : public StreamResource {
   int Shutdown(const v8::FunctionCallbackInfo<v8::Value>& args);
   int Writev(const v8::FunctionCallbackInfo<v8::Value>& args);
   int WriteBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  int UseUserBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  int UseLengthPrefixedFraming(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  int UseDelimiterFraming(const v8::FunctionCallbackInfo<v8::Value>& args);
   template <enum encoding enc>
   int WriteString(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -0,0 +1,237 @@
+#include "stream_framing.h"
+#include "stream_base-inl.h"
+
+#include "env-inl.h"
+#include "util-inl.h"
+
+#include <algorithm>  // std::max()
+#include <cstring>  // memchr(), memcmp(), memcpy()
+
+namespace node {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::HandleScope;
+using v8::Local;
+using v8::Number;
+using v8::Value;
+
+uv_buf_t FramingStreamListener::OnStreamAlloc(size_t suggested_size) {
+  CHECK_NOT_NULL(stream_);
+  Environment* env = static_cast<StreamBase*>(stream_)->stream_env();
+
+  // Make sure there is room for at least the rest of the current frame,
+  // if its size is known.
+  size_t wanted = std::max(suggested_size,
+                           bytes_needed_ > used_ ? bytes_needed_ - used_ : 0);
+  if (buffer_.data() == nullptr) {
+    CHECK_EQ(used_, 0);
+    buffer_ = env->AllocateManaged(wanted);
+  } else if (buffer_.size() - used_ < wanted) {
+    buffer_.Resize(used_ + wanted);
+  }
+
+  return uv_buf_init(buffer_.data() + used_, buffer_.size() - used_);
+}
+
+void FramingStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
+  CHECK_NOT_NULL(stream_);
+  StreamBase* stream = static_cast<StreamBase*>(stream_);
+  Environment* env = stream->stream_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  if (nread < 0) {
+    // The stream ended in the middle of a frame.
+    if (nread == UV_EOF && used_ > 0 && !EmitsTrailingData())
+      return OnFrameError(UV_EPROTO);
+
+    // Pass on data that is not followed by a frame delimiter, if the framing
+    // format allows that.
+    if (nread == UV_EOF && used_ > 0 && EmitsTrailingData()) {
+      Local<Array> frame_ends = Array::New(env->isolate(), 1);
+      if (frame_ends->Set(env->context(),
+                          0,
+                          Number::New(env->isolate(), used_)).IsNothing()) {
+        return;
+      }
+      AllocatedBuffer frames = std::move(buffer_);
+      frames.Resize(used_);
+      size_t complete = used_;
+      used_ = 0;
+      bytes_needed_ = 0;
+      OnFrameDone();
+      stream->CallJSOnreadMethod(complete,
+                                 frames.ToArrayBuffer(),
+                                 0,
+                                 StreamBase::DONT_SKIP_NREAD_CHECKS,
+                                 frame_ends);
+      // JS may have closed the stream while handling the final frame. The
+      // stream and this listener stay alive until the close has finished,
+      // so it is still safe to check.
+      if (!stream->IsAlive() || stream->IsClosing())
+        return;
+    }
+    stream->CallJSOnreadMethod(nread, Local<ArrayBuffer>());
+    return;
+  }
+  if (nread == 0)
+    return;
+
+  CHECK_EQ(buf.base, buffer_.data() + used_);
+  used_ += nread;
+
+  // Split off as many complete frames as possible.
+  Local<Array> frame_ends = Array::New(env->isolate());
+  uint32_t frame_count = 0;
+  size_t complete = 0;
+  while (complete < used_) {
+    size_t bytes_needed = 0;
+    ssize_t frame_size = NextFrameSize(buffer_.data() + complete,
+                                       used_ - complete,
+                                       &bytes_needed);
+    if (frame_size < 0)
+      return OnFrameError(frame_size);
+    if (frame_size == 0) {
+      bytes_needed_ = bytes_needed;
+      if (bytes_needed_ > max_frame_size_ ||
+          used_ - complete > max_frame_size_) {
+        return OnFrameError(UV_EMSGSIZE);
+      }
+      break;
+    }
+    if (static_cast<size_t>(frame_size) > max_frame_size_)
+      return OnFrameError(UV_EMSGSIZE);
+
+    OnFrameDone();
+    complete += frame_size;
+    // Frame ends point to the end of the frame's contents, i.e. they do not
+    // include a trailing delimiter.
+    size_t frame_end = complete - FrameTrailerSize();
+    if (frame_ends->Set(env->context(),
+                        frame_count++,
+                        Number::New(env->isolate(), frame_end)).IsNothing()) {
+      return;
+    }
+  }
+
+  if (complete == 0)
+    return;
+
+  // Keep the incomplete frame, if any, for the next read.
+  AllocatedBuffer frames = std::move(buffer_);
+  size_t remaining = used_ - complete;
+  used_ = 0;
+  if (remaining > 0) {
+    buffer_ = env->AllocateManaged(std::max(remaining, bytes_needed_));
+    memcpy(buffer_.data(), frames.data() + complete, remaining);
+    used_ = remaining;
+  } else {
+    bytes_needed_ = 0;
+  }
+  frames.Resize(complete);
+
+  stream->CallJSOnreadMethod(complete,
+                             frames.ToArrayBuffer(),
+                             0,
+                             StreamBase::DONT_SKIP_NREAD_CHECKS,
+                             frame_ends);
+}
+
+void FramingStreamListener::OnFrameError(int err) {
+  StreamBase* stream = static_cast<StreamBase*>(stream_);
+  buffer_.clear();
+  used_ = 0;
+  bytes_needed_ = 0;
+  OnFrameDone();
+  stream->ReadStop();
+  stream->CallJSOnreadMethod(err, Local<ArrayBuffer>());
+}
+
+
+LengthPrefixedFramer::LengthPrefixedFramer(size_t header_size,
+                                           size_t length_offset,
+                                           size_t length_size,
+                                           bool little_endian,
+                                           bool length_includes_header,
+                                           size_t max_frame_size)
+    : FramingStreamListener(max_frame_size),
+      header_size_(header_size),
+      length_offset_(length_offset),
+      length_size_(length_size),
+      little_endian_(little_endian),
+      length_includes_header_(length_includes_header) {
+  CHECK(length_size_ == 1 || length_size_ == 2 || length_size_ == 4);
+  CHECK_LE(length_offset_ + length_size_, header_size_);
+}
+
+ssize_t LengthPrefixedFramer::NextFrameSize(const char* data,
+                                            size_t len,
+                                            size_t* bytes_needed) {
+  if (len < header_size_) {
+    *bytes_needed = header_size_;
+    return 0;
+  }
+
+  const unsigned char* field =
+      reinterpret_cast<const unsigned char*>(data + length_offset_);
+  uint64_t length = 0;
+  for (size_t i = 0; i < length_size_; i++) {
+    size_t shift = 8 * (little_endian_ ? i : length_size_ - 1 - i);
+    length |= static_cast<uint64_t>(field[i]) << shift;
+  }
+
+  uint64_t frame_size =
+      length_includes_header_ ? length : header_size_ + length;
+  if (frame_size < header_size_ || frame_size > max_frame_size())
+    return UV_EMSGSIZE;
+
+  if (len < frame_size) {
+    *bytes_needed = frame_size;
+    return 0;
+  }
+  return static_cast<ssize_t>(frame_size);
+}
+
+
+DelimiterFramer::DelimiterFramer(std::string&& delimiter,
+                                 size_t max_frame_size)
+    : FramingStreamListener(max_frame_size),
+      delimiter_(std::move(delimiter)) {
+  CHECK(!delimiter_.empty());
+}
+
+ssize_t DelimiterFramer::NextFrameSize(const char* data,
+                                       size_t len,
+                                       size_t* bytes_needed) {
+  const size_t delimiter_size = delimiter_.size();
+  const char first = delimiter_[0];
+  const char* const end = data + len;
+  const char* pos = data + scanned_;
+
+  // memchr() is vectorized by the C library, which makes it considerably
+  // faster than a byte-by-byte loop for the common single-byte case.
+  while (pos < end) {
+    const char* match =
+        static_cast<const char*>(memchr(pos, first, end - pos));
+    if (match == nullptr)
+      break;
+    if (static_cast<size_t>(end - match) < delimiter_size) {
+      // A partial delimiter at the end of the data; look at it again once
+      // more data has arrived.
+      scanned_ = match - data;
+      return 0;
+    }
+    if (delimiter_size == 1 ||
+        memcmp(match + 1, delimiter_.data() + 1, delimiter_size - 1) == 0) {
+      return static_cast<ssize_t>(match - data + delimiter_size);
+    }
+    pos = match + 1;
+  }
+
+  scanned_ = len;
+  return 0;
+}
+
+}  // namespace node
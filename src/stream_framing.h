@@ -0,0 +1,115 @@
+#ifndef SRC_STREAM_FRAMING_H_
+#define SRC_STREAM_FRAMING_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "stream_base.h"
+
+#include <string>
+
+namespace node {
+
+// Base class for listeners that split the incoming data into frames in C++,
+// and only pass complete frames to JS. All frames that are completed by a
+// single read are passed to JS in one call, as one ArrayBuffer plus an
+// array of the frames' end offsets.
+// Only the incomplete frame at the end of a read, if any, is copied; the
+// memory holding the complete frames is handed over to JS.
+class FramingStreamListener : public ReportWritesToJSStreamListener {
+ public:
+  explicit FramingStreamListener(size_t max_frame_size)
+      : max_frame_size_(max_frame_size) {}
+
+  uv_buf_t OnStreamAlloc(size_t suggested_size) override;
+  void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+  void OnStreamDestroy() override { delete this; }
+
+ protected:
+  // Returns the size of the frame at the start of `data` if it is complete,
+  // 0 if more data is needed, or a negative libuv error code if the data is
+  // not valid. `len` is never 0. If 0 is returned, `*bytes_needed` may be
+  // set to the number of bytes that are known to be required for the frame
+  // to be complete.
+  virtual ssize_t NextFrameSize(const char* data,
+                                size_t len,
+                                size_t* bytes_needed) = 0;
+
+  // Called whenever a frame has been split off, or the pending data has been
+  // discarded, so that subclasses can reset per-frame state.
+  virtual void OnFrameDone() {}
+
+  // The number of bytes at the end of each frame that are not part of
+  // the frame's contents, e.g. a delimiter.
+  virtual size_t FrameTrailerSize() const { return 0; }
+
+  // Whether data that is left over at the end of the stream is passed to
+  // JS as a final frame, rather than being discarded.
+  virtual bool EmitsTrailingData() const { return false; }
+
+  inline size_t max_frame_size() const { return max_frame_size_; }
+
+ private:
+  void OnFrameError(int err);
+
+  const size_t max_frame_size_;
+  // Holds the data of the current read, starting with the beginning of
+  // an incomplete frame.
+  AllocatedBuffer buffer_;
+  size_t used_ = 0;
+  size_t bytes_needed_ = 0;
+};
+
+
+// Splits data into frames that start with a fixed-size header containing
+// the frame's length as an unsigned integer.
+class LengthPrefixedFramer : public FramingStreamListener {
+ public:
+  LengthPrefixedFramer(size_t header_size,
+                       size_t length_offset,
+                       size_t length_size,
+                       bool little_endian,
+                       bool length_includes_header,
+                       size_t max_frame_size);
+
+ protected:
+  ssize_t NextFrameSize(const char* data,
+                        size_t len,
+                        size_t* bytes_needed) override;
+
+ private:
+  const size_t header_size_;
+  const size_t length_offset_;
+  const size_t length_size_;
+  const bool little_endian_;
+  const bool length_includes_header_;
+};
+
+
+// Splits data into frames that are terminated by a delimiter, e.g. lines.
+// The delimiter is not part of the frames' contents, and data after the last
+// delimiter is passed on as a final frame at the end of the stream.
+class DelimiterFramer : public FramingStreamListener {
+ public:
+  DelimiterFramer(std::string&& delimiter, size_t max_frame_size);
+
+ protected:
+  ssize_t NextFrameSize(const char* data,
+                        size_t len,
+                        size_t* bytes_needed) override;
+  void OnFrameDone() override { scanned_ = 0; }
+  size_t FrameTrailerSize() const override { return delimiter_.size(); }
+  bool EmitsTrailingData() const override { return true; }
+
+ private:
+  const std::string delimiter_;
+  // The number of bytes of the current frame that are known not to contain
+  // the start of a delimiter, so that they are not scanned again when more
+  // data arrives.
+  size_t scanned_ = 0;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_STREAM_FRAMING_H_
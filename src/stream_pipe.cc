@@ -3,10 +3,13 @@
 #include "node_buffer.h"
 #include "util-inl.h"
 
+using v8::Array;
 using v8::Context;
+using v8::External;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Global;
 using v8::Local;
 using v8::Object;
 using v8::Value;
@@ -15,7 +18,8 @@ namespace node {
 
 StreamPipe::StreamPipe(StreamBase* source,
                        StreamBase* sink,
-                       Local<Object> obj)
+                       Local<Object> obj,
+                       std::vector<StreamPipeTransform*>&& transforms)
     : AsyncWrap(source->stream_env(), obj, AsyncWrap::PROVIDER_STREAMPIPE) {
   MakeWeak();
 
@@ -39,10 +43,21 @@ StreamPipe::StreamPipe(StreamBase* source,
       .Check();
   sink->GetObject()->Set(env()->context(), env()->pipe_source_string(), obj)
       .Check();
+
+  for (StreamPipeTransform* transform : transforms) {
+    CHECK(!transform->in_pipe_);
+    transform->in_pipe_ = true;
+    transforms_.emplace_back(TransformStage {
+      transform,
+      Global<Object>(env()->isolate(), transform->GetTransformObject())
+    });
+  }
 }
 
 StreamPipe::~StreamPipe() {
   Unpipe();
+  for (TransformStage& stage : transforms_)
+    stage.transform->in_pipe_ = false;
 }
 
 StreamBase* StreamPipe::source() {
@@ -126,15 +141,16 @@ void StreamPipe::ReadableListener::OnStreamRead(ssize_t nread,
     // EOF or error; stop reading and pass the error to the previous listener
     // (which might end up in JS).
     pipe->is_eof_ = true;
+    // Only flush the transforms if the source ended regularly.
+    if (nread != UV_EOF)
+      pipe->transforms_finished_ = true;
     stream()->ReadStop();
     CHECK_NOT_NULL(previous_listener_);
     previous_listener_->OnStreamRead(nread, uv_buf_init(nullptr, 0));
     // If we’re not writing, close now. Otherwise, we’ll do that in
     // `OnStreamAfterWrite()`.
-    if (!pipe->is_writing_) {
-      pipe->ShutdownWritable();
-      pipe->Unpipe();
-    }
+    if (!pipe->is_writing_)
+      pipe->FinishWritable();
     return;
   }
 
@@ -142,19 +158,79 @@ void StreamPipe::ReadableListener::OnStreamRead(ssize_t nread,
 }
 
 void StreamPipe::ProcessData(size_t nread, AllocatedBuffer&& buf) {
-  uv_buf_t buffer = uv_buf_init(buf.data(), nread);
-  StreamWriteResult res = sink()->Write(&buffer, 1);
+  StreamWriteResult res;
+  if (transforms_.empty()) {
+    uv_buf_t buffer = uv_buf_init(buf.data(), nread);
+    res = sink()->Write(&buffer, 1);
+    if (res.async)
+      res.wrap->SetAllocatedStorage(std::move(buf));
+  } else {
+    buf.Resize(nread);
+    std::vector<AllocatedBuffer> chunks;
+    chunks.emplace_back(std::move(buf));
+    int err = RunTransforms(&chunks, false);
+    if (err != 0) {
+      // Treat this like a read error, which will also end up in JS.
+      readable_listener_.OnStreamRead(err, uv_buf_init(nullptr, 0));
+      return;
+    }
+    // If the transforms did not produce any output yet, just keep reading.
+    if (chunks.empty())
+      return;
+    res = WriteChunks(std::move(chunks));
+  }
+
   if (!res.async) {
     writable_listener_.OnStreamAfterWrite(nullptr, res.err);
   } else {
     is_writing_ = true;
     is_reading_ = false;
-    res.wrap->SetAllocatedStorage(std::move(buf));
     if (source() != nullptr)
       source()->ReadStop();
   }
 }
 
+int StreamPipe::RunTransforms(std::vector<AllocatedBuffer>* chunks,
+                              bool finish) {
+  for (TransformStage& stage : transforms_) {
+    int err = stage.transform->TransformChunks(chunks, finish);
+    if (err != 0)
+      return err;
+  }
+  return 0;
+}
+
+StreamWriteResult StreamPipe::WriteChunks(
+    std::vector<AllocatedBuffer>&& chunks) {
+  MaybeStackBuffer<uv_buf_t, 16> bufs(chunks.size());
+  for (size_t i = 0; i < chunks.size(); i++)
+    bufs[i] = uv_buf_init(chunks[i].data(), chunks[i].size());
+  StreamWriteResult res = sink()->Write(*bufs, chunks.size());
+  if (res.async)
+    pending_chunks_ = std::move(chunks);
+  return res;
+}
+
+void StreamPipe::FinishWritable() {
+  if (!transforms_finished_) {
+    transforms_finished_ = true;
+    std::vector<AllocatedBuffer> chunks;
+    if (RunTransforms(&chunks, true) == 0 &&
+        !chunks.empty() &&
+        !sink_destroyed_) {
+      StreamWriteResult res = WriteChunks(std::move(chunks));
+      if (res.async) {
+        // Shutting down will happen in `OnStreamAfterWrite()`.
+        is_writing_ = true;
+        return;
+      }
+    }
+  }
+
+  ShutdownWritable();
+  Unpipe();
+}
+
 void StreamPipe::ShutdownWritable() {
   sink()->Shutdown();
 }
@@ -163,10 +239,10 @@ void StreamPipe::WritableListener::OnStreamAfterWrite(WriteWrap* w,
                                                       int status) {
   StreamPipe* pipe = ContainerOf(&StreamPipe::writable_listener_, this);
   pipe->is_writing_ = false;
+  pipe->pending_chunks_.clear();
   if (pipe->is_eof_) {
     AsyncScope async_scope(pipe);
-    pipe->ShutdownWritable();
-    pipe->Unpipe();
+    pipe->FinishWritable();
     return;
   }
 
@@ -231,7 +307,22 @@ void StreamPipe::New(const FunctionCallbackInfo<Value>& args) {
   StreamBase* source = StreamBase::FromObject(args[0].As<Object>());
   StreamBase* sink = StreamBase::FromObject(args[1].As<Object>());
 
-  new StreamPipe(source, sink, args.This());
+  // The optional third argument is an array of `External`s, as returned
+  // by `getPipeTransform()` methods.
+  std::vector<StreamPipeTransform*> transforms;
+  if (args[2]->IsArray()) {
+    Environment* env = Environment::GetCurrent(args);
+    Local<Array> list = args[2].As<Array>();
+    for (uint32_t i = 0; i < list->Length(); i++) {
+      Local<Value> transform;
+      if (!list->Get(env->context(), i).ToLocal(&transform)) return;
+      CHECK(transform->IsExternal());
+      transforms.push_back(static_cast<StreamPipeTransform*>(
+          transform.As<External>()->Value()));
+    }
+  }
+
+  new StreamPipe(source, sink, args.This(), std::move(transforms));
 }
 
 void StreamPipe::Start(const FunctionCallbackInfo<Value>& args) {
@@ -5,11 +5,56 @@
 
 #include "stream_base.h"
 
+#include <vector>
+
 namespace node {
 
+// A native transform stage that the data of a StreamPipe passes through on
+// its way from the source to the sink, e.g. compression or hashing.
+class StreamPipeTransform {
+ public:
+  virtual ~StreamPipeTransform() = default;
+
+  // Transform the data in `*chunks`, replacing it with the output of the
+  // transform. If `finish` is set, there is no more input, and all remaining
+  // output should be flushed.
+  // Returns 0 or a libuv error code. In the latter case, the transform may
+  // already have reported a more specific error to JS.
+  virtual int TransformChunks(std::vector<AllocatedBuffer>* chunks,
+                              bool finish) = 0;
+
+  // The JS object that owns the transform. It is kept alive by the pipe.
+  virtual v8::Local<v8::Object> GetTransformObject() = 0;
+
+  // Can be installed as a JS method on classes that implement this
+  // interface, and returns a pointer that can be passed to the StreamPipe
+  // constructor, or `undefined` if the transform is already part of a pipe.
+  template <typename T>
+  static void GetPipeTransform(
+      const v8::FunctionCallbackInfo<v8::Value>& args) {
+    T* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    StreamPipeTransform* transform = wrap;
+    if (transform->in_pipe())
+      return;
+    args.GetReturnValue().Set(
+        v8::External::New(args.GetIsolate(), transform));
+  }
+
+  bool in_pipe() const { return in_pipe_; }
+
+ private:
+  bool in_pipe_ = false;
+
+  friend class StreamPipe;
+};
+
 class StreamPipe : public AsyncWrap {
  public:
-  StreamPipe(StreamBase* source, StreamBase* sink, v8::Local<v8::Object> obj);
+  StreamPipe(StreamBase* source,
+             StreamBase* sink,
+             v8::Local<v8::Object> obj,
+             std::vector<StreamPipeTransform*>&& transforms = {});
   ~StreamPipe() override;
 
   void Unpipe();
@@ -41,7 +86,21 @@ class StreamPipe : public AsyncWrap {
   // `OnStreamWantsWrite()` support.
   size_t wanted_data_ = 0;
 
+  struct TransformStage {
+    StreamPipeTransform* transform;
+    v8::Global<v8::Object> object;
+  };
+  std::vector<TransformStage> transforms_;
+  bool transforms_finished_ = false;
+  // Output of the transforms that is currently being written to the sink.
+  std::vector<AllocatedBuffer> pending_chunks_;
+
   void ProcessData(size_t nread, AllocatedBuffer&& buf);
+  int RunTransforms(std::vector<AllocatedBuffer>* chunks, bool finish);
+  StreamWriteResult WriteChunks(std::vector<AllocatedBuffer>&& chunks);
+  // Flush the transforms once the source has ended, then shut down the sink
+  // and unpipe.
+  void FinishWritable();
 
   class ReadableListener : public StreamListener {
    public:
@@ -122,11 +122,36 @@ LibuvStreamWrap::LibuvStreamWrap(Environment* env,
                  reinterpret_cast<uv_handle_t*>(stream),
                  provider),
       StreamBase(env),
-      stream_(stream) {
+      stream_(stream),
+      idle_timer_(this) {
   StreamBase::AttachToObject(object);
 }
 
 
+LibuvStreamWrap::~LibuvStreamWrap() {
+  CHECK(coalesced_data_.empty());
+  CHECK(coalesced_req_wraps_.empty());
+  CHECK(failed_coalesced_writes_.empty());
+  if (scheduled_flush_ != nullptr)
+    scheduled_flush_->wrap = nullptr;
+}
+
+
+void LibuvStreamWrap::Close(Local<Value> close_callback) {
+  // Hand pending writes over to libuv, which cancels them when closing.
+  FlushCoalescedWrites();
+  idle_timeout_ = 0;
+  idle_timer_.Disarm();
+  HandleWrap::Close(close_callback);
+}
+
+
+void LibuvStreamWrap::OnClose() {
+  // The immediate that would have reported these does not run anymore.
+  ReportFailedCoalescedWrites();
+}
+
+
 Local<FunctionTemplate> LibuvStreamWrap::GetConstructorTemplate(
     Environment* env) {
   Local<FunctionTemplate> tmpl = env->libuv_stream_wrap_ctor_template();
@@ -148,6 +173,8 @@ Local<FunctionTemplate> LibuvStreamWrap::GetConstructorTemplate(
         Local<FunctionTemplate>(),
         static_cast<PropertyAttribute>(ReadOnly | DontDelete));
     env->SetProtoMethod(tmpl, "setBlocking", SetBlocking);
+    env->SetProtoMethod(tmpl, "setWriteCoalescing", SetWriteCoalescing);
+    env->SetProtoMethod(tmpl, "setIdleTimeout", SetIdleTimeout);
     StreamBase::AddMethods(env, tmpl);
     env->set_libuv_stream_wrap_ctor_template(tmpl);
   }
@@ -256,6 +283,8 @@ void LibuvStreamWrap::OnUvRead(ssize_t nread, const uv_buf_t* buf) {
   // uv_close() on the handle.
   CHECK_EQ(persistent().IsEmpty(), false);
 
+  UpdateLastActivity();
+
   if (nread > 0) {
     MaybeLocal<Object> pending_obj;
 
@@ -292,7 +321,7 @@ void LibuvStreamWrap::GetWriteQueueSize(
     return;
   }
 
-  uint32_t write_queue_size = wrap->stream()->write_queue_size;
+  uint32_t write_queue_size = wrap->write_queue_size();
   info.GetReturnValue().Set(write_queue_size);
 }
 
@@ -309,6 +338,70 @@ void LibuvStreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(uv_stream_set_blocking(wrap->stream(), enable));
 }
 
+
+void LibuvStreamWrap::SetWriteCoalescing(
+    const FunctionCallbackInfo<Value>& args) {
+  LibuvStreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  CHECK(args[1]->IsUint32());
+  bool enable = args[0]->IsTrue();
+  uint32_t threshold = args[1].As<v8::Uint32>()->Value();
+
+  wrap->coalescing_threshold_ =
+      threshold > 0 ? threshold : kDefaultCoalescingThreshold;
+  if (!enable)
+    wrap->FlushCoalescedWrites();
+  wrap->coalesce_writes_ = enable;
+}
+
+
+void LibuvStreamWrap::SetIdleTimeout(const FunctionCallbackInfo<Value>& args) {
+  LibuvStreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  CHECK(args[0]->IsNumber());
+  int64_t timeout = args[0]->IntegerValue(wrap->env()->context()).FromJust();
+  CHECK_GE(timeout, 0);
+
+  if (timeout == 0 || wrap->IsClosing()) {
+    wrap->idle_timeout_ = 0;
+    wrap->idle_timer_.Disarm();
+    return;
+  }
+
+  wrap->idle_timeout_ = timeout;
+  wrap->last_activity_ = uv_now(wrap->env()->event_loop());
+  wrap->last_write_queue_size_ = wrap->write_queue_size();
+  wrap->idle_timer_.Arm(timeout);
+}
+
+
+void LibuvStreamWrap::OnIdleTimeout() {
+  if (idle_timeout_ == 0 || IsClosing())
+    return;
+
+  uint64_t now = uv_now(env()->event_loop());
+  // A write that is in progress, but takes longer than the timeout, is not
+  // considered idle as long as data is still being flushed.
+  size_t queued = write_queue_size();
+  if (queued > 0 && queued != last_write_queue_size_)
+    last_activity_ = now;
+  last_write_queue_size_ = queued;
+
+  uint64_t idle = now - last_activity_;
+  if (idle < idle_timeout_) {
+    idle_timer_.Arm(idle_timeout_ - idle);
+    return;
+  }
+
+  // Like socket.setTimeout(), the timeout fires once and is re-armed by
+  // the next read or write.
+  HandleScope scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  MakeCallback(env()->ontimeout_string(), 0, nullptr);
+}
+
 typedef SimpleShutdownWrap<ReqWrap<uv_shutdown_t>> LibuvShutdownWrap;
 typedef SimpleWriteWrap<ReqWrap<uv_write_t>> LibuvWriteWrap;
 
@@ -323,6 +416,9 @@ WriteWrap* LibuvStreamWrap::CreateWriteWrap(Local<Object> object) {
 
 int LibuvStreamWrap::DoShutdown(ShutdownWrap* req_wrap_) {
   LibuvShutdownWrap* req_wrap = static_cast<LibuvShutdownWrap*>(req_wrap_);
+  // libuv only shuts down the stream once all queued writes are done,
+  // so pass on any writes that are still waiting to be coalesced first.
+  FlushCoalescedWrites();
   return req_wrap->Dispatch(uv_shutdown, stream(), AfterUvShutdown);
 }
 
@@ -333,6 +429,12 @@ void LibuvStreamWrap::AfterUvShutdown(uv_shutdown_t* req, int status) {
   CHECK_NOT_NULL(req_wrap);
   HandleScope scope(req_wrap->env()->isolate());
   Context::Scope context_scope(req_wrap->env()->context());
+
+  // The shutdown has waited for all coalesced writes; if one of them failed,
+  // not all data has been written.
+  LibuvStreamWrap* wrap = static_cast<LibuvStreamWrap*>(req_wrap->stream());
+  if (status == 0 && wrap->coalesced_write_error_ != 0)
+    status = wrap->coalesced_write_error_;
   req_wrap->Done(status);
 }
 
@@ -347,12 +449,22 @@ int LibuvStreamWrap::DoTryWrite(uv_buf_t** bufs, size_t* count) {
   uv_buf_t* vbufs = *bufs;
   size_t vcount = *count;
 
+  if (coalesce_writes_) {
+    // Leave the data to DoWrite(), which adds it to the current batch.
+    if (ShouldCoalesce(vbufs, vcount))
+      return 0;
+    // Coalesced writes that are still pending must not be overtaken.
+    FlushCoalescedWrites();
+  }
+
   err = uv_try_write(stream(), vbufs, vcount);
   if (err == UV_ENOSYS || err == UV_EAGAIN)
     return 0;
   if (err < 0)
     return err;
 
+  UpdateLastActivity();
+
   // Slice off the buffers: skip all written buffers and slice the one that
   // was partially written.
   written = err;
@@ -381,16 +493,132 @@ int LibuvStreamWrap::DoWrite(WriteWrap* req_wrap,
                              uv_buf_t* bufs,
                              size_t count,
                              uv_stream_t* send_handle) {
+  UpdateLastActivity();
+
+  if (coalesce_writes_ &&
+      send_handle == nullptr &&
+      ShouldCoalesce(bufs, count)) {
+    CoalesceWrite(req_wrap, bufs, count);
+    last_write_queue_size_ = write_queue_size();
+    return 0;
+  }
+
+  // Coalesced writes that are still pending must not be overtaken.
+  FlushCoalescedWrites();
   LibuvWriteWrap* w = static_cast<LibuvWriteWrap*>(req_wrap);
-  return w->Dispatch(uv_write2,
-                     stream(),
-                     bufs,
-                     count,
-                     send_handle,
-                     AfterUvWrite);
+  int err = w->Dispatch(uv_write2,
+                        stream(),
+                        bufs,
+                        count,
+                        send_handle,
+                        AfterUvWrite);
+  last_write_queue_size_ = write_queue_size();
+  return err;
+}
+
+
+bool LibuvStreamWrap::ShouldCoalesce(const uv_buf_t* bufs,
+                                     size_t count) {
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++)
+    total += bufs[i].len;
+  return total < coalescing_threshold_ &&
+         stream()->write_queue_size == 0 &&
+         !IsClosing();
+}
+
+
+void LibuvStreamWrap::CoalesceWrite(WriteWrap* req_wrap,
+                                    uv_buf_t* bufs,
+                                    size_t count) {
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++)
+    total += bufs[i].len;
+  if (coalesced_data_.size() + total > coalescing_threshold_)
+    FlushCoalescedWrites();
+
+  for (size_t i = 0; i < count; i++) {
+    coalesced_data_.insert(coalesced_data_.end(),
+                           bufs[i].base,
+                           bufs[i].base + bufs[i].len);
+  }
+  coalesced_req_wraps_.push_back(req_wrap);
+  ScheduleCoalescedFlush();
+}
+
+
+void LibuvStreamWrap::ScheduleCoalescedFlush() {
+  if (scheduled_flush_ != nullptr)
+    return;
+  scheduled_flush_ = new CoalescedFlush { this };
+  env()->SetImmediate([](Environment* env, void* data) {
+    std::unique_ptr<CoalescedFlush> flush {
+        static_cast<CoalescedFlush*>(data) };
+    LibuvStreamWrap* wrap = flush->wrap;
+    if (wrap == nullptr)
+      return;
+    wrap->scheduled_flush_ = nullptr;
+    wrap->FlushCoalescedWrites();
+    wrap->ReportFailedCoalescedWrites();
+  }, scheduled_flush_, object());
 }
 
 
+void LibuvStreamWrap::FlushCoalescedWrites() {
+  if (coalesced_req_wraps_.empty())
+    return;
+
+  CoalescedWrite* w = new CoalescedWrite { this, {}, {}, {}, 0 };
+  w->data.swap(coalesced_data_);
+  w->req_wraps.swap(coalesced_req_wraps_);
+
+  int err = UV_ECANCELED;
+  if (IsAlive() && !IsClosing()) {
+    uv_buf_t buf = uv_buf_init(w->data.data(), w->data.size());
+    err = uv_write(&w->req, stream(), &buf, 1, AfterCoalescedWrite);
+  }
+
+  if (err != 0) {
+    if (err != UV_ECANCELED && coalesced_write_error_ == 0)
+      coalesced_write_error_ = err;
+    w->status = err;
+    failed_coalesced_writes_.push_back(w);
+    ScheduleCoalescedFlush();
+  }
+}
+
+
+void LibuvStreamWrap::ReportFailedCoalescedWrites() {
+  if (failed_coalesced_writes_.empty())
+    return;
+
+  std::vector<CoalescedWrite*> failed;
+  failed.swap(failed_coalesced_writes_);
+  HandleScope scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  for (CoalescedWrite* w : failed) {
+    for (WriteWrap* req_wrap : w->req_wraps)
+      req_wrap->Done(w->status);
+    delete w;
+  }
+}
+
+
+void LibuvStreamWrap::AfterCoalescedWrite(uv_write_t* req, int status) {
+  std::unique_ptr<CoalescedWrite> w {
+      ContainerOf(&CoalescedWrite::req, req) };
+  LibuvStreamWrap* wrap = w->wrap;
+  if (status == 0)
+    wrap->UpdateLastActivity();
+  else if (status != UV_ECANCELED && wrap->coalesced_write_error_ == 0)
+    wrap->coalesced_write_error_ = status;
+
+  HandleScope scope(wrap->env()->isolate());
+  Context::Scope context_scope(wrap->env()->context());
+  for (WriteWrap* req_wrap : w->req_wraps)
+    req_wrap->Done(status);
+}
+
 
 void LibuvStreamWrap::AfterUvWrite(uv_write_t* req, int status) {
   LibuvWriteWrap* req_wrap = static_cast<LibuvWriteWrap*>(
@@ -398,6 +626,9 @@ void LibuvStreamWrap::AfterUvWrite(uv_write_t* req, int status) {
   CHECK_NOT_NULL(req_wrap);
   HandleScope scope(req_wrap->env()->isolate());
   Context::Scope context_scope(req_wrap->env()->context());
+
+  LibuvStreamWrap* wrap = static_cast<LibuvStreamWrap*>(req_wrap->stream());
+  wrap->UpdateLastActivity();
   req_wrap->Done(status);
 }
 
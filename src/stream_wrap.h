@@ -29,8 +29,11 @@
 #include "env.h"
 #include "handle_wrap.h"
 #include "string_bytes.h"
+#include "timer_wheel.h"
 #include "v8.h"
 
+#include <vector>
+
 namespace node {
 
 class LibuvStreamWrap : public HandleWrap, public StreamBase {
@@ -40,11 +43,16 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
                          v8::Local<v8::Context> context,
                          void* priv);
 
+  ~LibuvStreamWrap() override;
+
   int GetFD() override;
   bool IsAlive() override;
   bool IsClosing() override;
   bool IsIPCPipe() override;
 
+  void Close(
+      v8::Local<v8::Value> close_callback = v8::Local<v8::Value>()) override;
+
   // JavaScript functions
   int ReadStart() override;
   int ReadStop() override;
@@ -79,6 +87,21 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
 
   static LibuvStreamWrap* From(Environment* env, v8::Local<v8::Object> object);
 
+  // Record that data has been read from or written to the stream, which
+  // postpones the idle timeout. This only stores a timestamp; the idle timer
+  // itself is re-armed lazily when it expires.
+  inline void UpdateLastActivity() {
+    if (idle_timeout_ == 0)
+      return;
+    last_activity_ = uv_now(env()->event_loop());
+    if (!idle_timer_.IsArmed())
+      idle_timer_.Arm(idle_timeout_);
+  }
+
+  // The default number of bytes after which coalesced writes are flushed
+  // without waiting for the end of the current event loop turn.
+  static constexpr size_t kDefaultCoalescingThreshold = 64 * 1024;
+
  protected:
   LibuvStreamWrap(Environment* env,
                   v8::Local<v8::Object> object,
@@ -86,6 +109,7 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
                   AsyncWrap::ProviderType provider);
 
   AsyncWrap* GetAsyncWrap() override;
+  void OnClose() override;
 
   static v8::Local<v8::FunctionTemplate> GetConstructorTemplate(
       Environment* env);
@@ -102,6 +126,48 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   static void GetWriteQueueSize(
       const v8::FunctionCallbackInfo<v8::Value>& info);
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetWriteCoalescing(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetIdleTimeout(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Idle timeouts: The stream's `ontimeout` method is called once no data
+  // has been read or written for `idle_timeout_` milliseconds, which matches
+  // the semantics of `socket.setTimeout()`. Streams do not get a libuv timer
+  // of their own; instead, a CoarseTimer is armed with the full timeout, and
+  // re-armed for the remaining time when there was activity in the meantime.
+  class IdleTimer : public CoarseTimer {
+   public:
+    explicit IdleTimer(LibuvStreamWrap* wrap)
+        : CoarseTimer(wrap->env()->timer_wheel()), wrap_(wrap) {
+      SetRef(false);
+    }
+
+   protected:
+    void OnTimeout() override { wrap_->OnIdleTimeout(); }
+
+   private:
+    LibuvStreamWrap* const wrap_;
+  };
+
+  void OnIdleTimeout();
+  inline size_t write_queue_size() const {
+    return stream()->write_queue_size + coalesced_data_.size();
+  }
+
+  // Write coalescing: While enabled, small writes are copied into a native
+  // buffer, which is passed to libuv as a single uv_write() at the end of the
+  // current event loop turn, or once it holds `coalescing_threshold_` bytes.
+  // The WriteWraps of these writes stay pending until that uv_write() has
+  // finished, and are completed with its status. Writes that are too large,
+  // or that are made while libuv still has data queued, take the regular
+  // path, so that JS still sees backpressure.
+  bool ShouldCoalesce(const uv_buf_t* bufs, size_t count);
+  void CoalesceWrite(WriteWrap* req_wrap, uv_buf_t* bufs, size_t count);
+  void FlushCoalescedWrites();
+  void ScheduleCoalescedFlush();
+  // Completes the batches for which uv_write() failed synchronously. This is
+  // deferred so that write callbacks are never called from within a write.
+  void ReportFailedCoalescedWrites();
 
   // Callbacks for libuv
   void OnUvAlloc(size_t suggested_size, uv_buf_t* buf);
@@ -109,9 +175,43 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
 
   static void AfterUvWrite(uv_write_t* req, int status);
   static void AfterUvShutdown(uv_shutdown_t* req, int status);
+  static void AfterCoalescedWrite(uv_write_t* req, int status);
 
   uv_stream_t* const stream_;
 
+  // A pending SetImmediate() flush. This outlives the wrap if the handle is
+  // closed before the immediate has run, in which case `wrap` is reset.
+  struct CoalescedFlush {
+    LibuvStreamWrap* wrap;
+  };
+
+  // A libuv write request for a buffer of coalesced writes, together with
+  // the WriteWraps whose data it contains. libuv cancels it before the handle
+  // is closed, so `wrap` always outlives it.
+  struct CoalescedWrite {
+    LibuvStreamWrap* wrap;
+    std::vector<char> data;
+    std::vector<WriteWrap*> req_wraps;
+    uv_write_t req;
+    int status;
+  };
+
+  bool coalesce_writes_ = false;
+  CoalescedFlush* scheduled_flush_ = nullptr;
+  size_t coalescing_threshold_ = kDefaultCoalescingThreshold;
+  std::vector<char> coalesced_data_;
+  std::vector<WriteWrap*> coalesced_req_wraps_;
+  std::vector<CoalescedWrite*> failed_coalesced_writes_;
+  // The first error that a batch ran into. A shutdown that follows it
+  // reports this error, as the data before the shutdown was not written.
+  int coalesced_write_error_ = 0;
+
+  IdleTimer idle_timer_;
+  uint64_t idle_timeout_ = 0;
+  uint64_t last_activity_ = 0;
+  // Used to detect progress on writes that take longer than the timeout.
+  size_t last_write_queue_size_ = 0;
+
 #ifdef _WIN32
   // We don't always have an FD that we could look up on the stream_
   // object itself on Windows. However, for some cases, we open handles
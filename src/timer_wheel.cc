@@ -0,0 +1,215 @@
+#include "timer_wheel.h"
+#include "util-inl.h"
+
+#include <algorithm>  // std::max(), std::min()
+
+namespace node {
+
+CoarseTimer::~CoarseTimer() {
+  Disarm();
+}
+
+void CoarseTimer::Arm(uint64_t timeout_ms) {
+  wheel_->Arm(this, timeout_ms);
+}
+
+void CoarseTimer::Disarm() {
+  // The wheel may already be gone if the timer is not armed.
+  if (IsArmed())
+    wheel_->Disarm(this);
+}
+
+void CoarseTimer::SetRef(bool ref) {
+  if (ref_ == ref)
+    return;
+  if (IsArmed())
+    wheel_->SetRef(this, ref);
+  ref_ = ref;
+}
+
+
+TimerWheel::TimerWheel(uv_loop_t* loop, uint64_t tick_ms)
+    : loop_(loop), tick_ms_(tick_ms), origin_(uv_now(loop)) {
+  CHECK_GT(tick_ms_, 0);
+  CHECK_EQ(uv_timer_init(loop_, &timer_), 0);
+  uv_unref(handle());
+}
+
+TimerWheel::~TimerWheel() {
+  // Leave the remaining timers in a disarmed state.
+  for (auto& level : slots_) {
+    for (TimerList& slot : level) {
+      while (!slot.IsEmpty())
+        slot.PopFront();
+    }
+  }
+}
+
+uint64_t TimerWheel::NowTick() const {
+  return (uv_now(loop_) - origin_) / tick_ms_;
+}
+
+void TimerWheel::Arm(CoarseTimer* timer, uint64_t timeout_ms) {
+  // The wheel does not advance while no timers are armed, so catch up
+  // without walking through the ticks in between.
+  if (armed_count_ == 0)
+    current_tick_ = std::max(current_tick_, NowTick());
+
+  if (timer->IsArmed()) {
+    timer->wheel_node_.Remove();
+  } else {
+    armed_count_++;
+    if (timer->ref_)
+      ref_count_++;
+  }
+
+  // Round up, so that timers never fire early.
+  uint64_t ticks = (timeout_ms + tick_ms_ - 1) / tick_ms_;
+  ticks = std::max(ticks, uint64_t{1});
+  timer->expiry_ = std::max(NowTick(), current_tick_) + ticks;
+  const uint64_t tick = Insert(timer);
+  // Timers that are disarmed do not move the libuv timer back, as finding
+  // the next occupied slot is not O(1); the wheel just wakes up early.
+  if (!running_ || tick < next_tick_)
+    ScheduleTick(tick);
+  UpdateRef();
+}
+
+void TimerWheel::Disarm(CoarseTimer* timer) {
+  CHECK(timer->IsArmed());
+  timer->wheel_node_.Remove();
+  armed_count_--;
+  if (timer->ref_)
+    ref_count_--;
+  if (armed_count_ == 0 && running_) {
+    running_ = false;
+    uv_timer_stop(&timer_);
+  }
+  UpdateRef();
+}
+
+void TimerWheel::SetRef(CoarseTimer* timer, bool ref) {
+  CHECK(timer->IsArmed());
+  if (ref)
+    ref_count_++;
+  else
+    ref_count_--;
+  UpdateRef();
+}
+
+uint64_t TimerWheel::Insert(CoarseTimer* timer) {
+  uint64_t expiry = timer->expiry_;
+  uint64_t delta = expiry > current_tick_ ? expiry - current_tick_ : 0;
+  size_t level = 0;
+  while (level < kLevels - 1 &&
+         delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+    level++;
+  }
+
+  if (level == kLevels - 1) {
+    // Timers that are further in the future than the wheel can represent
+    // are put into the last slot of the top level, and are re-inserted
+    // when that slot is cascaded.
+    const uint64_t max_delta = (uint64_t{1} << (kSlotBits * kLevels)) - 1;
+    if (delta > max_delta)
+      expiry = current_tick_ + max_delta;
+  }
+
+  size_t slot = (expiry >> (kSlotBits * level)) & (kSlots - 1);
+  slots_[level][slot].PushBack(timer);
+  return SlotTick(level, slot);
+}
+
+size_t TimerWheel::Cascade(size_t level) {
+  size_t index = (current_tick_ >> (kSlotBits * level)) & (kSlots - 1);
+  TimerList& slot = slots_[level][index];
+  while (CoarseTimer* timer = slot.PopFront())
+    Insert(timer);
+  return index;
+}
+
+uint64_t TimerWheel::SlotTick(size_t level, size_t slot) const {
+  // Slot `slot` of level `level` covers `span` ticks, and comes around once
+  // every `period` ticks.
+  const uint64_t span = uint64_t{1} << (kSlotBits * level);
+  const uint64_t period = span << kSlotBits;
+  uint64_t tick = (current_tick_ & ~(period - 1)) + slot * span;
+  if (tick < current_tick_)
+    tick += period;
+  return tick;
+}
+
+uint64_t TimerWheel::NextOccupiedTick() const {
+  uint64_t next = UINT64_MAX;
+  for (size_t level = 0; level < kLevels; level++) {
+    for (size_t slot = 0; slot < kSlots; slot++) {
+      if (!slots_[level][slot].IsEmpty())
+        next = std::min(next, SlotTick(level, slot));
+    }
+  }
+  return next;
+}
+
+void TimerWheel::AdvanceTo(uint64_t tick) {
+  while (current_tick_ < tick && armed_count_ > 0) {
+    size_t index = current_tick_ & (kSlots - 1);
+    if (index == 0) {
+      // Redistribute the timers of the next slot on each higher level,
+      // as long as that level has wrapped around as well.
+      size_t level = 1;
+      while (level < kLevels && Cascade(level) == 0)
+        level++;
+    }
+
+    // Move the expired timers into a separate list first, so that timers
+    // can be re-armed, disarmed or deleted from within OnTimeout().
+    TimerList expired;
+    TimerList& slot = slots_[0][index];
+    while (CoarseTimer* timer = slot.PopFront())
+      expired.PushBack(timer);
+    current_tick_++;
+
+    while (CoarseTimer* timer = expired.PopFront()) {
+      armed_count_--;
+      if (timer->ref_)
+        ref_count_--;
+      timer->OnTimeout();
+    }
+  }
+
+  // Nothing can expire in between, so skip the remaining ticks.
+  if (armed_count_ == 0 && current_tick_ < tick)
+    current_tick_ = tick;
+
+  if (armed_count_ > 0) {
+    ScheduleTick(NextOccupiedTick());
+  } else if (running_) {
+    running_ = false;
+    uv_timer_stop(&timer_);
+  }
+  UpdateRef();
+}
+
+void TimerWheel::OnTick(uv_timer_t* handle) {
+  TimerWheel* wheel = ContainerOf(&TimerWheel::timer_, handle);
+  wheel->running_ = false;
+  wheel->AdvanceTo(wheel->NowTick());
+}
+
+void TimerWheel::ScheduleTick(uint64_t tick) {
+  // A tick is processed once it has passed completely.
+  const uint64_t due = origin_ + (tick + 1) * tick_ms_;
+  const uint64_t now = uv_now(loop_);
+  next_tick_ = tick;
+  running_ = true;
+  uv_timer_start(&timer_, OnTick, due > now ? due - now : 0, 0);
+}
+
+void TimerWheel::UpdateRef() {
+  if (ref_count_ > 0)
+    uv_ref(handle());
+  else
+    uv_unref(handle());
+}
+
+}  // namespace node
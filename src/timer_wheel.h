@@ -0,0 +1,133 @@
+#ifndef SRC_TIMER_WHEEL_H_
+#define SRC_TIMER_WHEEL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+#include "uv.h"
+
+#include <array>
+#include <cstdint>
+
+namespace node {
+
+class TimerWheel;
+
+// A timer that is managed by a TimerWheel. Arming and disarming are O(1),
+// at the cost of the timer only having the resolution of the wheel's tick.
+// Timers never fire early, and usually fire less than two ticks late.
+class CoarseTimer {
+ public:
+  explicit CoarseTimer(TimerWheel* wheel) : wheel_(wheel) {}
+  virtual ~CoarseTimer();
+
+  // Arm the timer so that it fires after `timeout_ms` milliseconds. If the
+  // timer is already armed, it is re-armed.
+  void Arm(uint64_t timeout_ms);
+  void Disarm();
+  inline bool IsArmed() const { return !wheel_node_.IsEmpty(); }
+
+  // Whether this timer, while it is armed, keeps the event loop alive.
+  // Timers are ref'ed by default.
+  void SetRef(bool ref);
+  inline bool HasRef() const { return ref_; }
+
+  inline TimerWheel* wheel() const { return wheel_; }
+
+  CoarseTimer(const CoarseTimer&) = delete;
+  CoarseTimer& operator=(const CoarseTimer&) = delete;
+
+ protected:
+  // Called once the timer has expired. The timer is disarmed at that point,
+  // and may be re-armed or deleted from within this method.
+  virtual void OnTimeout() = 0;
+
+ private:
+  TimerWheel* const wheel_;
+  ListNode<CoarseTimer> wheel_node_;
+  uint64_t expiry_ = 0;  // In ticks.
+  bool ref_ = true;
+
+  friend class TimerWheel;
+};
+
+// A hierarchical timing wheel, for timers that do not need millisecond
+// precision, like socket idle timeouts. Unlike libuv's timer heap, adding and
+// removing a timer does not depend on the number of timers that exist, and
+// no more than one libuv timer is used for all of them. That timer does not
+// fire on every tick, but only once the next occupied slot is due.
+//
+// The wheel consists of kLevels levels of kSlots slots each. Each slot is a
+// list of timers. A slot on level 0 contains the timers that expire at a
+// specific tick, a slot on level n contains the timers that expire within a
+// range of kSlots^n ticks. Whenever level 0 has been fully traversed, the
+// next slot of level 1 is redistributed onto level 0, and so on.
+class TimerWheel {
+ public:
+  static constexpr uint64_t kDefaultTickMs = 50;
+  static constexpr size_t kSlotBits = 6;
+  static constexpr size_t kSlots = 1 << kSlotBits;
+  static constexpr size_t kLevels = 4;
+
+  explicit TimerWheel(uv_loop_t* loop, uint64_t tick_ms = kDefaultTickMs);
+  ~TimerWheel();
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // The libuv timer that drives the wheel. It needs to be closed before the
+  // wheel is destroyed.
+  inline uv_handle_t* handle() {
+    return reinterpret_cast<uv_handle_t*>(&timer_);
+  }
+
+  // Expire all timers that are due at or before `tick`.
+  void AdvanceTo(uint64_t tick);
+
+  inline uint64_t tick_ms() const { return tick_ms_; }
+  inline uint64_t current_tick() const { return current_tick_; }
+  inline size_t armed_count() const { return armed_count_; }
+  inline size_t ref_count() const { return ref_count_; }
+  // The tick that the libuv timer will process next, if it is running.
+  inline uint64_t next_tick() const { return next_tick_; }
+  inline bool IsRunning() const { return running_; }
+
+ private:
+  typedef ListHead<CoarseTimer, &CoarseTimer::wheel_node_> TimerList;
+
+  static void OnTick(uv_timer_t* handle);
+
+  uint64_t NowTick() const;
+  void Arm(CoarseTimer* timer, uint64_t timeout_ms);
+  void Disarm(CoarseTimer* timer);
+  void SetRef(CoarseTimer* timer, bool ref);
+  // Returns the tick at which the slot that the timer was put into is
+  // processed.
+  uint64_t Insert(CoarseTimer* timer);
+  size_t Cascade(size_t level);
+  // The first tick, not before the current one, at which the given slot is
+  // processed, i.e. its timers expire or are cascaded onto a lower level.
+  uint64_t SlotTick(size_t level, size_t slot) const;
+  uint64_t NextOccupiedTick() const;
+  void ScheduleTick(uint64_t tick);
+  void UpdateRef();
+
+  uv_loop_t* const loop_;
+  uv_timer_t timer_;
+  const uint64_t tick_ms_;
+  const uint64_t origin_;
+  uint64_t current_tick_ = 0;
+  size_t armed_count_ = 0;
+  size_t ref_count_ = 0;
+  uint64_t next_tick_ = 0;
+  bool running_ = false;
+  std::array<std::array<TimerList, kSlots>, kLevels> slots_;
+
+  friend class CoarseTimer;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_TIMER_WHEEL_H_
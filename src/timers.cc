@@ -1,4 +1,6 @@
+#include "async_wrap-inl.h"
 #include "env-inl.h"
+#include "timer_wheel.h"
 #include "util-inl.h"
 #include "v8.h"
 
@@ -11,11 +13,82 @@ using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Object;
+using v8::String;
 using v8::Value;
 
+// A low-precision timer that is backed by the Environment's TimerWheel.
+// Arming and disarming it is O(1), which makes it suitable for timeouts
+// that are re-armed very often, like socket idle timeouts.
+class CoarseTimerWrap : public AsyncWrap, public CoarseTimer {
+ public:
+  CoarseTimerWrap(Environment* env, Local<Object> object)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_COARSETIMERWRAP),
+        CoarseTimer(env->timer_wheel()) {
+    MakeWeak();
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+    new CoarseTimerWrap(env, args.This());
+  }
+
+  static void Start(const FunctionCallbackInfo<Value>& args) {
+    CoarseTimerWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    CHECK(args[0]->IsNumber());
+    int64_t timeout = args[0]->IntegerValue(wrap->env()->context()).FromJust();
+    CHECK_GE(timeout, 0);
+    // Keep the object alive while the timer is armed.
+    wrap->ClearWeak();
+    wrap->Arm(timeout);
+  }
+
+  static void Stop(const FunctionCallbackInfo<Value>& args) {
+    CoarseTimerWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    wrap->Disarm();
+    wrap->MakeWeak();
+  }
+
+  static void Ref(const FunctionCallbackInfo<Value>& args) {
+    CoarseTimerWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    wrap->SetRef(true);
+  }
+
+  static void Unref(const FunctionCallbackInfo<Value>& args) {
+    CoarseTimerWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    wrap->SetRef(false);
+  }
+
+  static void HasRef(const FunctionCallbackInfo<Value>& args) {
+    CoarseTimerWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    args.GetReturnValue().Set(wrap->CoarseTimer::HasRef());
+  }
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(CoarseTimerWrap)
+  SET_SELF_SIZE(CoarseTimerWrap)
+
+ protected:
+  void OnTimeout() override {
+    MakeWeak();
+    if (!env()->can_call_into_js())
+      return;
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+    MakeCallback(env()->ontimeout_string(), 0, nullptr);
+  }
+};
+
 void SetupTimers(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsFunction());
   CHECK(args[1]->IsFunction());
@@ -58,6 +131,25 @@ void Initialize(Local<Object> target,
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "immediateInfo"),
               env->immediate_info()->fields().GetJSArray()).Check();
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(CoarseTimerWrap::New);
+  Local<String> coarse_timer_string =
+      FIXED_ONE_BYTE_STRING(env->isolate(), "CoarseTimer");
+  t->SetClassName(coarse_timer_string);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->Inherit(AsyncWrap::GetConstructorTemplate(env));
+  env->SetProtoMethod(t, "start", CoarseTimerWrap::Start);
+  env->SetProtoMethod(t, "stop", CoarseTimerWrap::Stop);
+  env->SetProtoMethod(t, "ref", CoarseTimerWrap::Ref);
+  env->SetProtoMethod(t, "unref", CoarseTimerWrap::Unref);
+  env->SetProtoMethodNoSideEffect(t, "hasRef", CoarseTimerWrap::HasRef);
+  target->Set(env->context(),
+              coarse_timer_string,
+              t->GetFunction(env->context()).ToLocalChecked()).Check();
+  const int32_t resolution = env->timer_wheel()->tick_ms();
+  target->Set(env->context(),
+              FIXED_ONE_BYTE_STRING(env->isolate(), "coarseTimerResolution"),
+              Integer::New(env->isolate(), resolution)).Check();
 }
 
 
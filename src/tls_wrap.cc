@@ -81,6 +81,8 @@ TLSWrap::TLSWrap(Environment* env,
 TLSWrap::~TLSWrap() {
   Debug(this, "~TLSWrap()");
   sc_ = nullptr;
+  if (paused_ssl_)
+    ssl_ = std::move(paused_ssl_);
 }
 
 
@@ -105,6 +107,42 @@ void TLSWrap::NewSessionDoneCb() {
 }
 
 
+void TLSWrap::OnAsyncPrivateKeyStart() {
+  Debug(this, "OnAsyncPrivateKeyStart()");
+  // The operation refers to this object until it is done.
+  ClearWeak();
+}
+
+
+void TLSWrap::OnAsyncPrivateKeyDone() {
+  Debug(this, "OnAsyncPrivateKeyDone()");
+  env()->SetImmediate([](Environment* env, void* data) {
+    TLSWrap* wrap = static_cast<TLSWrap*>(data);
+    HandleScope handle_scope(env->isolate());
+    wrap->MakeWeak();
+    if (wrap->paused_ssl_)
+      wrap->DestroyPausedSSL();
+    else
+      wrap->Cycle();
+  }, this, object());
+}
+
+
+// DestroySSL() was called while the handshake was paused. Let the job run to
+// completion, without calling into JS, so that OpenSSL releases it, and free
+// the SSL structure afterwards.
+void TLSWrap::DestroyPausedSSL() {
+  Debug(this, "DestroyPausedSSL()");
+  ssl_ = std::move(paused_ssl_);
+  AsyncHandshake();
+  deferred_callbacks_.clear();
+  if (async_handshake_paused_)
+    paused_ssl_ = std::move(ssl_);
+  else
+    SSLWrap<TLSWrap>::DestroySSL();
+}
+
+
 void TLSWrap::InitSSL() {
   // Initialize SSL – OpenSSL takes ownership of these.
   enc_in_ = crypto::NodeBIO::New(env()).release();
@@ -125,6 +163,8 @@ void TLSWrap::InitSSL() {
   // - https://wiki.openssl.org/index.php/TLS1.3#Non-application_data_records
   SSL_set_mode(ssl_.get(), SSL_MODE_AUTO_RETRY);
 
+  async_handshake_ = is_server() && sc_->async_private_key_;
+
   SSL_set_app_data(ssl_.get(), this);
   // Using InfoCallback isn't how we are supposed to check handshake progress:
   //   https://github.com/openssl/openssl/issues/7199#issuecomment-420915993
@@ -231,6 +271,11 @@ void TLSWrap::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
   // SSL_renegotiate_pending() should take `const SSL*`, but it does not.
   SSL* ssl = const_cast<SSL*>(ssl_);
   TLSWrap* c = static_cast<TLSWrap*>(SSL_get_app_data(ssl_));
+  if (c->DeferIfInAsyncJob([ssl, where, ret]() {
+        SSLInfoCallback(ssl, where, ret);
+      })) {
+    return;
+  }
   Environment* env = c->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -408,6 +453,8 @@ Local<Value> TLSWrap::GetSSLError(int status, int* err, std::string* msg) {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
     case SSL_ERROR_WANT_X509_LOOKUP:
+    case SSL_ERROR_WANT_ASYNC:
+    case SSL_ERROR_WANT_ASYNC_JOB:
       return Local<Value>();
 
     case SSL_ERROR_ZERO_RETURN:
@@ -497,9 +544,18 @@ void TLSWrap::ClearOut() {
 
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
+  int read = 1;
+  if (async_handshake_ && !SSL_is_init_finished(ssl_.get())) {
+    read = AsyncHandshake();
+    RunDeferredCallbacks();
+    if (ssl_ == nullptr) {
+      Debug(this, "Returning from ClearOut(), ssl_ == nullptr");
+      return;
+    }
+  }
+
   char out[kClearOutChunkSize];
-  int read;
-  for (;;) {
+  while (read > 0) {
     read = SSL_read(ssl_.get(), out, sizeof(out));
     Debug(this, "Read %d bytes of cleartext output", read);
 
@@ -560,6 +616,41 @@ void TLSWrap::ClearOut() {
 }
 
 
+// Servers whose SecureContext has enableAsyncPrivateKey() drive the handshake
+// with SSL_do_handshake() in an OpenSSL async job, so that private key
+// operations can run on the thread pool. While the job is paused, no other
+// SSL call may be made, as it would resume the job instead of doing its own
+// work.
+int TLSWrap::AsyncHandshake() {
+  async_sni_context_ = nullptr;
+  async_sni_context_invalid_ = false;
+  {
+    HandleScope handle_scope(env()->isolate());
+    Local<Value> ctx;
+    if (object()->Get(env()->context(),
+                      env()->sni_context_string()).ToLocal(&ctx) &&
+        ctx->IsObject()) {
+      if (env()->secure_context_constructor_template()->HasInstance(ctx))
+        async_sni_context_ = Unwrap<SecureContext>(ctx.As<Object>());
+      else
+        async_sni_context_invalid_ = true;
+    }
+  }
+
+  int ret;
+  {
+    crypto::AsyncPrivateKeyListener::Scope scope(env(), this);
+    SSL_set_mode(ssl_.get(), SSL_MODE_ASYNC);
+    ret = SSL_do_handshake(ssl_.get());
+    SSL_clear_mode(ssl_.get(), SSL_MODE_ASYNC);
+  }
+  async_handshake_paused_ = SSL_waiting_for_async(ssl_.get()) == 1;
+  Debug(this, "AsyncHandshake() = %d, paused = %d",
+        ret, async_handshake_paused_);
+  return ret;
+}
+
+
 void TLSWrap::ClearIn() {
   Debug(this, "Trying to write cleartext input");
   // Ignore cycling data if ClientHello wasn't yet parsed
@@ -578,6 +669,11 @@ void TLSWrap::ClearIn() {
     return;
   }
 
+  if (async_handshake_paused_) {
+    Debug(this, "Returning from ClearIn(), handshake is paused");
+    return;
+  }
+
   AllocatedBuffer data = std::move(pending_cleartext_input_);
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
@@ -750,10 +846,12 @@ int TLSWrap::DoWrite(WriteWrap* w,
       memcpy(data.data() + offset, bufs[i].base, bufs[i].len);
       offset += bufs[i].len;
     }
-    written = SSL_write(ssl_.get(), data.data(), length);
+    written = async_handshake_paused_ ?
+        -1 : SSL_write(ssl_.get(), data.data(), length);
   } else {
     // Only one buffer: try to write directly, only store if it fails
-    written = SSL_write(ssl_.get(), bufs[0].base, bufs[0].len);
+    written = async_handshake_paused_ ?
+        -1 : SSL_write(ssl_.get(), bufs[0].base, bufs[0].len);
     if (written == -1) {
       data = env()->AllocateManaged(length);
       memcpy(data.data(), bufs[0].base, bufs[0].len);
@@ -852,7 +950,7 @@ int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
   Debug(this, "DoShutdown()");
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  if (ssl_ && SSL_shutdown(ssl_.get()) == 0)
+  if (ssl_ && !async_handshake_paused_ && SSL_shutdown(ssl_.get()) == 0)
     SSL_shutdown(ssl_.get());
 
   shutdown_ = true;
@@ -965,7 +1063,14 @@ void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
   // And destroy
   wrap->InvokeQueued(UV_ECANCELED, "Canceled because of SSL destruction");
 
-  // Destroy the SSL structure and friends
+  // Destroy the SSL structure and friends. A paused handshake still uses it,
+  // see OnAsyncPrivateKeyDone().
+  wrap->deferred_callbacks_.clear();
+  if (wrap->async_handshake_paused_) {
+    wrap->paused_ssl_ = std::move(wrap->ssl_);
+    if (!wrap->has_pending_operation())
+      wrap->DestroyPausedSSL();
+  }
   wrap->SSLWrap<TLSWrap>::DestroySSL();
   wrap->enc_in_ = nullptr;
   wrap->enc_out_ = nullptr;
@@ -1035,6 +1140,37 @@ int TLSWrap::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
   if (servername == nullptr)
     return SSL_TLSEXT_ERR_OK;
 
+  // JS objects cannot be used from inside an async job, see AsyncHandshake().
+  // The servername is passed on once the job has returned, and the context
+  // that was looked up before the job started is used.
+  if (ASYNC_get_current_job() != nullptr) {
+    std::string name(servername);
+    p->DeferIfInAsyncJob([p, env, name]() {
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      p->GetOwner()->Set(env->context(),
+                         env->servername_string(),
+                         OneByteString(env->isolate(), name.c_str())).Check();
+    });
+    if (p->async_sni_context_invalid_) {
+      p->DeferIfInAsyncJob([p, env]() {
+        HandleScope handle_scope(env->isolate());
+        Context::Scope context_scope(env->context());
+        Local<Value> err = Exception::TypeError(env->sni_context_err_string());
+        p->MakeCallback(env->onerror_string(), 1, &err);
+      });
+    }
+    SecureContext* sc = p->async_sni_context_;
+    if (sc == nullptr)
+      return SSL_TLSEXT_ERR_NOACK;
+    p->DeferIfInAsyncJob([p, env, sc]() {
+      HandleScope handle_scope(env->isolate());
+      p->sni_context_.Reset(env->isolate(), sc->object());
+    });
+    p->SetSNIContext(sc);
+    return SSL_TLSEXT_ERR_OK;
+  }
+
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
@@ -46,6 +46,7 @@ class NodeBIO;
 
 class TLSWrap : public AsyncWrap,
                 public crypto::SSLWrap<TLSWrap>,
+                public crypto::AsyncPrivateKeyListener,
                 public StreamBase,
                 public StreamListener {
  public:
@@ -83,6 +84,10 @@ class TLSWrap : public AsyncWrap,
   // Called by the done() callback of the 'newSession' event.
   void NewSessionDoneCb();
 
+  // Implement AsyncPrivateKeyListener:
+  void OnAsyncPrivateKeyStart() override;
+  void OnAsyncPrivateKeyDone() override;
+
   // Implement MemoryRetainer:
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_MEMORY_INFO_NAME(TLSWrap)
@@ -125,6 +130,8 @@ class TLSWrap : public AsyncWrap,
   void EncOut();  // Write encrypted data from enc_out_ to underlying stream.
   void ClearIn();  // SSL_write() clear data "in" to SSL.
   void ClearOut();  // SSL_read() clear text "out" from SSL.
+  int AsyncHandshake();  // SSL_do_handshake() in an async job.
+  void DestroyPausedSSL();
 
   // Call Done() on outstanding WriteWrap request.
   bool InvokeQueued(int status, const char* error_str = nullptr);
@@ -185,6 +192,16 @@ class TLSWrap : public AsyncWrap,
   bool shutdown_ = false;
   std::string error_;
   int cycle_depth_ = 0;
+  // See AsyncHandshake().
+  bool async_handshake_ = false;
+  bool async_handshake_paused_ = false;
+  // Destroyed while the handshake was paused, freed once it is resumed.
+  crypto::SSLPointer paused_ssl_;
+  // The `sni_context` that JS had set when the current AsyncHandshake() call
+  // started. SelectSNIContextCallback() cannot look at JS objects from
+  // inside the async job. The context is kept alive by the property.
+  crypto::SecureContext* async_sni_context_ = nullptr;
+  bool async_sni_context_invalid_ = false;
 
   // If true - delivered EOF to the js-land, either after `close_notify`, or
   // after the `UV_EOF` on socket.
@@ -11,5 +11,7 @@ runBenchmark('child_process',
                'len=1',
                'params=1',
                'methodName=execSync',
+               'method=default',
+               'rss=0',
              ],
              { NODEJS_BENCHMARK_ZERO_ALLOWED: 1 });
@@ -10,8 +10,12 @@ const runBenchmark = require('../common/benchmark');
 
 runBenchmark('net',
              [
+               'conns=1',
                'dur=0',
                'len=1024',
+               'lineLen=16',
+               'method=framing',
+               'slab=1048576',
                'type=buf'
              ],
              { NODEJS_BENCHMARK_ZERO_ALLOWED: 1 });
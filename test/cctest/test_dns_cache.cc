@@ -0,0 +1,137 @@
+#include "dns_cache.h"
+#include "uv.h"
+
+#include "gtest/gtest.h"
+
+using node::DnsCache;
+
+namespace {
+
+class DnsCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    DnsCache::Options options;
+    options.enabled = true;
+    options.ttl = 100;
+    options.negative_ttl = 10;
+    options.stale_ttl = 50;
+    options.max_entries = 3;
+    cache_.Configure(options);
+  }
+
+  // Stands in for getaddrinfo(): every name resolves to one address.
+  static DnsCache::AddressList Resolve(const std::string& ip) {
+    return DnsCache::AddressList { DnsCache::Address { AF_INET, ip } };
+  }
+
+  DnsCache::Result Lookup(const std::string& key, uint64_t now) {
+    status_ = -1;
+    addresses_.clear();
+    return cache_.Lookup(key, now, &status_, &addresses_);
+  }
+
+  DnsCache cache_;
+  int status_;
+  DnsCache::AddressList addresses_;
+};
+
+}  // anonymous namespace
+
+TEST_F(DnsCacheTest, HitsAndMisses) {
+  const std::string key = DnsCache::MakeKey("example.org", AF_UNSPEC, 0);
+  EXPECT_EQ(DnsCache::Result::kMiss, Lookup(key, 0));
+  cache_.Store(key, 0, 0, Resolve("10.0.0.1"));
+
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(key, 99));
+  EXPECT_EQ(0, status_);
+  ASSERT_EQ(1u, addresses_.size());
+  EXPECT_EQ(AF_INET, addresses_[0].family);
+  EXPECT_EQ("10.0.0.1", addresses_[0].ip);
+
+  // Different lookup parameters use different entries.
+  EXPECT_EQ(DnsCache::Result::kMiss,
+            Lookup(DnsCache::MakeKey("example.org", AF_INET, 0), 0));
+
+  DnsCache::Stats stats = cache_.stats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(1u, stats.size);
+}
+
+TEST_F(DnsCacheTest, StaleWhileRevalidate) {
+  const std::string key = DnsCache::MakeKey("example.org", AF_UNSPEC, 0);
+  cache_.Store(key, 0, 0, Resolve("10.0.0.1"));
+
+  // Only the first lookup after expiry is asked to refresh the entry.
+  EXPECT_EQ(DnsCache::Result::kStale, Lookup(key, 100));
+  EXPECT_EQ("10.0.0.1", addresses_[0].ip);
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(key, 120));
+  EXPECT_EQ("10.0.0.1", addresses_[0].ip);
+
+  cache_.Store(key, 130, 0, Resolve("10.0.0.2"));
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(key, 140));
+  EXPECT_EQ("10.0.0.2", addresses_[0].ip);
+
+  // A refresh that fails temporarily keeps the stale entry around.
+  EXPECT_EQ(DnsCache::Result::kStale, Lookup(key, 240));
+  cache_.Store(key, 240, UV_EAI_AGAIN, DnsCache::AddressList());
+  EXPECT_EQ(DnsCache::Result::kStale, Lookup(key, 250));
+  EXPECT_EQ("10.0.0.2", addresses_[0].ip);
+
+  // Entries are dropped once they are past their stale period.
+  EXPECT_EQ(DnsCache::Result::kMiss, Lookup(key, 280));
+  EXPECT_EQ(0u, cache_.stats().size);
+  EXPECT_EQ(4u, cache_.stats().stale_hits);
+}
+
+TEST_F(DnsCacheTest, NegativeCaching) {
+  const std::string missing = DnsCache::MakeKey("missing", AF_UNSPEC, 0);
+  cache_.Store(missing, 0, UV_EAI_NONAME, DnsCache::AddressList());
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(missing, 9));
+  EXPECT_EQ(UV_EAI_NONAME, status_);
+  EXPECT_TRUE(addresses_.empty());
+  // Negative entries are never served stale.
+  EXPECT_EQ(DnsCache::Result::kMiss, Lookup(missing, 10));
+
+  // Temporary failures are not cached.
+  const std::string flaky = DnsCache::MakeKey("flaky", AF_UNSPEC, 0);
+  cache_.Store(flaky, 0, UV_EAI_AGAIN, DnsCache::AddressList());
+  EXPECT_EQ(DnsCache::Result::kMiss, Lookup(flaky, 0));
+}
+
+TEST_F(DnsCacheTest, RecordTtlIsCapped) {
+  const std::string a = DnsCache::MakeKey("a", AF_UNSPEC, 0);
+  const std::string b = DnsCache::MakeKey("b", AF_UNSPEC, 0);
+  cache_.Store(a, 0, 0, Resolve("10.0.0.1"), 20);
+  cache_.Store(b, 0, 0, Resolve("10.0.0.2"), 100000);
+  EXPECT_EQ(DnsCache::Result::kStale, Lookup(a, 20));
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(b, 99));
+  EXPECT_EQ(DnsCache::Result::kStale, Lookup(b, 100));
+}
+
+TEST_F(DnsCacheTest, EvictsLeastRecentlyUsed) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 4; i++) {
+    keys.push_back(DnsCache::MakeKey(std::to_string(i), AF_UNSPEC, 0));
+    cache_.Store(keys.back(), 0, 0, Resolve("10.0.0.1"));
+    if (i == 2)
+      EXPECT_EQ(DnsCache::Result::kHit, Lookup(keys[0], 0));
+  }
+
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(keys[0], 0));
+  EXPECT_EQ(DnsCache::Result::kMiss, Lookup(keys[1], 0));
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(keys[2], 0));
+  EXPECT_EQ(DnsCache::Result::kHit, Lookup(keys[3], 0));
+  EXPECT_EQ(1u, cache_.stats().evictions);
+  EXPECT_EQ(3u, cache_.stats().size);
+}
+
+TEST_F(DnsCacheTest, Disable) {
+  const std::string key = DnsCache::MakeKey("example.org", AF_UNSPEC, 0);
+  cache_.Store(key, 0, 0, Resolve("10.0.0.1"));
+  cache_.Configure(DnsCache::Options());
+  EXPECT_FALSE(cache_.enabled());
+  EXPECT_EQ(0u, cache_.stats().size);
+  cache_.Store(key, 0, 0, Resolve("10.0.0.1"));
+  EXPECT_EQ(0u, cache_.stats().size);
+}
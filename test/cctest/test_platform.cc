@@ -2,6 +2,7 @@
 #include "libplatform/libplatform.h"
 
 #include <string>
+#include <vector>
 #include "gtest/gtest.h"
 #include "node_test_fixture.h"
 
@@ -37,6 +38,31 @@ class RepostingTask : public v8::Task {
   node::NodePlatform* platform_;
 };
 
+// This task records its id when it is run.
+class RecordingTask : public v8::Task {
+ public:
+  RecordingTask(int id, std::vector<int>* order) : id_(id), order_(order) {}
+
+  void Run() final { order_->push_back(id_); }
+
+ private:
+  int id_;
+  std::vector<int>* order_;
+};
+
+class CountingIdleTask : public v8::IdleTask {
+ public:
+  explicit CountingIdleTask(int* run_count) : run_count_(run_count) {}
+
+  void Run(double deadline_in_seconds) final {
+    EXPECT_GE(deadline_in_seconds, uv_hrtime() / 1e9 - 1);
+    ++*run_count_;
+  }
+
+ private:
+  int* run_count_;
+};
+
 class PlatformTest : public EnvironmentTestFixture {};
 
 TEST_F(PlatformTest, SkipNewTasksInFlushForegroundTasks) {
@@ -57,3 +83,51 @@ TEST_F(PlatformTest, SkipNewTasksInFlushForegroundTasks) {
   EXPECT_EQ(3, run_count);
   EXPECT_FALSE(platform->FlushForegroundTasks(isolate_));
 }
+
+TEST_F(PlatformTest, TaskQueuePriorities) {
+  using node::TaskPriority;
+  node::TaskQueue<v8::Task> queue;
+  std::vector<int> order;
+  queue.Push(std::make_unique<RecordingTask>(1, &order),
+             TaskPriority::kBestEffort);
+  queue.Push(std::make_unique<RecordingTask>(2, &order));
+  queue.Push(std::make_unique<RecordingTask>(3, &order),
+             TaskPriority::kUserBlocking);
+  queue.Push(std::make_unique<RecordingTask>(4, &order));
+  queue.Push(std::make_unique<RecordingTask>(5, &order),
+             TaskPriority::kBestEffort);
+
+  queue.Pop()->Run();
+  std::queue<std::unique_ptr<v8::Task>> rest = queue.PopAll();
+  EXPECT_TRUE(queue.IsEmpty());
+  while (!rest.empty()) {
+    rest.front()->Run();
+    rest.pop();
+  }
+  EXPECT_EQ(std::vector<int>({ 3, 2, 4, 1, 5 }), order);
+}
+
+TEST_F(PlatformTest, RunIdleTasksWhenLoopIsIdle) {
+  v8::Isolate::Scope isolate_scope(isolate_);
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env {handle_scope, argv};
+  EXPECT_TRUE(platform->IdleTasksEnabled(isolate_));
+
+  int run_count = 0;
+  std::shared_ptr<v8::TaskRunner> task_runner =
+      platform->GetForegroundTaskRunner(isolate_);
+  task_runner->PostIdleTask(std::make_unique<CountingIdleTask>(&run_count));
+  task_runner->PostIdleTask(std::make_unique<CountingIdleTask>(&run_count));
+  platform->FlushForegroundTasks(isolate_);
+  EXPECT_EQ(0, run_count);
+
+  // Give the loop something to wait for, so that there is idle time.
+  uv_timer_t timer;
+  uv_timer_init(&current_loop, &timer);
+  uv_timer_start(&timer, [](uv_timer_t*) {}, 20, 0);
+  uv_run(&current_loop, UV_RUN_ONCE);
+  EXPECT_EQ(2, run_count);
+  uv_close(reinterpret_cast<uv_handle_t*>(&timer), nullptr);
+  uv_run(&current_loop, UV_RUN_NOWAIT);
+}
@@ -0,0 +1,187 @@
+#include "timer_wheel.h"
+#include "util-inl.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+
+using node::CoarseTimer;
+using node::TimerWheel;
+
+namespace {
+
+class RecordingTimer : public CoarseTimer {
+ public:
+  RecordingTimer(TimerWheel* wheel, std::vector<uint64_t>* fired)
+      : CoarseTimer(wheel), fired_(fired) {}
+
+  std::function<void()> on_timeout;
+
+ protected:
+  void OnTimeout() override {
+    fired_->push_back(wheel()->current_tick());
+    if (on_timeout)
+      on_timeout();
+  }
+
+ private:
+  std::vector<uint64_t>* fired_;
+};
+
+class TimerWheelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(0, uv_loop_init(&loop_));
+    wheel_ = new TimerWheel(&loop_, 10);
+  }
+
+  void TearDown() override {
+    uv_close(wheel_->handle(), nullptr);
+    ASSERT_EQ(0, uv_run(&loop_, UV_RUN_DEFAULT));
+    delete wheel_;
+    ASSERT_EQ(0, uv_loop_close(&loop_));
+  }
+
+  uv_loop_t loop_;
+  TimerWheel* wheel_;
+};
+
+}  // anonymous namespace
+
+TEST_F(TimerWheelTest, FiresInOrder) {
+  std::vector<uint64_t> fired;
+  RecordingTimer a(wheel_, &fired);
+  RecordingTimer b(wheel_, &fired);
+  RecordingTimer c(wheel_, &fired);
+
+  // Timeouts are rounded up to full ticks.
+  a.Arm(25);
+  b.Arm(10);
+  c.Arm(1);
+  EXPECT_EQ(3u, wheel_->armed_count());
+
+  wheel_->AdvanceTo(1);
+  EXPECT_TRUE(fired.empty());
+  wheel_->AdvanceTo(2);
+  EXPECT_EQ(std::vector<uint64_t>({ 2, 2 }), fired);
+  EXPECT_FALSE(b.IsArmed());
+  EXPECT_FALSE(c.IsArmed());
+  EXPECT_TRUE(a.IsArmed());
+
+  wheel_->AdvanceTo(100);
+  EXPECT_EQ(std::vector<uint64_t>({ 2, 2, 4 }), fired);
+  EXPECT_EQ(0u, wheel_->armed_count());
+}
+
+TEST_F(TimerWheelTest, DisarmAndRearm) {
+  std::vector<uint64_t> fired;
+  RecordingTimer a(wheel_, &fired);
+  RecordingTimer b(wheel_, &fired);
+
+  a.Arm(50);
+  b.Arm(50);
+  a.Disarm();
+  EXPECT_FALSE(a.IsArmed());
+  EXPECT_EQ(1u, wheel_->armed_count());
+
+  // Re-arming moves the timer.
+  b.Arm(200);
+  wheel_->AdvanceTo(10);
+  EXPECT_TRUE(fired.empty());
+  wheel_->AdvanceTo(21);
+  EXPECT_EQ(std::vector<uint64_t>({ 21 }), fired);
+}
+
+TEST_F(TimerWheelTest, CascadesAcrossLevels) {
+  std::vector<uint64_t> fired;
+  std::vector<std::unique_ptr<RecordingTimer>> timers;
+  // Cover level 0, 1, 2 and 3, as well as timeouts beyond the wheel's range.
+  const uint64_t ticks[] = { 63, 64, 65, 4095, 4096, 300000, 20000000 };
+  for (uint64_t t : ticks) {
+    timers.emplace_back(new RecordingTimer(wheel_, &fired));
+    timers.back()->Arm(t * 10);
+  }
+
+  wheel_->AdvanceTo(30000000);
+  ASSERT_EQ(node::arraysize(ticks), fired.size());
+  for (size_t i = 0; i < node::arraysize(ticks); i++)
+    EXPECT_EQ(ticks[i] + 1, fired[i]);
+}
+
+TEST_F(TimerWheelTest, RearmFromCallback) {
+  std::vector<uint64_t> fired;
+  RecordingTimer a(wheel_, &fired);
+  int remaining = 3;
+  a.on_timeout = [&]() {
+    if (--remaining > 0)
+      a.Arm(100);
+  };
+
+  a.Arm(100);
+  wheel_->AdvanceTo(1000);
+  EXPECT_EQ(std::vector<uint64_t>({ 11, 22, 33 }), fired);
+  EXPECT_FALSE(a.IsArmed());
+}
+
+TEST_F(TimerWheelTest, RefCounting) {
+  std::vector<uint64_t> fired;
+  RecordingTimer a(wheel_, &fired);
+  RecordingTimer b(wheel_, &fired);
+
+  EXPECT_FALSE(uv_has_ref(wheel_->handle()));
+  a.Arm(10);
+  b.SetRef(false);
+  b.Arm(10);
+  EXPECT_EQ(1u, wheel_->ref_count());
+  EXPECT_TRUE(uv_has_ref(wheel_->handle()));
+
+  a.SetRef(false);
+  EXPECT_EQ(0u, wheel_->ref_count());
+  EXPECT_FALSE(uv_has_ref(wheel_->handle()));
+
+  a.SetRef(true);
+  a.Disarm();
+  EXPECT_FALSE(uv_has_ref(wheel_->handle()));
+  EXPECT_EQ(1u, wheel_->armed_count());
+}
+
+TEST_F(TimerWheelTest, SchedulesNextOccupiedSlot) {
+  std::vector<uint64_t> fired;
+  RecordingTimer a(wheel_, &fired);
+  RecordingTimer b(wheel_, &fired);
+  RecordingTimer c(wheel_, &fired);
+
+  // The libuv timer is started for the earliest slot that holds a timer,
+  // rather than for every tick.
+  EXPECT_FALSE(wheel_->IsRunning());
+  a.Arm(300);
+  EXPECT_TRUE(wheel_->IsRunning());
+  EXPECT_EQ(30u, wheel_->next_tick());
+  b.Arm(100);
+  EXPECT_EQ(10u, wheel_->next_tick());
+  wheel_->AdvanceTo(11);
+  EXPECT_EQ(std::vector<uint64_t>({ 11 }), fired);
+  EXPECT_EQ(30u, wheel_->next_tick());
+
+  // Timers on higher levels wake the wheel up when they are cascaded.
+  c.Arm(10000);
+  a.Disarm();
+  wheel_->AdvanceTo(31);
+  EXPECT_EQ(960u, wheel_->next_tick());
+  wheel_->AdvanceTo(961);
+  EXPECT_EQ(1011u, wheel_->next_tick());
+  wheel_->AdvanceTo(1012);
+  EXPECT_EQ(std::vector<uint64_t>({ 11, 1012 }), fired);
+  EXPECT_FALSE(wheel_->IsRunning());
+}
+
+TEST_F(TimerWheelTest, RunsOnEventLoop) {
+  std::vector<uint64_t> fired;
+  RecordingTimer a(wheel_, &fired);
+  a.Arm(30);
+  uint64_t start = uv_now(&loop_);
+  ASSERT_EQ(0, uv_run(&loop_, UV_RUN_DEFAULT));
+  EXPECT_EQ(1u, fired.size());
+  EXPECT_GE(uv_now(&loop_) - start, 30u);
+}
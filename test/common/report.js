@@ -43,7 +43,7 @@ function _validateContent(data) {
   // Verify that all sections are present as own properties of the report.
   const sections = ['header', 'javascriptStack', 'nativeStack',
                     'javascriptHeap', 'libuv', 'environmentVariables',
-                    'sharedObjects', 'resourceUsage'];
+                    'sharedObjects', 'resourceUsage', 'threadAffinity'];
   if (!isWindows)
     sections.push('userLimits');
 
@@ -212,6 +212,16 @@ function _validateContent(data) {
     }
   }
 
+  // Verify the format of the threadAffinity section.
+  assert(Array.isArray(report.threadAffinity));
+  report.threadAffinity.forEach((thread) => {
+    checkForUnknownFields(thread, ['name', 'cpus', 'numaNodes']);
+    assert.strictEqual(typeof thread.name, 'string');
+    assert(/^\d+(-\d+)?(,\d+(-\d+)?)*$/.test(thread.cpus));
+    assert(Array.isArray(thread.numaNodes));
+    thread.numaNodes.forEach((node) => assert(Number.isInteger(node)));
+  });
+
   // Verify the format of the sharedObjects section.
   assert(Array.isArray(report.sharedObjects));
   report.sharedObjects.forEach((sharedObject) => {
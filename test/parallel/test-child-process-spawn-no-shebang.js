@@ -0,0 +1,34 @@
+'use strict';
+const common = require('../common');
+if (common.isWindows)
+  common.skip('executable scripts are a POSIX feature');
+
+// Like execvp(), spawning an executable file that is not in a known format,
+// such as a script without a #! line, runs it with /bin/sh.
+
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const script = path.join(tmpdir.path, 'script');
+const output = path.join(tmpdir.path, 'output');
+fs.writeFileSync(script, `echo "$1" > "${output}"\necho "$1"\n`);
+fs.chmodSync(script, 0o755);
+
+{
+  const child = spawnSync(script, ['piped']);
+  assert.ifError(child.error);
+  assert.strictEqual(child.status, 0);
+  assert.strictEqual(child.stdout.toString(), 'piped\n');
+}
+
+{
+  const child = spawnSync(script, ['ignored'], { stdio: 'ignore' });
+  assert.ifError(child.error);
+  assert.strictEqual(child.status, 0);
+  assert.strictEqual(fs.readFileSync(output, 'utf8'), 'ignored\n');
+}
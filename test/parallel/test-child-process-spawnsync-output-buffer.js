@@ -0,0 +1,77 @@
+'use strict';
+require('../common');
+
+// This test checks that child_process.spawnSync() can write child output
+// into caller-supplied buffers, and that captured output is complete.
+
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+
+function write(data) {
+  return ['-e', `process.stdout.write(${JSON.stringify(data)})`];
+}
+
+// Output is read into the supplied buffer and returned as a view of it.
+{
+  const buffer = Buffer.alloc(16);
+  const ret = spawnSync(process.execPath, write('hello'), {
+    stdio: ['ignore', buffer, 'pipe']
+  });
+
+  assert.ifError(ret.error);
+  assert.strictEqual(ret.status, 0);
+  assert.strictEqual(ret.stdout.toString(), 'hello');
+  assert.strictEqual(ret.stdout.buffer, buffer.buffer);
+  assert.strictEqual(ret.stdout.byteOffset, buffer.byteOffset);
+  assert.strictEqual(ret.output[1], ret.stdout);
+  assert.strictEqual(buffer.toString('latin1', 0, 5), 'hello');
+}
+
+// TypedArrays with an offset into their ArrayBuffer work as well.
+{
+  const arrayBuffer = new ArrayBuffer(32);
+  const view = new Uint8Array(arrayBuffer, 8, 8);
+  const ret = spawnSync(process.execPath, write('world'), {
+    stdio: ['ignore', view, 'pipe'],
+    encoding: 'utf8'
+  });
+
+  assert.ifError(ret.error);
+  assert.strictEqual(ret.stdout, 'world');
+  assert.strictEqual(Buffer.from(arrayBuffer, 8, 5).toString(), 'world');
+}
+
+// Output that fills the buffer exactly is not an error.
+{
+  const buffer = Buffer.alloc(5);
+  const ret = spawnSync(process.execPath, write('exact'), {
+    stdio: ['ignore', buffer, 'pipe']
+  });
+
+  assert.ifError(ret.error);
+  assert.strictEqual(ret.stdout.toString(), 'exact');
+}
+
+// Output that does not fit terminates the child.
+{
+  const buffer = Buffer.alloc(5);
+  const ret = spawnSync(process.execPath, write('too long'), {
+    stdio: ['ignore', buffer, 'pipe']
+  });
+
+  assert.ok(ret.error, 'a full buffer should error');
+  assert.strictEqual(ret.error.code, 'ENOBUFS');
+  assert.strictEqual(ret.stdout.toString(), 'too l');
+}
+
+// Large outputs that are captured through a pipe are complete.
+{
+  const size = 3 * 1024 * 1024 + 17;
+  const ret = spawnSync(process.execPath, [
+    '-e', `process.stdout.write('x'.repeat(${size}))`
+  ], { maxBuffer: Infinity });
+
+  assert.ifError(ret.error);
+  assert.strictEqual(ret.stdout.length, size);
+  assert.strictEqual(ret.stdout.toString(), 'x'.repeat(size));
+}
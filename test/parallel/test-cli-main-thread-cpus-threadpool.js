@@ -0,0 +1,42 @@
+'use strict';
+const common = require('../common');
+if (!common.isLinux)
+  common.skip('restricting threads to CPUs is only supported on Linux');
+
+// Restricting the main thread does not restrict the threadpool, even though
+// libuv only starts the pool once it is first used.
+
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+
+function allowedCpus(file) {
+  return /^Cpus_allowed_list:\s*(\S+)/m.exec(
+    fs.readFileSync(file, 'latin1'))[1];
+}
+
+if (process.argv[2] === 'child') {
+  fs.readFile(__filename, common.mustCall((err) => {
+    assert.ifError(err);
+    const tasks = fs.readdirSync('/proc/self/task');
+    const unrestricted = tasks.filter((tid) => {
+      return allowedCpus(`/proc/self/task/${tid}/status`) === process.argv[3];
+    });
+    console.log(unrestricted.length);
+  }));
+  return;
+}
+
+const processCpus = allowedCpus('/proc/self/status');
+const cpu = /^\d+/.exec(processCpus)[0];
+if (processCpus === cpu)
+  common.skip('the process is only allowed to run on a single CPU');
+
+const child = spawnSync(process.execPath,
+                        [`--main-thread-cpus=${cpu}`,
+                         __filename, 'child', processCpus],
+                        { env: { ...process.env, UV_THREADPOOL_SIZE: '2' } });
+assert.strictEqual(child.stderr.toString(), '');
+assert.strictEqual(child.status, 0);
+// Both threads of the pool keep the affinity of the process.
+assert.strictEqual(+child.stdout.toString(), 2);
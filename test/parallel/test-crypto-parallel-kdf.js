@@ -0,0 +1,48 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// This test checks that asynchronous PBKDF2 and scrypt derivations, which
+// split their work across threads of the pool, derive the same keys as the
+// synchronous ones.
+
+const assert = require('assert');
+const crypto = require('crypto');
+
+// Keys that consist of several blocks, the last of which is partial.
+for (const [digest, keylen] of [['sha1', 333], ['sha256', 100],
+                                ['sha512', 1000]]) {
+  for (const password of ['password', '']) {
+    const expected =
+      crypto.pbkdf2Sync(password, 'salt', 1000, keylen, digest);
+    crypto.pbkdf2(password, 'salt', 1000, keylen, digest,
+                  common.mustCall((err, key) => {
+                    assert.ifError(err);
+                    assert.deepStrictEqual(key, expected);
+                  }));
+  }
+}
+
+// RFC 7914, section 12.
+crypto.scrypt('password', 'NaCl', 64, { N: 1024, r: 8, p: 16 },
+              common.mustCall((err, key) => {
+                assert.ifError(err);
+                assert.strictEqual(
+                  key.toString('hex'),
+                  'fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b' +
+                  '3731622eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360' +
+                  'cbdfa2cc0640');
+              }));
+
+// The number of lanes that are mixed at the same time is limited by maxmem,
+// which only leaves room for one lane in the last case.
+for (const options of [{ N: 256, r: 4, p: 7 },
+                       { N: 16, r: 1, p: 64 },
+                       { N: 1024, r: 8, p: 3, maxmem: 2 * 1024 * 1024 }]) {
+  const expected = crypto.scryptSync('secret', 'salt', 48, options);
+  crypto.scrypt('secret', 'salt', 48, options, common.mustCall((err, key) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(key, expected);
+  }));
+}
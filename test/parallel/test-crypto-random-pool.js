@@ -0,0 +1,55 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// This test checks the pool that serves small synchronous requests of
+// crypto.randomBytes() and crypto.randomFillSync().
+
+const assert = require('assert');
+const crypto = require('crypto');
+
+// Bytes are never handed out twice, across several refills of the pool.
+{
+  const seen = new Set();
+  for (let i = 0; i < 4096; i++) {
+    const bytes = crypto.randomBytes(16);
+    assert.strictEqual(bytes.length, 16);
+    const hex = bytes.toString('hex');
+    assert.ok(!seen.has(hex));
+    seen.add(hex);
+  }
+}
+
+// Requests at and above the largest size that the pool serves.
+for (const size of [1, 255, 256, 257, 4096]) {
+  const bytes = crypto.randomBytes(size);
+  assert.strictEqual(bytes.length, size);
+  if (size >= 16)
+    assert.notDeepStrictEqual(bytes, Buffer.alloc(size));
+}
+
+// Only the requested range of other views is filled.
+for (const ctor of [Uint8Array, Uint8ClampedArray, Uint16Array, Float64Array,
+                    DataView]) {
+  const buffer = new ArrayBuffer(64);
+  const elementSize = ctor.BYTES_PER_ELEMENT || 1;
+  const view = new ctor(buffer, 8, 48 / elementSize);
+  crypto.randomFillSync(view, 16 / elementSize, 16 / elementSize);
+
+  const bytes = Buffer.from(buffer);
+  assert.deepStrictEqual(bytes.slice(0, 24), Buffer.alloc(24));
+  assert.notDeepStrictEqual(bytes.slice(24, 40), Buffer.alloc(16));
+  assert.deepStrictEqual(bytes.slice(40), Buffer.alloc(24));
+}
+
+// Asynchronous requests still work while the spare pool is being refilled.
+{
+  for (let i = 0; i < 400; i++)
+    crypto.randomBytes(16);
+  crypto.randomBytes(16, common.mustCall((err, bytes) => {
+    assert.ifError(err);
+    assert.strictEqual(bytes.length, 16);
+    assert.strictEqual(crypto.randomBytes(16).length, 16);
+  }));
+}
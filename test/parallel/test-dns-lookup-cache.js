@@ -0,0 +1,102 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dns = require('dns');
+const { Worker } = require('worker_threads');
+
+// 'localhost' is resolved through /etc/hosts or its equivalent, so these
+// lookups do not depend on the network.
+
+[null, 'foo', 1].forEach((options) => {
+  common.expectsError(() => dns.enableLookupCache(options), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+['ttl', 'negativeTtl', 'staleTtl', 'maxEntries'].forEach((name) => {
+  [-1, 1.5, '1'].forEach((value) => {
+    assert.throws(() => dns.enableLookupCache({ [name]: value }), {
+      code: /^ERR_(OUT_OF_RANGE|INVALID_ARG_TYPE)$/
+    });
+  });
+});
+
+function lookup(options = {}) {
+  return new Promise((resolve, reject) => {
+    dns.lookup('localhost', { all: true, ...options }, (err, addresses) => {
+      if (err) reject(err);
+      else resolve(addresses);
+    });
+  });
+}
+
+function lookupInWorker() {
+  return new Promise((resolve) => {
+    const w = new Worker(`
+      const dns = require('dns');
+      const { parentPort } = require('worker_threads');
+      dns.lookup('localhost', { all: true }, (err, addresses) => {
+        if (err) throw err;
+        parentPort.postMessage(addresses);
+      });
+    `, { eval: true });
+    w.on('message', resolve);
+  });
+}
+
+async function main() {
+  // Lookups are not cached by default.
+  await lookup();
+  await lookup();
+  assert.strictEqual(dns.getLookupCacheStats().size, 0);
+
+  dns.enableLookupCache({ ttl: 60000 });
+  const expected = await lookup();
+  assert.deepStrictEqual(await lookup(), expected);
+  assert.deepStrictEqual(await lookup({ verbatim: true }),
+                         await lookup({ verbatim: true }));
+  let stats = dns.getLookupCacheStats();
+  assert.strictEqual(stats.misses, 1);
+  assert.strictEqual(stats.hits, 3);
+  assert.strictEqual(stats.size, 1);
+
+  // Different families are cached separately.
+  await lookup({ family: 4 });
+  assert.strictEqual(dns.getLookupCacheStats().size, 2);
+
+  // The cache is shared with Worker threads.
+  assert.deepStrictEqual(await lookupInWorker(), expected);
+  assert.strictEqual(dns.getLookupCacheStats().hits, 4);
+
+  // Concurrent lookups are coalesced.
+  dns.clearLookupCache();
+  const results = await Promise.all([lookup(), lookup(), lookup()]);
+  results.forEach((result) => assert.deepStrictEqual(result, expected));
+  stats = dns.getLookupCacheStats();
+  assert.strictEqual(stats.misses, 3);
+  assert.strictEqual(stats.coalesced, 2);
+  assert.strictEqual(stats.hits, 0);
+
+  // Expired entries are served while they are refreshed.
+  dns.enableLookupCache({ ttl: 1, staleTtl: 60000 });
+  dns.clearLookupCache();
+  await lookup();
+  await new Promise((resolve) => setTimeout(resolve, 10));
+  assert.deepStrictEqual(await lookup(), expected);
+  stats = dns.getLookupCacheStats();
+  assert.strictEqual(stats.misses, 1);
+  assert.strictEqual(stats.staleHits, 1);
+
+  // The promises API uses the cache as well.
+  dns.enableLookupCache();
+  dns.clearLookupCache();
+  await dns.promises.lookup('localhost');
+  await dns.promises.lookup('localhost');
+  assert.strictEqual(dns.getLookupCacheStats().hits, 1);
+
+  dns.disableLookupCache();
+  assert.strictEqual(dns.getLookupCacheStats().size, 0);
+  await lookup();
+  assert.strictEqual(dns.getLookupCacheStats().size, 0);
+}
+
+main().then(common.mustCall());
@@ -0,0 +1,88 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const dns = require('dns');
+const net = require('net');
+
+const dnsPromises = dns.promises;
+
+assert.strictEqual(dns.getLookupMode(), 'getaddrinfo');
+
+[undefined, null, '', 'CARES', 'libc', 1].forEach((mode) => {
+  common.expectsError(() => dns.setLookupMode(mode), {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: TypeError
+  });
+});
+assert.strictEqual(dns.getLookupMode(), 'getaddrinfo');
+
+function sortAddresses(addresses) {
+  return addresses.map(({ address, family }) => `${family}:${address}`).sort();
+}
+
+// 'localhost' is resolved from the hosts file in 'cares' mode, so both modes
+// should see the same addresses.
+dns.lookup('localhost', { all: true }, common.mustCall((err, expected) => {
+  assert.ifError(err);
+  dns.setLookupMode('cares');
+  assert.strictEqual(dns.getLookupMode(), 'cares');
+
+  dns.lookup('localhost', { all: true }, common.mustCall((err, addresses) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(sortAddresses(addresses), sortAddresses(expected));
+
+    dns.lookup('localhost', 4, common.mustCall((err, address, family) => {
+      assert.ifError(err);
+      assert.strictEqual(family, 4);
+      assert.strictEqual(net.isIPv4(address), true);
+    }));
+
+    // Pending lookups do not keep the servers from being changed, and later
+    // lookups use the new servers.
+    dns.lookup('localhost', common.mustCall((err) => {
+      assert.ifError(err);
+      dns.lookup('localhost', common.mustCall((err) => assert.ifError(err)));
+    }));
+    dns.setServers(dns.getServers());
+
+    dnsPromises.lookup('localhost', { all: true }).then(common.mustCall(
+      (addresses) => {
+        assert.deepStrictEqual(sortAddresses(addresses),
+                               sortAddresses(expected));
+      }));
+
+    // net.connect() picks up the mode through dns.lookup().
+    const server = net.createServer(common.mustCall((socket) => {
+      socket.end();
+      server.close();
+    }));
+    server.listen(0, '127.0.0.1', common.mustCall(() => {
+      const socket = net.connect({
+        host: 'localhost',
+        port: server.address().port,
+        family: 4
+      }, common.mustCall(() => {
+        assert.strictEqual(socket.remoteAddress, '127.0.0.1');
+      }));
+      socket.resume();
+    }));
+  }));
+}));
+
+{
+  const child = spawnSync(process.execPath, [
+    '--dns-lookup-mode=cares',
+    '-p', 'require("dns").getLookupMode()'
+  ]);
+  assert.strictEqual(child.status, 0);
+  assert.strictEqual(child.stdout.toString().trim(), 'cares');
+}
+
+{
+  const child = spawnSync(process.execPath,
+                          ['--dns-lookup-mode=libc', '-e', '']);
+  assert.strictEqual(child.status, 9);
+  assert(child.stderr.toString().includes(
+    'invalid value for --dns-lookup-mode'));
+}
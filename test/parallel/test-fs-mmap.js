@@ -0,0 +1,128 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const { Worker } = require('worker_threads');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const file = path.join(tmpdir.path, 'mapped');
+const contents = Buffer.alloc(3 * 4096 + 123);
+for (let i = 0; i < contents.length; i++)
+  contents[i] = i % 251;
+fs.writeFileSync(file, contents);
+
+const notMappedError = { code: 'ERR_INVALID_ARG_VALUE' };
+
+// Read-only mappings, at offsets that are not page aligned.
+{
+  const fd = fs.openSync(file, 'r');
+  for (const [offset, length] of [[0, contents.length], [4097, 1000]]) {
+    const buffer = fs.mmap(fd, offset, length);
+    assert.ok(buffer instanceof Buffer);
+    assert.deepStrictEqual(buffer, contents.slice(offset, offset + length));
+
+    fs.madvise(buffer, 'sequential');
+    fs.madvise(buffer.slice(100, 200), 'willneed');
+    fs.munmap(buffer.slice(1));
+    assert.strictEqual(buffer.length, 0);
+    assert.throws(() => fs.munmap(buffer), notMappedError);
+  }
+
+  // The range must be within the file.
+  assert.throws(() => fs.mmap(fd, 0, contents.length + 1), {
+    code: 'EINVAL',
+    syscall: 'mmap'
+  });
+  assert.throws(() => fs.mmap(fd, contents.length, 1), { code: 'EINVAL' });
+
+  // The mapping outlives the file descriptor.
+  const buffer = fs.mmap(fd, 0, 10);
+  fs.closeSync(fd);
+  assert.deepStrictEqual(buffer, contents.slice(0, 10));
+}
+
+// Releasing a mapping that a pending operation still uses does not crash.
+{
+  const fd = fs.openSync(file, 'r');
+  const buffer = fs.mmap(fd, 0, contents.length);
+  fs.closeSync(fd);
+  const out = fs.openSync(path.join(tmpdir.path, 'out'), 'w');
+  fs.write(out, buffer, common.mustCall((err, written) => {
+    assert.ifError(err);
+    assert.strictEqual(written, contents.length);
+    fs.closeSync(out);
+  }));
+  fs.munmap(buffer);
+  assert.strictEqual(buffer.length, 0);
+}
+
+// Writes to shared mappings end up in the file, writes to private ones don't.
+{
+  const fd = fs.openSync(file, 'r+');
+  const shared = fs.mmap(fd, 0, 10, { readOnly: false });
+  const priv = fs.mmap(fd, 10, 10, { readOnly: false, shared: false });
+  shared.fill(1);
+  priv.fill(2);
+  fs.munmap(shared);
+  fs.munmap(priv);
+  fs.closeSync(fd);
+
+  const data = fs.readFileSync(file);
+  assert.deepStrictEqual(data.slice(0, 10), Buffer.alloc(10, 1));
+  assert.deepStrictEqual(data.slice(10, 20), contents.slice(10, 20));
+}
+
+// Mappings backed by a SharedArrayBuffer are shared with Workers.
+{
+  const fd = fs.openSync(file, 'r+');
+  const buffer = fs.mmap(fd, 0, 4, {
+    readOnly: false,
+    sharedArrayBuffer: true
+  });
+  fs.closeSync(fd);
+  assert.ok(buffer.buffer instanceof SharedArrayBuffer);
+  fs.madvise(buffer, 'random');
+  assert.throws(() => fs.munmap(buffer), notMappedError);
+
+  const worker = new Worker(`
+    const { parentPort } = require('worker_threads');
+    parentPort.once('message', (sab) => {
+      const view = new Uint8Array(sab);
+      view[0] = 42;
+      parentPort.postMessage(view[1]);
+    });
+  `, { eval: true });
+  worker.postMessage(buffer.buffer);
+  worker.once('message', common.mustCall((value) => {
+    assert.strictEqual(value, buffer[1]);
+    assert.strictEqual(buffer[0], 42);
+  }));
+}
+
+// Buffers that are not backed by a mapping.
+assert.throws(() => fs.munmap(Buffer.alloc(10)), notMappedError);
+assert.throws(() => fs.madvise(Buffer.alloc(10), 'normal'), notMappedError);
+
+// Invalid arguments.
+{
+  const fd = fs.openSync(file, 'r');
+  const buffer = fs.mmap(fd, 0, 10);
+  assert.throws(() => fs.madvise(buffer, 'often'), {
+    code: 'ERR_INVALID_ARG_VALUE'
+  });
+  assert.throws(() => fs.mmap(-1, 0, 10), { code: 'ERR_OUT_OF_RANGE' });
+  assert.throws(() => fs.mmap(fd, -1, 10), { code: 'ERR_OUT_OF_RANGE' });
+  assert.throws(() => fs.mmap(fd, 0, 0), { code: 'ERR_OUT_OF_RANGE' });
+  assert.throws(() => fs.mmap(fd, 0, 1.5), { code: 'ERR_OUT_OF_RANGE' });
+  assert.throws(() => fs.mmap(fd, 0, 10, { readOnly: 1 }), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  assert.throws(() => fs.mmap(fd, 0, 10, null), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  fs.closeSync(fd);
+}
@@ -0,0 +1,167 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+
+const testDir = tmpdir.path;
+const files = ['empty', 'files', 'for', 'just', 'testing'];
+
+// Make sure tmp directory is clean
+tmpdir.refresh();
+
+// Create the necessary files
+files.forEach(function(filename) {
+  fs.closeSync(fs.openSync(path.join(testDir, filename), 'w'));
+});
+
+function assertDirent(dirent) {
+  assert(dirent instanceof fs.Dirent);
+  assert.strictEqual(dirent.isFile(), true);
+  assert.strictEqual(dirent.isDirectory(), false);
+  assert.strictEqual(dirent.isSocket(), false);
+  assert.strictEqual(dirent.isBlockDevice(), false);
+  assert.strictEqual(dirent.isCharacterDevice(), false);
+  assert.strictEqual(dirent.isFIFO(), false);
+  assert.strictEqual(dirent.isSymbolicLink(), false);
+}
+
+const dirclosedError = {
+  code: 'ERR_DIR_CLOSED'
+};
+
+const dirconcurrentError = {
+  code: 'ERR_DIR_CONCURRENT_OPERATION'
+};
+
+// Check the opendir Sync version, with batches smaller than, equal to and
+// larger than the directory.
+for (const bufferSize of [1, 2, 5, 32, 4096]) {
+  const dir = fs.opendirSync(testDir, { bufferSize });
+  assert.strictEqual(dir.path, testDir);
+  const entries = [];
+  let dirent;
+  while ((dirent = dir.readSync()) !== null) {
+    assertDirent(dirent);
+    entries.push(dirent.name);
+  }
+  assert.deepStrictEqual(entries.sort(), files);
+  assert.strictEqual(dir.readSync(), null);
+  dir.closeSync();
+
+  assert.throws(() => dir.readSync(), dirclosedError);
+  assert.throws(() => dir.closeSync(), dirclosedError);
+}
+
+// Check the opendir async version
+fs.opendir(testDir, { bufferSize: 2 }, common.mustCall((err, dir) => {
+  assert.ifError(err);
+  const entries = [];
+  dir.read(common.mustCall(function onRead(err, dirent) {
+    assert.ifError(err);
+    if (dirent === null) {
+      assert.deepStrictEqual(entries.sort(), files);
+      dir.close(common.mustCall((err) => {
+        assert.ifError(err);
+        assert.throws(() => dir.read(common.mustNotCall()), dirclosedError);
+      }));
+      return;
+    }
+    assertDirent(dirent);
+    entries.push(dirent.name);
+    dir.read(common.mustCall(onRead));
+  }));
+}));
+
+// Reads that are issued while another one is pending are queued, and each
+// entry is returned once.
+{
+  const dir = fs.opendirSync(testDir, { bufferSize: 1 });
+  const entries = [];
+  let pending = files.length + 1;
+  for (let i = 0; i <= files.length; i++) {
+    dir.read(common.mustCall((err, dirent) => {
+      assert.ifError(err);
+      if (dirent !== null)
+        entries.push(dirent.name);
+      if (--pending === 0) {
+        assert.deepStrictEqual(entries.sort(), files);
+        dir.closeSync();
+      }
+    }));
+  }
+  assert.throws(() => dir.readSync(), dirconcurrentError);
+  assert.throws(() => dir.closeSync(), dirconcurrentError);
+}
+
+// Promise-based tests
+async function doPromiseTest() {
+  // Check the opendir Promise version
+  const dir = await fs.promises.opendir(testDir);
+  const entries = [];
+
+  let i = files.length;
+  while (i--) {
+    const dirent = await dir.read();
+    entries.push(dirent.name);
+    assertDirent(dirent);
+  }
+
+  assert.deepStrictEqual(entries.sort(), files);
+  assert.strictEqual(await dir.read(), null);
+
+  // Check promise close
+  await dir.close();
+  assert.throws(() => dir.read(), dirclosedError);
+}
+doPromiseTest().then(common.mustCall());
+
+// Async iterator
+async function doAsyncIterTest() {
+  const entries = [];
+  for await (const dirent of await fs.promises.opendir(testDir)) {
+    entries.push(dirent.name);
+    assertDirent(dirent);
+  }
+
+  assert.deepStrictEqual(entries.sort(), files);
+
+  // Automatically closed during iterator
+}
+doAsyncIterTest().then(common.mustCall());
+
+// Async iterators should do automatic cleanup when the loop is left early
+async function doAsyncIterBreakTest() {
+  const dir = await fs.promises.opendir(testDir);
+  for await (const dirent of dir) { // eslint-disable-line no-unused-vars
+    break;
+  }
+
+  await assert.rejects(async () => dir.read(), dirclosedError);
+}
+doAsyncIterBreakTest().then(common.mustCall());
+
+// Missing directories and invalid arguments
+assert.throws(() => fs.opendirSync(path.join(testDir, 'missing')), {
+  code: 'ENOENT',
+  syscall: 'opendir'
+});
+fs.opendir(path.join(testDir, 'missing'), common.mustCall((err) => {
+  assert.strictEqual(err.code, 'ENOENT');
+}));
+assert.rejects(fs.promises.opendir(path.join(testDir, 'empty')), {
+  code: 'ENOTDIR'
+}).then(common.mustCall());
+
+for (const bufferSize of [0, 4097, 1.5]) {
+  assert.throws(() => fs.opendirSync(testDir, { bufferSize }), {
+    code: 'ERR_OUT_OF_RANGE'
+  });
+}
+assert.throws(() => fs.opendirSync(testDir, { bufferSize: '1' }), {
+  code: 'ERR_INVALID_ARG_TYPE'
+});
+assert.throws(() => fs.opendir(testDir), { code: 'ERR_INVALID_CALLBACK' });
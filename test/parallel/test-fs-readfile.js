@@ -57,3 +57,29 @@ for (const e of fileInfo) {
     assert.deepStrictEqual(buf, e.contents);
   }));
 }
+
+// Test that the contents are decoded by readFile when an encoding is given.
+for (const encoding of ['hex', 'latin1', 'base64']) {
+  const e = fileInfo[0];
+  fs.readFile(e.name, { encoding }, common.mustCall((err, str) => {
+    assert.ifError(err);
+    assert.strictEqual(str, e.contents.toString(encoding));
+  }));
+  fs.promises.readFile(e.name, encoding).then(common.mustCall((str) => {
+    assert.strictEqual(str, e.contents.toString(encoding));
+  }));
+}
+
+// Test that the flag is passed on, and that errors from open() have a path.
+{
+  const name = path.join(tmpdir.path, `${prefix}-new.txt`);
+  fs.readFile(name, { flag: 'a+' }, common.mustCall((err, buf) => {
+    assert.ifError(err);
+    assert.strictEqual(buf.length, 0);
+    fs.readFile(name, { flag: 'wx+' }, common.mustCall((err) => {
+      assert.strictEqual(err.code, 'EEXIST');
+      assert.strictEqual(err.syscall, 'open');
+      assert.strictEqual(err.path, name);
+    }));
+  }));
+}
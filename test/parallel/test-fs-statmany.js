@@ -0,0 +1,84 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+// Enough paths to be split across several threadpool tasks.
+const paths = [];
+for (let i = 0; i < 300; i++) {
+  const file = path.join(tmpdir.path, `file${i}`);
+  if (i % 7 !== 0)
+    fs.writeFileSync(file, 'x'.repeat(i));
+  paths.push(file);
+}
+paths.push(tmpdir.path, Buffer.from(paths[1]));
+
+function checkBatch(batch, bigint) {
+  assert.strictEqual(batch.length, paths.length);
+  assert.strictEqual(batch.errors.length, paths.length);
+  assert.ok(bigint ? batch.stats instanceof BigUint64Array :
+    batch.stats instanceof Float64Array);
+
+  for (let i = 0; i < batch.length; i++) {
+    assert.strictEqual(batch.paths[i], paths[i]);
+    if (i < 300 && i % 7 === 0) {
+      assert.strictEqual(batch.stat(i), undefined);
+      const err = batch.error(i);
+      assert.strictEqual(err.code, 'ENOENT');
+      assert.strictEqual(err.syscall, 'stat');
+      assert.strictEqual(err.path, paths[i]);
+      continue;
+    }
+    assert.strictEqual(batch.errors[i], 0);
+    assert.strictEqual(batch.error(i), undefined);
+    const stats = batch.stat(i);
+    const expected = fs.statSync(paths[i], { bigint });
+    assert.ok(stats instanceof fs.Stats);
+    assert.strictEqual(stats.ino, expected.ino);
+    assert.strictEqual(stats.size, expected.size);
+    assert.strictEqual(stats.mode, expected.mode);
+    assert.strictEqual(stats.isDirectory(), expected.isDirectory());
+  }
+}
+
+checkBatch(fs.statManySync(paths), false);
+checkBatch(fs.statManySync(paths, { bigint: true }), true);
+
+fs.statMany(paths, common.mustCall((err, batch) => {
+  assert.ifError(err);
+  checkBatch(batch, false);
+}));
+
+fs.statMany(paths, { bigint: true }, common.mustCall((err, batch) => {
+  assert.ifError(err);
+  checkBatch(batch, true);
+}));
+
+fs.promises.statMany(paths).then(common.mustCall((batch) => {
+  checkBatch(batch, false);
+}));
+
+// Empty lists do not reach the binding.
+assert.strictEqual(fs.statManySync([]).length, 0);
+fs.statMany([], common.mustCall((err, batch) => {
+  assert.ifError(err);
+  assert.strictEqual(batch.length, 0);
+}));
+
+// Invalid arguments.
+assert.throws(() => fs.statManySync('file'), {
+  code: 'ERR_INVALID_ARG_TYPE'
+});
+assert.throws(() => fs.statManySync([paths[1], 1]), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  message: /paths\[1\]/
+});
+assert.throws(() => fs.statMany(paths), { code: 'ERR_INVALID_CALLBACK' });
+assert.rejects(fs.promises.statMany([null]), {
+  code: 'ERR_INVALID_ARG_TYPE'
+}).then(common.mustCall());
@@ -0,0 +1,106 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+// Create a tree with a few levels of directories.
+const root = path.join(tmpdir.path, 'tree');
+const expected = [];
+function create(relative, depth) {
+  fs.mkdirSync(path.join(root, relative), { recursive: true });
+  for (let i = 0; i < 5; i++) {
+    const file = path.join(relative, `file${i}`);
+    fs.writeFileSync(path.join(root, file), 'x'.repeat(i));
+    expected.push({ path: file, depth, dir: false });
+  }
+  if (depth < 3) {
+    for (const name of ['a', 'b', 'skipped']) {
+      const dir = path.join(relative, name);
+      expected.push({ path: dir, depth, dir: true });
+      create(dir, depth + 1);
+    }
+  }
+}
+create('', 0);
+
+async function collect(options) {
+  const paths = [];
+  for await (const batch of fs.walk(root, options)) {
+    assert.strictEqual(batch.types.length, batch.length);
+    if (options && options.batchSize)
+      assert.ok(batch.length <= options.batchSize);
+    for (let i = 0; i < batch.length; i++) {
+      const dirent = batch.dirent(i);
+      assert.strictEqual(dirent.name, batch.paths[i]);
+      const stats = fs.lstatSync(path.join(root, dirent.name));
+      assert.strictEqual(dirent.isDirectory(), stats.isDirectory());
+      assert.strictEqual(dirent.isFile(), stats.isFile());
+      if (options && options.stat) {
+        const walkStats = batch.stat(i);
+        assert.strictEqual(walkStats.ino, stats.ino);
+        assert.strictEqual(walkStats.size, stats.size);
+        assert.strictEqual(walkStats.isDirectory(), stats.isDirectory());
+      } else {
+        assert.strictEqual(batch.stats, undefined);
+      }
+      paths.push(dirent.name);
+    }
+  }
+  return paths.sort();
+}
+
+function expect(filter) {
+  return expected.filter(filter).map((entry) => entry.path).sort();
+}
+
+const skipped = `${path.sep}skipped`;
+const tests = [
+  [undefined, () => true],
+  [{ stat: true, batchSize: 7 }, () => true],
+  [{ batchSize: 1, concurrency: 1 }, () => true],
+  [{ maxDepth: 0 }, (entry) => entry.depth === 0],
+  [{ maxDepth: 1 }, (entry) => entry.depth <= 1],
+  [{ prefix: 'a/b/' }, (entry) => entry.path.startsWith(`a${path.sep}b` +
+                                                        path.sep)],
+  [{ prefix: 'a/file' }, (entry) => entry.path.startsWith(`a${path.sep}file`)],
+  [{ skipDirs: ['skipped'] }, (entry) => !entry.path.startsWith('skipped') &&
+                                        !entry.path.includes(skipped)]
+];
+
+(async () => {
+  for (const [options, filter] of tests)
+    assert.deepStrictEqual(await collect(options), expect(filter));
+
+  // Leaving the loop early stops the walk.
+  for await (const batch of fs.walk(root, { batchSize: 2 })) {
+    assert.strictEqual(batch.length, 2);
+    break;
+  }
+
+  // Missing roots and files as roots.
+  await assert.rejects(fs.walk(path.join(root, 'missing')).next(), {
+    code: 'ENOENT',
+    syscall: 'scandir',
+    path: path.join(root, 'missing')
+  });
+  await assert.rejects(fs.walk(path.join(root, 'file0')).next(), {
+    code: 'ENOTDIR'
+  });
+})().then(common.mustCall());
+
+[
+  [{ maxDepth: -1 }, 'ERR_OUT_OF_RANGE'],
+  [{ prefix: 1 }, 'ERR_INVALID_ARG_TYPE'],
+  [{ skipDirs: 'a' }, 'ERR_INVALID_ARG_TYPE'],
+  [{ skipDirs: [1] }, 'ERR_INVALID_ARG_TYPE'],
+  [{ batchSize: 0 }, 'ERR_OUT_OF_RANGE'],
+  [{ concurrency: 0 }, 'ERR_OUT_OF_RANGE'],
+  [null, 'ERR_INVALID_ARG_TYPE']
+].forEach(([options, code]) => {
+  assert.throws(() => fs.walk(root, options), { code });
+});
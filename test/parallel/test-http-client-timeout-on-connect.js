@@ -19,7 +19,9 @@ server.listen(0, common.localhostIPv4, common.mustCall(() => {
   req.on('socket', common.mustCall((socket) => {
     assert.strictEqual(socket[kTimeout], null);
     socket.on('connect', common.mustCall(() => {
-      assert.strictEqual(socket[kTimeout]._idleTimeout, 1);
+      // The timeout is tracked by the TCP handle.
+      assert.strictEqual(socket[kTimeout], null);
+      assert.strictEqual(socket.timeout, 1);
     }));
   }));
   req.on('timeout', common.mustCall(() => req.abort()));
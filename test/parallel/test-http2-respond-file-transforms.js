@@ -0,0 +1,93 @@
+'use strict';
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+const fixtures = require('../common/fixtures');
+const http2 = require('http2');
+const assert = require('assert');
+const crypto = require('crypto');
+const fs = require('fs');
+const zlib = require('zlib');
+
+const {
+  HTTP2_HEADER_CONTENT_LENGTH,
+  HTTP2_HEADER_PATH
+} = http2.constants;
+
+const fname = fixtures.path('elipses.txt');
+const data = fs.readFileSync(fname);
+const expectedDigest =
+  crypto.createHash('sha256').update(data).digest('hex');
+
+const transforms = {
+  '/gzip': () => [zlib.createGzip()],
+  '/brotli': () => [zlib.createBrotliCompress()],
+  '/hash-gzip': () => [crypto.createHash('sha256'), zlib.createGzip()],
+  '/roundtrip': () => [zlib.createDeflate(), zlib.createInflate()]
+};
+const decompress = {
+  '/gzip': zlib.gunzipSync,
+  '/brotli': zlib.brotliDecompressSync,
+  '/hash-gzip': zlib.gunzipSync,
+  '/roundtrip': (buf) => buf
+};
+
+const server = http2.createServer();
+server.on('stream', common.mustCall((stream, headers) => {
+  const path = headers[HTTP2_HEADER_PATH];
+  const list = transforms[path]();
+  stream.respondWithFile(fname, {}, { transforms: list });
+  if (path === '/hash-gzip') {
+    stream.on('close', common.mustCall(() => {
+      assert.strictEqual(list[0].digest('hex'), expectedDigest);
+    }));
+  }
+}, Object.keys(transforms).length));
+
+server.listen(0, common.mustCall(() => {
+  const client = http2.connect(`http://localhost:${server.address().port}`);
+  let pending = Object.keys(transforms).length;
+
+  for (const path of Object.keys(transforms)) {
+    const req = client.request({ [HTTP2_HEADER_PATH]: path });
+    req.on('response', common.mustCall((headers) => {
+      assert.strictEqual(headers[HTTP2_HEADER_CONTENT_LENGTH], undefined);
+    }));
+    const chunks = [];
+    req.on('data', (chunk) => chunks.push(chunk));
+    req.on('end', common.mustCall(() => {
+      const body = decompress[path](Buffer.concat(chunks));
+      assert.deepStrictEqual(body, data);
+      if (--pending === 0) {
+        client.close();
+        server.close();
+      }
+    }));
+    req.end();
+  }
+}));
+
+{
+  // Invalid transforms are rejected synchronously.
+  const server = http2.createServer();
+  server.on('stream', common.mustCall((stream) => {
+    for (const transforms of [{}, [{}], [null], 'gzip']) {
+      assert.throws(() => stream.respondWithFile(fname, {}, { transforms }), {
+        code: 'ERR_INVALID_OPT_VALUE'
+      });
+    }
+    stream.respond();
+    stream.end();
+  }));
+  server.listen(0, common.mustCall(() => {
+    const client = http2.connect(`http://localhost:${server.address().port}`);
+    const req = client.request();
+    req.resume();
+    req.on('end', common.mustCall(() => {
+      client.close();
+      server.close();
+    }));
+    req.end();
+  }));
+}
@@ -0,0 +1,79 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+function runTest(options, chunks, expected) {
+  net.createServer(common.mustCall(function(socket) {
+    this.close();
+    // Write the chunks separately, so that lines are split across reads.
+    let i = 0;
+    (function writeNext() {
+      if (i === chunks.length)
+        return socket.end();
+      socket.write(chunks[i++], () => setTimeout(writeNext, 1));
+    })();
+  })).listen(0, function() {
+    const received = [];
+    const socket = net.connect(this.address().port);
+    socket.setFraming(options, common.mustCallAtLeast((frames) => {
+      assert(Array.isArray(frames));
+      for (const f of frames) {
+        if (options.encoding)
+          assert.strictEqual(typeof f, 'string');
+        else
+          assert(Buffer.isBuffer(f));
+        received.push(f.toString());
+      }
+    }));
+    socket.on('data', common.mustNotCall());
+    socket.on('end', common.mustCall(() => {
+      assert.deepStrictEqual(received, expected);
+    }));
+  });
+}
+
+// Lines split across reads, empty lines, and data after the last newline.
+runTest({ delimiter: '\n' },
+        ['{"a":1}\n{"b"', ':2}\n\n', '{"c":', '3}\n', 'tail'],
+        ['{"a":1}', '{"b":2}', '', '{"c":3}', 'tail']);
+
+// Multi-byte delimiters that are split across reads.
+runTest({ delimiter: '\r\n', encoding: 'utf8' },
+        ['GET / HTTP/1.1\r', '\nHost: a\r\n\r', '\n\r\r\n'],
+        ['GET / HTTP/1.1', 'Host: a', '', '\r']);
+
+// Multi-byte characters are not split.
+runTest({ delimiter: Buffer.from('||'), encoding: 'utf8' },
+        [Buffer.from('€|').slice(0, 2), Buffer.from('€|').slice(2), '|ü||'],
+        ['€', 'ü']);
+
+{
+  // Lines that are longer than maxFrameSize are rejected.
+  net.createServer(common.mustCall(function(socket) {
+    this.close();
+    socket.on('error', () => {});
+    socket.end('x'.repeat(100));
+  })).listen(0, function() {
+    const socket = net.connect(this.address().port);
+    socket.setFraming({ delimiter: '\n', maxFrameSize: 64 },
+                      common.mustNotCall());
+    socket.on('error', common.mustCall((err) => {
+      assert.strictEqual(err.code, 'EMSGSIZE');
+    }));
+  });
+}
+
+{
+  const socket = new net.Socket();
+  assert.throws(() => socket.setFraming({ delimiter: '' }, () => {}), {
+    code: 'ERR_INVALID_OPT_VALUE'
+  });
+  assert.throws(() => socket.setFraming({ delimiter: 10 }, () => {}), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  assert.throws(() => socket.setFraming({ delimiter: '\n', encoding: 'foo' },
+                                        () => {}), {
+    code: 'ERR_INVALID_OPT_VALUE_ENCODING'
+  });
+}
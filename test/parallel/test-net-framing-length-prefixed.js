@@ -0,0 +1,114 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+function frame(payload) {
+  const header = Buffer.alloc(4);
+  header.writeUInt32BE(payload.length, 0);
+  return Buffer.concat([header, Buffer.from(payload)]);
+}
+
+function runTest(options, chunks, expected) {
+  net.createServer(common.mustCall(function(socket) {
+    this.close();
+    // Write the chunks separately, so that frames are split across reads.
+    let i = 0;
+    (function writeNext() {
+      if (i === chunks.length)
+        return socket.end();
+      socket.write(chunks[i++], () => setTimeout(writeNext, 1));
+    })();
+  })).listen(0, function() {
+    const received = [];
+    const socket = net.connect(this.address().port);
+    socket.setFraming(options, common.mustCallAtLeast((frames) => {
+      assert(Array.isArray(frames));
+      for (const f of frames)
+        received.push(f.toString('latin1', options.headerSize || 4));
+    }));
+    socket.on('data', common.mustNotCall());
+    socket.on('end', common.mustCall(() => {
+      assert.deepStrictEqual(received, expected);
+    }));
+  });
+}
+
+{
+  // Several frames per write, and frames split across writes.
+  const all = Buffer.concat([frame('a'), frame(''), frame('hello'),
+                             frame('x'.repeat(1000))]);
+  runTest({ lengthSize: 4 },
+          [all.slice(0, 3), all.slice(3, 12), all.slice(12, 600),
+           all.slice(600)],
+          ['a', '', 'hello', 'x'.repeat(1000)]);
+}
+
+{
+  // Little-endian length field after a type byte, length includes header.
+  const frames = ['abc', 'defgh'].map((s) => {
+    const f = Buffer.alloc(5 + s.length);
+    f[0] = 0x42;
+    f.writeUInt32LE(f.length, 1);
+    f.write(s, 5, 'latin1');
+    return f;
+  });
+  runTest({ lengthSize: 4, lengthOffset: 1, headerSize: 5,
+            littleEndian: true, lengthIncludesHeader: true },
+          [Buffer.concat(frames)],
+          ['abc', 'defgh']);
+}
+
+{
+  // Frames that are larger than maxFrameSize are rejected.
+  net.createServer(common.mustCall(function(socket) {
+    this.close();
+    socket.on('error', () => {});
+    socket.end(frame('x'.repeat(100)));
+  })).listen(0, function() {
+    const socket = net.connect(this.address().port);
+    socket.setFraming({ lengthSize: 4, maxFrameSize: 64 },
+                      common.mustNotCall());
+    socket.on('error', common.mustCall((err) => {
+      assert.strictEqual(err.code, 'EMSGSIZE');
+    }));
+  });
+}
+
+{
+  // A frame that is cut off by the end of the stream is an error.
+  net.createServer(common.mustCall(function(socket) {
+    this.close();
+    socket.on('error', () => {});
+    socket.end(Buffer.concat([frame('abc'), frame('hello').slice(0, 6)]));
+  })).listen(0, function() {
+    const socket = net.connect(this.address().port);
+    socket.setFraming({ lengthSize: 4 }, common.mustCall((frames) => {
+      assert.deepStrictEqual(frames.map((f) => f.toString('latin1', 4)),
+                             ['abc']);
+    }));
+    socket.on('end', common.mustNotCall());
+    socket.on('error', common.mustCall((err) => {
+      assert.strictEqual(err.code, 'EPROTO');
+      assert.strictEqual(err.syscall, 'read');
+    }));
+  });
+}
+
+{
+  const socket = new net.Socket();
+  assert.throws(() => socket.setFraming({ lengthSize: 3 }, () => {}), {
+    code: 'ERR_INVALID_OPT_VALUE'
+  });
+  assert.throws(() => socket.setFraming({ lengthSize: 2, headerSize: 1 },
+                                        () => {}), {
+    code: 'ERR_INVALID_OPT_VALUE'
+  });
+  assert.throws(() => socket.setFraming({ lengthSize: 2 }), {
+    code: 'ERR_INVALID_CALLBACK'
+  });
+  socket.setFraming({ lengthSize: 2 }, () => {});
+  assert.throws(() => socket.setFraming({ lengthSize: 2 }, () => {}), {
+    code: 'ERR_SOCKET_FRAMING_ALREADY_SET'
+  });
+}
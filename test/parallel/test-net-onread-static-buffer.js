@@ -0,0 +1,90 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const message = Buffer.from('hello world');
+
+// Test typical usage
+net.createServer(common.mustCall(function(socket) {
+  this.close();
+  socket.end(message);
+})).listen(0, function() {
+  let received = 0;
+  const buffers = [];
+  const sockBuf = Buffer.alloc(8);
+  net.connect({
+    port: this.address().port,
+    onread: {
+      buffer: sockBuf,
+      callback: function(nread, buf) {
+        assert.strictEqual(buf, sockBuf);
+        received += nread;
+        buffers.push(Buffer.from(buf.slice(0, nread)));
+      }
+    }
+  }).on('data', common.mustNotCall()).on('end', common.mustCall(() => {
+    assert.strictEqual(received, message.length);
+    assert.deepStrictEqual(Buffer.concat(buffers), message);
+  }));
+});
+
+// Test Uint8Array support
+net.createServer(common.mustCall(function(socket) {
+  this.close();
+  socket.end(message);
+})).listen(0, function() {
+  let incoming = 0;
+  let bufCalls = 0;
+  let received = 0;
+  const buffers = [];
+  const sockBuf = new Uint8Array(8);
+  net.connect({
+    port: this.address().port,
+    onread: {
+      buffer: () => {
+        ++bufCalls;
+        return sockBuf;
+      },
+      callback: function(nread, buf) {
+        assert.strictEqual(buf, sockBuf);
+        ++incoming;
+        received += nread;
+        buffers.push(Buffer.from(buf.slice(0, nread)));
+      }
+    }
+  }).on('data', common.mustNotCall()).on('end', common.mustCall(() => {
+    assert.strictEqual(received, message.length);
+    assert.deepStrictEqual(Buffer.concat(buffers), message);
+    // One buffer for the initial read, and one after every read.
+    assert.strictEqual(bufCalls, incoming + 1);
+  }));
+});
+
+// Test returning false from callback pauses the socket
+net.createServer(common.mustCall(function(socket) {
+  this.close();
+  socket.end(message);
+})).listen(0, function() {
+  let received = 0;
+  const sockBuf = Buffer.alloc(message.length);
+  const client = net.connect({
+    port: this.address().port,
+    onread: {
+      buffer: sockBuf,
+      callback: common.mustCall(function(nread, buf) {
+        received += nread;
+        return false;
+      })
+    }
+  });
+  client.on('end', common.mustCall(() => {
+    assert.strictEqual(received, message.length);
+    assert.deepStrictEqual(sockBuf, message);
+  }));
+  setTimeout(common.mustCall(() => {
+    assert.strictEqual(client.isPaused(), false);
+    assert.strictEqual(client._handle.reading, false);
+    client.resume();
+  }), 100);
+});
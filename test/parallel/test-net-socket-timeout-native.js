@@ -0,0 +1,81 @@
+// Flags: --expose-internals
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+const { kTimeout } = require('internal/timers');
+
+// Idle timeouts of sockets that are backed by a libuv stream are tracked
+// by the handle instead of a JS timer.
+
+{
+  // Reads postpone the timeout.
+  const server = net.createServer(common.mustCall((socket) => {
+    let writes = 10;
+    const interval = setInterval(() => {
+      socket.write('x');
+      if (--writes === 0)
+        clearInterval(interval);
+    }, 20);
+    socket.on('error', () => {});
+  }));
+
+  server.listen(0, common.mustCall(() => {
+    const start = Date.now();
+    let lastData;
+    const socket = net.connect(server.address().port);
+    socket.on('data', () => lastData = Date.now());
+    socket.setTimeout(100, common.mustCall(() => {
+      assert.strictEqual(socket[kTimeout], null);
+      assert(Date.now() - start >= 200);
+      assert(Date.now() - lastData >= 100);
+      socket.destroy();
+      server.close();
+    }));
+  }));
+}
+
+{
+  // A timeout that was set before the handle was created is moved to the
+  // handle, and can be cleared again.
+  const server = net.createServer(common.mustCall((socket) => {
+    socket.on('error', () => {});
+  }));
+
+  server.listen(0, common.mustCall(() => {
+    const socket = new net.Socket();
+    socket.setTimeout(50, common.mustNotCall());
+    assert.notStrictEqual(socket[kTimeout], null);
+    socket.connect(server.address().port, common.mustCall(() => {
+      assert.strictEqual(socket[kTimeout], null);
+      socket.setTimeout(0);
+      setTimeout(() => {
+        socket.destroy();
+        server.close();
+      }, 200);
+    }));
+  }));
+}
+
+{
+  // The timeout fires again after further activity.
+  const server = net.createServer(common.mustCall((socket) => {
+    let timeouts = 0;
+    socket.on('error', () => {});
+    socket.resume();
+    socket.setTimeout(50, common.mustCall(() => {
+      if (++timeouts === 1) {
+        socket.write('ping');
+      } else {
+        socket.destroy();
+        server.close();
+      }
+    }, 2));
+  }));
+
+  server.listen(0, common.mustCall(() => {
+    const socket = net.connect(server.address().port);
+    socket.once('data', common.mustCall(() => socket.write('pong')));
+    socket.on('error', () => {});
+  }));
+}
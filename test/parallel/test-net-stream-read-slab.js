@@ -0,0 +1,37 @@
+// Flags: --stream-read-slab-size=1048576
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// Reads should land in shared slabs, so that consecutive chunks are views
+// into the same ArrayBuffer.
+
+const kSlabSize = 1024 * 1024;
+const chunks = [];
+
+const server = net.createServer(common.mustCall((socket) => {
+  socket.on('data', (chunk) => chunks.push(chunk));
+  socket.on('end', common.mustCall(() => {
+    const received = Buffer.concat(chunks);
+    assert.strictEqual(received.length, 3 * 1024);
+    assert.strictEqual(received.toString('latin1'), 'x'.repeat(3 * 1024));
+
+    for (const chunk of chunks) {
+      assert.strictEqual(chunk.buffer.byteLength, kSlabSize);
+      assert.ok(chunk.byteOffset + chunk.length <= kSlabSize);
+    }
+    server.close();
+  }));
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port, common.mustCall(() => {
+    let i = 0;
+    (function writeNext() {
+      if (i++ === 3)
+        return client.end();
+      client.write('x'.repeat(1024), () => setTimeout(writeNext, 10));
+    })();
+  }));
+}));
@@ -0,0 +1,36 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// When writing a batch of coalesced writes fails, the error is passed to
+// the callbacks of these writes.
+
+const kErrorCodes = ['EPIPE', 'ECONNRESET', 'ECONNABORTED'];
+
+const server = net.createServer(common.mustCall((socket) => {
+  socket.destroy();
+  server.close();
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect({
+    port: server.address().port,
+    allowHalfOpen: true
+  });
+  client.setWriteCoalescing(true);
+
+  client.on('error', common.mustCall((err) => {
+    assert(kErrorCodes.includes(err.code), err);
+  }));
+
+  // The peer has closed its end; keep writing until the OS reports that.
+  client.on('end', common.mustCall(function write() {
+    client.write('x', common.mustCall((err) => {
+      if (!err)
+        return setImmediate(write);
+      assert(kErrorCodes.includes(err.code), err);
+      assert.strictEqual(err.syscall, 'write');
+    }));
+  }));
+}));
@@ -0,0 +1,62 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// Small writes are collected natively until the end of the event loop turn,
+// when they are written together. Their callbacks run once that has happened.
+
+const kChunks = 100;
+const chunk = 'abcd';
+const large = 'x'.repeat(16);
+
+const server = net.createServer(common.mustCall((socket) => {
+  let received = '';
+  socket.setEncoding('latin1');
+  socket.on('data', (data) => received += data);
+  socket.on('end', common.mustCall(() => {
+    assert.strictEqual(received, chunk.repeat(kChunks) + large + chunk);
+    server.close();
+  }));
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port);
+  assert.strictEqual(client.setWriteCoalescing(true), client);
+
+  client.on('connect', common.mustCall(() => {
+    const order = [];
+    for (let i = 0; i < kChunks; i++)
+      client.write(chunk, common.mustCall(() => order.push(i)));
+
+    // The first write has been taken over by the handle, but has not been
+    // passed to the OS yet. Without coalescing, it would have been written
+    // synchronously. The others are queued in JS until it has finished, and
+    // are then passed down together.
+    assert.strictEqual(client._handle.writeQueueSize, chunk.length);
+    assert.strictEqual(client.writableLength, chunk.length * kChunks);
+    assert.strictEqual(order.length, 0);
+
+    client.write('', common.mustCall(() => {
+      assert.deepStrictEqual(order, [...Array(kChunks).keys()]);
+      assert.strictEqual(client.writableLength, 0);
+
+      // Writes that are larger than the threshold are not copied. libuv on
+      // Windows does not try to write synchronously, so the later write
+      // takes the regular path there.
+      client.setWriteCoalescing(true, 10);
+      client.write(large);
+      if (!common.isWindows)
+        assert.strictEqual(client._handle.writeQueueSize, 0);
+      client.write(chunk);
+      if (!common.isWindows)
+        assert.strictEqual(client._handle.writeQueueSize, chunk.length);
+
+      client.end();
+    }));
+  }));
+}));
+
+assert.throws(() => new net.Socket().setWriteCoalescing(true, -1), {
+  code: 'ERR_OUT_OF_RANGE'
+});
@@ -0,0 +1,54 @@
+// Flags: --expose-internals
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const { internalBinding } = require('internal/test/binding');
+const {
+  CoarseTimer,
+  coarseTimerResolution
+} = internalBinding('timers');
+
+assert(Number.isInteger(coarseTimerResolution));
+assert(coarseTimerResolution > 0);
+
+{
+  // Timers never fire early.
+  const timer = new CoarseTimer();
+  assert.strictEqual(timer.hasRef(), true);
+  const start = Date.now();
+  timer.ontimeout = common.mustCall(() => {
+    assert(Date.now() - start >= 100);
+  });
+  timer.start(100);
+}
+
+{
+  // Re-arming a timer postpones it.
+  const timer = new CoarseTimer();
+  const start = Date.now();
+  timer.ontimeout = common.mustCall(() => {
+    assert(Date.now() - start >= 220);
+  });
+  timer.start(100);
+  setTimeout(() => timer.start(200), 20);
+}
+
+{
+  // Stopped timers do not fire.
+  const timer = new CoarseTimer();
+  timer.ontimeout = common.mustNotCall();
+  timer.start(10);
+  timer.stop();
+}
+
+{
+  // Unref'ed timers do not keep the event loop alive.
+  const timer = new CoarseTimer();
+  timer.ontimeout = common.mustNotCall();
+  timer.unref();
+  assert.strictEqual(timer.hasRef(), false);
+  timer.start(60 * 1000);
+  timer.ref();
+  assert.strictEqual(timer.hasRef(), true);
+  timer.unref();
+}
@@ -0,0 +1,53 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// This test checks that the private key operations of servers with
+// `asyncPrivateKey` run on the thread pool, by occupying its only thread and
+// checking that the handshake cannot complete before that thread is free.
+
+const assert = require('assert');
+const { spawn } = require('child_process');
+
+if (process.argv[2] === 'child') {
+  const crypto = require('crypto');
+  const tls = require('tls');
+  const fixtures = require('../common/fixtures');
+
+  const events = [];
+  const server = tls.createServer({
+    key: fixtures.readKey('agent1-key.pem'),
+    cert: fixtures.readKey('agent1-cert.pem'),
+    asyncPrivateKey: true
+  }, common.mustCall((socket) => {
+    events.push('secureConnection');
+    socket.end();
+    server.close();
+  }));
+
+  server.listen(0, '127.0.0.1', common.mustCall(() => {
+    crypto.pbkdf2('password', 'salt', 3e5, 64, 'sha512', common.mustCall(() => {
+      events.push('pbkdf2');
+    }));
+    const client = tls.connect({
+      host: '127.0.0.1',
+      port: server.address().port,
+      rejectUnauthorized: false
+    }, common.mustCall(() => client.end()));
+  }));
+
+  process.on('exit', () => {
+    assert.deepStrictEqual(events, ['pbkdf2', 'secureConnection']);
+  });
+  return;
+}
+
+const child = spawn(process.execPath, [__filename, 'child'], {
+  env: { ...process.env, UV_THREADPOOL_SIZE: '1' },
+  stdio: 'inherit'
+});
+child.on('exit', common.mustCall((code, signal) => {
+  assert.strictEqual(signal, null);
+  assert.strictEqual(code, 0);
+}));
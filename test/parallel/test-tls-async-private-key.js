@@ -0,0 +1,126 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// This test checks that servers with `asyncPrivateKey` complete handshakes,
+// including ones that run the callbacks of the server while the private key
+// operation is pending.
+
+const assert = require('assert');
+const tls = require('tls');
+const fixtures = require('../common/fixtures');
+
+const rsa = {
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem')
+};
+const ec = {
+  key: fixtures.readKey('ec-key.pem'),
+  cert: fixtures.readKey('ec-cert.pem')
+};
+
+// Connects `count` clients to `server` at the same time, and closes the server
+// once all of them are done.
+function connect(server, count, clientOptions = {}) {
+  server.listen(0, common.mustCall(() => {
+    let pending = count;
+    for (let i = 0; i < count; i++) {
+      const client = tls.connect({
+        port: server.address().port,
+        rejectUnauthorized: false,
+        ...clientOptions
+      }, common.mustCall(() => {
+        client.end();
+      }));
+      client.on('data', common.mustCall((data) => {
+        assert.strictEqual(data.toString(), 'hello');
+      }));
+      client.on('close', common.mustCall(() => {
+        if (--pending === 0)
+          server.close();
+      }));
+    }
+  }));
+}
+
+function createServer(options, count, check = () => {}) {
+  return tls.createServer({ ...options, asyncPrivateKey: true },
+                          common.mustCall((socket) => {
+                            check(socket);
+                            socket.end('hello');
+                          }, count));
+}
+
+for (const maxVersion of ['TLSv1.2', 'TLSv1.3']) {
+  connect(createServer({ ...rsa, maxVersion }, 8), 8);
+  connect(createServer({ ...ec, maxVersion }, 8), 8);
+}
+
+// RSA key exchange decrypts with the private key instead of signing.
+connect(createServer({ ...rsa, ciphers: 'AES128-SHA256' }, 2), 2, {
+  maxVersion: 'TLSv1.2',
+  ciphers: 'AES128-SHA256'
+});
+
+// The private key of a context that is selected by the SNICallback is used
+// asynchronously as well.
+{
+  const context = tls.createSecureContext({ ...ec, asyncPrivateKey: true });
+  const server = createServer({
+    ...rsa,
+    SNICallback: common.mustCall((servername, callback) => {
+      assert.strictEqual(servername, 'example.com');
+      setImmediate(callback, null, context);
+    }, 2)
+  }, 2, (socket) => {
+    assert.strictEqual(socket.servername, 'example.com');
+  });
+  connect(server, 2, { servername: 'example.com' });
+}
+
+// The servername and the ALPN protocol are negotiated while the handshake
+// runs in an async job.
+for (const maxVersion of ['TLSv1.2', 'TLSv1.3']) {
+  const server = createServer({
+    ...rsa,
+    maxVersion,
+    ALPNProtocols: ['a', 'b']
+  }, 2, (socket) => {
+    assert.strictEqual(socket.servername, 'example.com');
+    assert.strictEqual(socket.alpnProtocol, 'b');
+  });
+  connect(server, 2, { servername: 'example.com', ALPNProtocols: ['b', 'c'] });
+}
+
+// Sessions that are created during the handshake are emitted.
+{
+  const server = createServer({ ...rsa, maxVersion: 'TLSv1.2' }, 2);
+  server.on('newSession', common.mustCall((id, data, callback) => {
+    assert.ok(id.length > 0);
+    assert.ok(data.length > 0);
+    callback();
+  }, 2));
+  connect(server, 2);
+}
+
+// Sockets that are destroyed during the handshake do not leak or crash.
+{
+  const server = tls.createServer({ ...rsa, asyncPrivateKey: true },
+                                  common.mustNotCall());
+  server.on('tlsClientError', () => {});
+  server.on('connection', common.mustCall((socket) => {
+    socket.on('close', common.mustCall(() => server.close()));
+  }));
+  server.listen(0, common.mustCall(() => {
+    const client = tls.connect({
+      port: server.address().port,
+      rejectUnauthorized: false
+    }, common.mustNotCall());
+    client.on('error', () => {});
+    // Close the connection once the ClientHello has been sent.
+    client.on('connect', common.mustCall(() => {
+      setImmediate(() => client.destroy());
+    }));
+  }));
+}
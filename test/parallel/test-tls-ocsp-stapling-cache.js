@@ -0,0 +1,163 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// This test checks that servers with the `ocspStapling` option fetch OCSP
+// responses in the background, and staple them without emitting
+// 'OCSPRequest'.
+
+const assert = require('assert');
+const http = require('http');
+const tls = require('tls');
+const fixtures = require('../common/fixtures');
+
+const options = {
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem')
+};
+// Expires in the year 2300.
+const ocspResponse = fixtures.readKey('agent1-ocsp-response.der');
+
+// A stand-in for the OCSP responder of the CA.
+const responder = http.createServer(common.mustCall((req, res) => {
+  assert.strictEqual(req.method, 'POST');
+  req.resume();
+  req.on('end', () => res.end(ocspResponse));
+}));
+
+function requestOCSPResponse(certificate, issuer, callback) {
+  assert.ok(Buffer.isBuffer(certificate));
+  const req = http.request({
+    port: responder.address().port,
+    method: 'POST'
+  }, (res) => {
+    const chunks = [];
+    res.on('data', (chunk) => chunks.push(chunk));
+    res.on('end', () => callback(null, Buffer.concat(chunks)));
+  });
+  req.on('error', callback);
+  req.end(certificate);
+}
+
+function connect(server, callback, servername) {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    requestOCSP: true,
+    servername
+  });
+  client.on('OCSPResponse', common.mustCall((response) => {
+    callback(response);
+  }));
+  client.resume();
+  client.on('end', () => client.end());
+}
+
+// The response is fetched once, and stapled to every handshake.
+responder.listen(0, common.mustCall(() => {
+  const server = tls.createServer({
+    ...options,
+    ocspStapling: {
+      fetch: common.mustCall((certificate, issuer, callback) => {
+        requestOCSPResponse(certificate, issuer, common.mustCall((err, res) => {
+          callback(err, res);
+          setImmediate(onResponse);
+        }));
+      })
+    }
+  }, (socket) => socket.end());
+  server.listen(0);
+
+  function onResponse() {
+    connect(server, common.mustCall((response) => {
+      assert.deepStrictEqual(response, ocspResponse);
+      connect(server, common.mustCall((response) => {
+        assert.deepStrictEqual(response, ocspResponse);
+        server.close();
+        responder.close();
+      }));
+    }));
+  }
+}));
+
+// The response of the context that is selected by the SNICallback is stapled,
+// not the one of the server's context. Contexts with the same certificate
+// share the response, which is fetched only once.
+{
+  const agent1Certificate = tls.createSecureContext(options).context
+    .getCertificate();
+  let respond;
+  const server = tls.createServer({
+    key: fixtures.readKey('agent2-key.pem'),
+    cert: fixtures.readKey('agent2-cert.pem'),
+    SNICallback: common.mustCall((servername, callback) => {
+      callback(null, tls.createSecureContext(options));
+    }, 2),
+    ocspStapling: {
+      fetch: common.mustCall((certificate, issuer, callback) => {
+        if (certificate.equals(agent1Certificate)) {
+          respond = callback;
+        } else {
+          callback(null, Buffer.from('default'));
+          setImmediate(onDefaultResponse);
+        }
+      }, 2)
+    }
+  }, (socket) => socket.end());
+  server.listen(0);
+
+  // The first handshake selects the context, which has no response yet.
+  function onDefaultResponse() {
+    connect(server, common.mustCall((response) => {
+      assert.strictEqual(response, null);
+      respond(null, ocspResponse);
+      setImmediate(onSNIResponse);
+    }), 'agent1');
+  }
+
+  function onSNIResponse() {
+    connect(server, common.mustCall((response) => {
+      assert.deepStrictEqual(response, ocspResponse);
+      server.close();
+    }), 'agent1');
+  }
+}
+
+// Responses without a nextUpdate time are due again after `refreshBefore`
+// milliseconds, and are then fetched by the next handshake. Nothing is fetched
+// without handshakes.
+{
+  let fetches = 0;
+  const server = tls.createServer({
+    ...options,
+    ocspStapling: {
+      fetch: common.mustCallAtLeast((certificate, issuer, callback) => {
+        callback(null, Buffer.from(`response ${++fetches}`));
+      }, 2),
+      refreshBefore: 10
+    }
+  }, (socket) => socket.end());
+  server.listen(0, common.mustCall(() => {
+    setTimeout(() => {
+      const before = fetches;
+      connect(server, common.mustCall((response) => {
+        assert.strictEqual(fetches, before + 1);
+        assert.strictEqual(response.toString(), `response ${fetches}`);
+        server.close();
+        setTimeout(common.mustCall(() => {
+          assert.strictEqual(fetches, before + 1);
+        }), 50);
+      }));
+    }, 50);
+  }));
+}
+
+[
+  [null, 'ERR_INVALID_ARG_TYPE'],
+  [{}, 'ERR_INVALID_ARG_TYPE'],
+  [{ fetch: common.mustNotCall(), refreshBefore: 0 }, 'ERR_OUT_OF_RANGE'],
+  [{ fetch: common.mustNotCall(), refreshBefore: '1' }, 'ERR_INVALID_ARG_TYPE']
+].forEach(([ocspStapling, code]) => {
+  assert.throws(() => tls.createServer({ ...options, ocspStapling }), { code });
+});
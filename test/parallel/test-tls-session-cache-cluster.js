@@ -0,0 +1,68 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+if (common.isWindows)
+  common.skip('session caches cannot be shared across processes on Windows');
+
+// Workers that are started after the ticket keys of a shared session cache
+// have been rotated must not bring back the keys that the first worker had
+// when it started listening.
+
+const assert = require('assert');
+const cluster = require('cluster');
+const path = require('path');
+const tls = require('tls');
+const fixtures = require('../common/fixtures');
+const tmpdir = require('../common/tmpdir');
+
+if (cluster.isWorker) {
+  const server = tls.createServer({
+    key: fixtures.readKey('agent1-key.pem'),
+    cert: fixtures.readKey('agent1-cert.pem'),
+    sessionCache: {
+      path: process.env.SESSION_CACHE_PATH,
+      ticketKeyRotation: 1
+    }
+  });
+  const sendKeys = () => {
+    process.send(server.getTicketKeys().toString('hex'));
+  };
+  server.listen(0, sendKeys);
+  process.on('message', (message) => {
+    if (message === 'keys')
+      sendKeys();
+    else
+      server.close(() => process.disconnect());
+  });
+  return;
+}
+
+tmpdir.refresh();
+process.env.SESSION_CACHE_PATH = path.join(tmpdir.path, 'sessions');
+
+function nextKeys(worker) {
+  return new Promise((resolve) => worker.once('message', resolve));
+}
+
+(async () => {
+  const first = cluster.fork();
+  const initialKeys = await nextKeys(first);
+
+  // Let the keys expire, and have the first worker rotate them.
+  await new Promise((resolve) => setTimeout(resolve, 1500));
+  first.send('keys');
+  const rotatedKeys = await nextKeys(first);
+  assert.notStrictEqual(rotatedKeys, initialKeys);
+
+  // The second worker receives the first worker's initial keys from the
+  // master, but keeps using the keys from the cache.
+  const second = cluster.fork();
+  const secondKeys = await nextKeys(second);
+  assert.notStrictEqual(secondKeys, initialKeys);
+  first.send('keys');
+  assert.strictEqual(await nextKeys(first), secondKeys);
+
+  first.send('exit');
+  second.send('exit');
+})().then(common.mustCall());
@@ -0,0 +1,126 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// This test checks that servers which use the same `sessionCache` resume each
+// other's sessions, within a process and across processes.
+
+const assert = require('assert');
+const path = require('path');
+const { fork } = require('child_process');
+const tls = require('tls');
+const fixtures = require('../common/fixtures');
+const tmpdir = require('../common/tmpdir');
+const { SSL_OP_NO_TICKET } = require('crypto').constants;
+
+const options = {
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem'),
+  maxVersion: 'TLSv1.2',
+  sessionIdContext: 'test-tls-session-cache-shared'
+};
+
+function createServer(sessionCache, secureOptions = SSL_OP_NO_TICKET) {
+  return tls.createServer({ ...options, secureOptions, sessionCache },
+                          (socket) => socket.end());
+}
+
+// Connects to `server` and calls back with the session and whether it was
+// reused.
+function connect(server, session, callback) {
+  server.listen(0, common.mustCall(() => {
+    let newSession;
+    const client = tls.connect({
+      port: server.address().port,
+      rejectUnauthorized: false,
+      session
+    }, common.mustCall(() => {
+      newSession = client.getSession();
+    }));
+    client.on('close', common.mustCall(() => {
+      server.close();
+      callback(newSession, client.isSessionReused());
+    }));
+    client.resume();
+  }));
+}
+
+if (process.argv[2] === 'child') {
+  const session = Buffer.from(process.argv[4], 'hex');
+  connect(createServer({ path: process.argv[3] }), session,
+          common.mustCall((_, reused) => {
+            assert.strictEqual(reused, true);
+          }));
+  return;
+}
+
+// Servers in the same process share a cache by name.
+{
+  const cache = { name: 'test', size: 16 };
+  const server1 = createServer(cache);
+  const server2 = createServer(cache);
+
+  connect(server1, undefined, common.mustCall((session, reused) => {
+    assert.strictEqual(reused, false);
+    connect(server2, session, common.mustCall((_, reused) => {
+      assert.strictEqual(reused, true);
+
+      const stats = server1.getSessionCacheStats();
+      assert.deepStrictEqual(stats, server2.getSessionCacheStats());
+      assert.strictEqual(stats.hits, 1);
+      assert.strictEqual(stats.stores, 1);
+      assert.strictEqual(stats.evictions, 0);
+      assert.strictEqual(stats.size, 1);
+    }));
+  }));
+
+  assert.throws(() => createServer({ name: 'test', size: 32 }), {
+    message: "session cache 'test' already exists with different options"
+  });
+  assert.strictEqual(createServer().getSessionCacheStats(), undefined);
+}
+
+[
+  [{ name: 1 }, 'ERR_INVALID_ARG_TYPE'],
+  [{ path: true }, 'ERR_INVALID_ARG_TYPE'],
+  [{ size: 0 }, 'ERR_OUT_OF_RANGE'],
+  [{ size: 1.5 }, 'ERR_OUT_OF_RANGE'],
+  [{ ticketKeyRotation: -1 }, 'ERR_OUT_OF_RANGE']
+].forEach(([sessionCache, code]) => {
+  assert.throws(() => createServer(sessionCache), { code });
+});
+
+// Servers with a rotation interval share their ticket keys.
+{
+  const cache = { name: 'tickets', ticketKeyRotation: 3600 };
+  const server1 = createServer(cache, 0);
+  const server2 = createServer(cache, 0);
+  assert.deepStrictEqual(server1.getTicketKeys(), server2.getTicketKeys());
+
+  connect(server1, undefined, common.mustCall((session) => {
+    connect(server2, session, common.mustCall((_, reused) => {
+      assert.strictEqual(reused, true);
+      assert.strictEqual(server2.getSessionCacheStats().ticketKeyRotations, 0);
+    }));
+  }));
+
+  const keys = Buffer.alloc(48, 1);
+  server1.setTicketKeys(keys);
+  assert.deepStrictEqual(server2.getTicketKeys(), keys);
+}
+
+// Processes share a cache through a file.
+if (!common.isWindows) {
+  tmpdir.refresh();
+  const file = path.join(tmpdir.path, 'session-cache');
+  const server = createServer({ path: file });
+
+  connect(server, undefined, common.mustCall((session) => {
+    fork(__filename, ['child', file, session.toString('hex')])
+      .on('exit', common.mustCall((code) => {
+        assert.strictEqual(code, 0);
+        assert.strictEqual(server.getSessionCacheStats().hits, 1);
+      }));
+  }));
+}
@@ -0,0 +1,45 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const { Worker } = require('worker_threads');
+
+[1, {}, true].forEach((cpuAffinity) => {
+  common.expectsError(() => {
+    new Worker('', { eval: true, cpuAffinity });
+  }, { code: 'ERR_INVALID_ARG_TYPE' });
+});
+
+['', '2-1', 'a', ',1', 'node:'].forEach((cpuAffinity) => {
+  common.expectsError(() => {
+    new Worker('', { eval: true, cpuAffinity });
+  }, {
+    code: 'ERR_WORKER_INVALID_CPU_AFFINITY',
+    message: new RegExp('^Initiated Worker with invalid cpuAffinity ' +
+                        `"${cpuAffinity}": `)
+  });
+});
+
+if (!common.isLinux) {
+  common.expectsError(() => {
+    new Worker('', { eval: true, cpuAffinity: '0' });
+  }, {
+    code: 'ERR_WORKER_INVALID_CPU_AFFINITY',
+    message: /not supported on this platform$/
+  });
+  return;
+}
+
+const fs = require('fs');
+// Use a CPU that this process is allowed to run on.
+const cpu = /^Cpus_allowed_list:\s*(\d+)/m.exec(
+  fs.readFileSync('/proc/self/status', 'latin1'))[1];
+
+const w = new Worker(`
+  const fs = require('fs');
+  require('worker_threads').parentPort.postMessage(
+    /^Cpus_allowed_list:\\s*(.*)$/m.exec(
+      fs.readFileSync('/proc/thread-self/status', 'latin1'))[1]);
+`, { eval: true, cpuAffinity: cpu });
+w.on('message', common.mustCall((allowed) => {
+  assert.strictEqual(allowed, cpu);
+}));
@@ -0,0 +1,43 @@
+// Flags: --expose-internals
+'use strict';
+const common = require('../common');
+
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+// This test checks that SecureContexts that load the same certificates share
+// them, and that they are accounted for in the heap snapshot.
+
+const { validateSnapshotNodes } = require('../common/heap');
+const tls = require('tls');
+const fixtures = require('../common/fixtures');
+
+validateSnapshotNodes('Node / X509Certificates', []);
+
+const options = {
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem'),
+  ca: fixtures.readKey('ca1-cert.pem')
+};
+
+const contexts = [
+  tls.createSecureContext(options),
+  tls.createSecureContext({ ...options, cert: Buffer.from(options.cert) }),
+  tls.createSecureContext(),
+  tls.createSecureContext()
+];
+
+// The certificate chain, the CA certificates and the root certificates.
+validateSnapshotNodes('Node / X509Certificates', [
+  { children: [{ node_name: 'Node / X509', edge_name: 'certs' }] },
+  { children: [{ node_name: 'Node / X509', edge_name: 'certs' }] },
+  { children: [{ node_name: 'Node / X509', edge_name: 'certs' }] }
+]);
+
+validateSnapshotNodes('Node / SecureContext', contexts.map(() => ({
+  children: [
+    { node_name: 'Node / X509Certificates', edge_name: 'cert_chain' },
+    { node_name: 'Node / X509Certificates', edge_name: 'ca_certs' },
+    { node_name: 'Node / X509Certificates', edge_name: 'root_certs' }
+  ]
+})));
@@ -0,0 +1,72 @@
+'use strict';
+const common = require('../common');
+common.skipIfReportDisabled();
+if (!common.isLinux)
+  common.skip('restricting threads to CPUs is only supported on Linux');
+
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+
+// Use a CPU that this process is allowed to run on.
+const cpu = /^Cpus_allowed_list:\s*(\d+)/m.exec(
+  fs.readFileSync('/proc/self/status', 'latin1'))[1];
+
+if (process.argv[2] === 'child') {
+  const { Worker } = require('worker_threads');
+  const w = new Worker(`
+    require('worker_threads').parentPort.postMessage('ready');
+    setInterval(() => {}, 1000);
+  `, { eval: true, cpuAffinity: cpu });
+  w.once('message', () => {
+    console.log(process.report.getReport());
+    w.terminate();
+  });
+  return;
+}
+
+const helper = require('../common/report');
+
+{
+  const args = ['--experimental-report', '--no-warnings',
+                `--main-thread-cpus=${cpu}`, `--threadpool-cpus=${cpu}`,
+                `--platform-thread-cpus=${cpu}`, __filename, 'child'];
+  const child = spawnSync(process.execPath, args, {
+    env: { ...process.env, UV_THREADPOOL_SIZE: '2' }
+  });
+  assert.strictEqual(child.stderr.toString(), '');
+  assert.strictEqual(child.status, 0);
+  const report = child.stdout.toString();
+  helper.validateContent(report);
+
+  const threads = JSON.parse(report).threadAffinity;
+  const names = threads.map((thread) => thread.name);
+  assert(names.includes('main'));
+  assert(names.includes('threadpool 0'));
+  assert(names.includes('threadpool 1'));
+  assert(names.includes('platform worker 0'));
+  assert(names.some((name) => /^worker \d+$/.test(name)));
+  threads.forEach((thread) => assert.strictEqual(thread.cpus, cpu));
+}
+
+{
+  // Without any of the options, no threads are pinned.
+  const child = spawnSync(process.execPath, [
+    '--experimental-report', '--no-warnings', '-p',
+    'JSON.stringify(JSON.parse(process.report.getReport()).threadAffinity)'
+  ]);
+  assert.strictEqual(child.stdout.toString().trim(), '[]');
+}
+
+// Invalid CPU lists are rejected during startup.
+['', '3-1', 'x', '0,,1', 'node:999999'].forEach((list) => {
+  const child = spawnSync(process.execPath,
+                          [`--threadpool-cpus=${list}`, '-e', '0']);
+  if (list === '') {
+    assert.strictEqual(child.status, 0);
+    return;
+  }
+  assert.strictEqual(child.status, 9);
+  assert(child.stderr.toString().includes(
+    'invalid value for --threadpool-cpus'), child.stderr.toString());
+});
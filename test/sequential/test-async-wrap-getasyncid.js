@@ -91,12 +91,32 @@ function testInitialized(req, ctor_name) {
 }
 
 
+{
+  const CoarseTimer = internalBinding('timers').CoarseTimer;
+  testInitialized(new CoarseTimer(), 'CoarseTimer');
+}
+
+
 {
   const FSEvent = internalBinding('fs_event_wrap').FSEvent;
   testInitialized(new FSEvent(), 'FSEvent');
 }
 
 
+{
+  const binding = internalBinding('fs');
+  const handle = binding.opendir(__dirname, undefined, {});
+  testInitialized(handle, 'DirHandle');
+  handle.close(undefined, {});
+}
+
+
+{
+  const TreeWalker = internalBinding('fs').TreeWalker;
+  testInitialized(new TreeWalker(), 'TreeWalker');
+}
+
+
 {
   const JSStream = internalBinding('js_stream').JSStream;
   testInitialized(new JSStream(), 'JSStream');